@@ -3,3 +3,8 @@ SUBDIRS += src \
            app
            
 app.depends = src
+# qmake CONFIG+=tests --> tests are built too (see tests/runtests.sh)
+CONFIG(tests) {
+    SUBDIRS += tests
+    tests.depends = src
+}
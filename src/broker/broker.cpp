@@ -10,8 +10,14 @@
 #include "workers/worker.h"
 #include "workers/private/workerproxy.h"
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVarLengthArray>
+#include <memory>
 using namespace Radapter;
 
+using Routes = std::shared_ptr<const QSet<Worker*>>;
+
 struct WorkerConnection {
     Worker *producer;
     WorkerProxy *producerProxy;
@@ -28,8 +34,21 @@ struct Radapter::BrokerPrivate {
     QMap<QString, Worker*> workers;
     QMap<QString, Interceptor*> interceptors;
     QList<WorkerConnection> connections;
+    //! Routing table: only registered (alive) workers get msgs addressed to them.
+    //! Immutable snapshot: senders load it without locks, writers replace it (under mutex)
+    Routes routes{std::make_shared<const QSet<Worker*>>()};
     Settings::Broker settings;
     QRecursiveMutex mutex;
+    //! Startup report: worker --> ms since runAll() when it became ready
+    QElapsedTimer startup;
+    QList<QPair<QString, qint64>> readyTimes;
+    Routes loadRoutes() const {
+        return std::atomic_load(&routes);
+    }
+    //! \return replaced snapshot
+    Routes storeRoutes(QSet<Worker*> &&newRoutes) {
+        return std::atomic_exchange(&routes, Routes(std::make_shared<const QSet<Worker*>>(std::move(newRoutes))));
+    }
     bool wereConnected(const Worker *producer, const Worker *consumer) const {
         for (const auto &conn: connections) {
             if (conn.matches(producer, consumer)) {
@@ -55,9 +74,27 @@ void Broker::onMsgFromWorker(const Radapter::WorkerMsg &msg)
     if (!msg.sender()) {
         throw std::runtime_error("Cannot have msg without sender!");
     }
-    auto copy = msg;
-    copy.receivers().subtract(msg.sender()->consumers()); // consumers already received the msg
-    emit broadcastToAll(copy);
+    // Receivers in this thread are called after the snapshot is released: they may register or destroy workers
+    QVarLengthArray<QPointer<Worker>, 4> local;
+    {
+        const auto routes = d->loadRoutes();
+        const auto &alreadyReceived = msg.sender()->consumers(); // consumers already received the msg
+        for (auto receiver : msg.receivers()) {
+            if (alreadyReceived.contains(receiver) || !routes->contains(receiver)) {
+                continue;
+            }
+            if (receiver->thread() == QThread::currentThread()) {
+                local.append(receiver);
+            } else {
+                receiver->deliver(msg);
+            }
+        }
+    }
+    for (const auto &receiver : local) {
+        if (receiver) {
+            receiver->onMsgFromBroker(msg);
+        }
+    }
     if (msg.receivers().isEmpty()) {
         if (d->settings.warn_no_receivers) {
             brokerWarn() << "Msg with no receivers! Sender:" << msg.sender();
@@ -96,13 +133,37 @@ void Broker::registerWorker(Worker* worker)
     connect(worker, &Worker::sendMsg,
             this, &Broker::onMsgFromWorker,
             thread() == worker->workerThread() ? Qt::DirectConnection : Qt::QueuedConnection);
+    connect(worker, &Worker::ready, this, [this, worker]{
+        onWorkerReady(worker);
+    }, Qt::DirectConnection);
     brokerInfo() << "Registering worker:" << worker->printSelf();
     d->workers.insert(worker->workerName(), worker);
+    auto routes = *d->loadRoutes();
+    routes.insert(worker);
+    d->storeRoutes(std::move(routes));
+}
+
+void Broker::unregisterRoute(Worker *worker)
+{
+    Routes old;
+    {
+        QMutexLocker locker(&d->mutex);
+        auto routes = *d->loadRoutes();
+        if (!routes.remove(worker)) {
+            return;
+        }
+        old = d->storeRoutes(std::move(routes));
+    }
+    // Grace period: senders, that loaded old snapshot, only push to inboxes (never block, never destroy workers)
+    while (old.use_count() > 1) {
+        QThread::yieldCurrentThread();
+    }
 }
 
 void Broker::runAll()
 {
     QMutexLocker locker(&d->mutex);
+    d->startup.start();
     for (auto worker : qAsConst(d->workers)) {
         if (!worker->wasStarted()) worker->run();
     }
@@ -113,6 +174,27 @@ void Broker::runAll()
     }
 }
 
+void Broker::onWorkerReady(Worker *worker)
+{
+    QMutexLocker locker(&d->mutex);
+    const auto elapsed = d->startup.isValid() ? d->startup.elapsed() : 0;
+    d->readyTimes.append({worker->printSelf(), elapsed});
+    brokerInfo() << "Worker ready:" << worker->printSelf() << "at" << elapsed << "ms";
+    if (d->readyTimes.size() < d->workers.size()) {
+        return;
+    }
+    brokerInfo().noquote() << "=== Startup report: all" << d->workers.size() << "workers ready in" << elapsed << "ms ===";
+    for (const auto &[name, time] : qAsConst(d->readyTimes)) {
+        brokerInfo().noquote() << QStringLiteral("%1 ms").arg(time, 7) << "|" << name;
+    }
+}
+
+QList<QPair<QString, qint64>> Broker::readyTimes() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->readyTimes;
+}
+
 Broker::~Broker()
 {
     delete d;
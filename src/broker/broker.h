@@ -31,17 +31,24 @@ public:
     void disconnect(Worker *producer, Worker *consumer);
     void applySettings(const Settings::Broker &newSettings);
     void runAll();
+    //! Startup report: workers (as printed) in order they became ready --> ms since runAll()
+    QList<QPair<QString, qint64>> readyTimes() const;
     ~Broker();
 signals:
     void broadcastToAll(const Radapter::WorkerMsg &msg);
 protected:
     void connectProxyToWorker(WorkerProxy *producer, Worker *consumer);
+    void onWorkerReady(Worker *worker);
 private slots:
     void onMsgFromWorker(const Radapter::WorkerMsg &msg);
     void proxyDestroyed(QObject *proxy);
 private:
     explicit Broker();
+    //! Called by ~Worker(): after return no thread can deliver to worker
+    void unregisterRoute(Worker *worker);
+
     BrokerPrivate *d;
+    friend class Worker;
 };
 
 template<typename Target>
@@ -1,11 +1,13 @@
 SOURCES+= \
    $$PWD/pipestart.cpp \
    $$PWD/privfilehelper.cpp \
+   $$PWD/workerinbox.cpp \
    $$PWD/workermsg.cpp \
    $$PWD/workerproxy.cpp
 HEADERS+= \
    $$PWD/pipestart.h \
    $$PWD/privfilehelper.h \
    $$PWD/workerdebug.h \
+   $$PWD/workerinbox.h \
    $$PWD/workermsg.h \
    $$PWD/workerproxy.h
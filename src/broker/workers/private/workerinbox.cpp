@@ -0,0 +1,60 @@
+#include "workerinbox.h"
+
+using namespace Radapter;
+
+WorkerInbox::WorkerInbox() :
+    m_head(&m_stub),
+    m_tail(&m_stub)
+{
+}
+
+WorkerInbox::~WorkerInbox()
+{
+    while (auto node = pop()) {
+        delete node;
+    }
+}
+
+bool WorkerInbox::push(const WorkerMsg &msg)
+{
+    auto node = new Node;
+    node->msg = msg;
+    pushNode(node);
+    return !m_wakeupPending.exchange(true, std::memory_order_acq_rel);
+}
+
+void WorkerInbox::pushNode(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+WorkerInbox::Node *WorkerInbox::pop()
+{
+    auto tail = m_tail;
+    auto next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+        if (!next) {
+            return nullptr;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        m_tail = next;
+        return tail;
+    }
+    if (tail != m_head.load(std::memory_order_acquire)) {
+        // Producer is in the middle of push(). It will be seen on next drain
+        return nullptr;
+    }
+    pushNode(&m_stub);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+        m_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
@@ -0,0 +1,54 @@
+#ifndef WORKERINBOX_H
+#define WORKERINBOX_H
+
+#include "workermsg.h"
+#include <atomic>
+
+namespace Radapter {
+//! Lock-free multi-producer/single-consumer queue of msgs (Vyukov).
+//! push() reports when a wakeup must be scheduled: exactly once per drain()
+class RADAPTER_API WorkerInbox
+{
+    Q_DISABLE_COPY(WorkerInbox)
+public:
+    WorkerInbox();
+    ~WorkerInbox();
+    //! Can be called from any thread
+    //! \return true --> consumer must be woken up (nobody did it since last drain())
+    bool push(const WorkerMsg &msg);
+    //! Consumer thread only
+    template <typename Func>
+    int drain(Func &&func);
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        WorkerMsg msg{};
+    };
+    void pushNode(Node *node);
+    Node *pop();
+
+    std::atomic<Node*> m_head;
+    Node *m_tail;
+    Node m_stub;
+    std::atomic<bool> m_wakeupPending{false};
+};
+
+template <typename Func>
+int WorkerInbox::drain(Func &&func)
+{
+    // Cleared before popping: msgs pushed from now on schedule new wakeup.
+    // Acquire pairs with exchange() of push(), so nodes linked before it are visible to pop()
+    m_wakeupPending.exchange(false, std::memory_order_acq_rel);
+    auto count = 0;
+    while (auto node = pop()) {
+        auto msg = std::move(node->msg);
+        delete node;
+        func(msg);
+        ++count;
+    }
+    return count;
+}
+
+}
+
+#endif // WORKERINBOX_H
@@ -214,22 +214,23 @@ JsonDict &Radapter::WorkerMsg::json() {
 
 const Command *Radapter::WorkerMsg::command() const
 {
-    return m_serviceData[ServiceCommand].value<QSharedPointer<Command>>().data();
+    return m_serviceData.value(ServiceCommand).value<QSharedPointer<Command>>().data();
 }
 
 Command *Radapter::WorkerMsg::command()
 {
-    return m_serviceData[ServiceCommand].value<QSharedPointer<Command>>().data();
+    // Command is shared by pointer: no need to detach service data
+    return std::as_const(m_serviceData).value(ServiceCommand).value<QSharedPointer<Command>>().data();
 }
 
 const Reply *Radapter::WorkerMsg::reply() const
 {
-    return m_serviceData[ServiceReply].value<QSharedPointer<Reply>>().data();
+    return m_serviceData.value(ServiceReply).value<QSharedPointer<Reply>>().data();
 }
 
 Reply *Radapter::WorkerMsg::reply()
 {
-    return m_serviceData[ServiceReply].value<QSharedPointer<Reply>>().data();
+    return std::as_const(m_serviceData).value(ServiceReply).value<QSharedPointer<Reply>>().data();
 }
 
 QVariant &Radapter::WorkerMsg::privateData()
@@ -10,6 +10,8 @@ namespace Radapter {
 class Broker;
 class Worker;
 class WorkerProxy;
+//! Json payload, receivers and service data are implicitly shared: copy (fan-out) is a few refcounts.
+//! Non-const access detaches only the touched path, so msgs shared by several pipes are read through const
 class RADAPTER_API WorkerMsg : public JsonDict {
     Q_GADGET
 public:
@@ -123,6 +123,7 @@ void ProcessWorker::onRun()
 {
     d->periodic->start();
     startProc();
+    Worker::onRun();
 }
 
 void ProcessWorker::ownLogEnable(bool state)
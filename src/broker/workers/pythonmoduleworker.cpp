@@ -56,6 +56,7 @@ PythonModuleWorker::PythonModuleWorker(const Settings::PythonModuleWorker &setti
 void PythonModuleWorker::onRun()
 {
     d->proc->nestedRun();
+    Worker::onRun();
 }
 
 void PythonModuleWorker::onMsg(const WorkerMsg &msg)
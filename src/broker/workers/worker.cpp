@@ -8,6 +8,7 @@
 #include "settings/workersettings.h"
 #include "radapterlogging.h"
 #include "private/workerproxy.h"
+#include "private/workerinbox.h"
 #include "state/jsonstate.h"
 
 using namespace Radapter;
@@ -28,6 +29,12 @@ struct Radapter::Worker::Private {
     std::atomic<bool> wasRun{false};
     Worker::Role role{Worker::ConsumerProducer};
     QList<QMetaObject::Connection> roleConns;
+    WorkerInbox inbox;
+    std::atomic<bool> ready{false};
+    bool readyDeferred{false};
+    bool onRunDone{false};
+    bool dependenciesDone{false};
+    QSet<Worker*> pendingDependencies;
 };
 
 Q_GLOBAL_STATIC(QRecursiveMutex, staticMutex);
@@ -127,6 +134,8 @@ void Worker::nestedRun()
 
 Worker::~Worker()
 {
+    // Inbox must outlive every delivery
+    broker()->unregisterRoute(this);
     delete d;
 }
 
@@ -139,9 +148,80 @@ void Worker::run()
     d->wasRun = true;
 }
 
+bool Worker::isReady() const
+{
+    return d->ready;
+}
+
 void Worker::onRun()
 {
     workerInfo(this) << "started!";
+    d->onRunDone = true;
+    checkDependencies();
+}
+
+void Worker::dependOn(Worker *dependency)
+{
+    if (!dependency || dependency == this || d->pendingDependencies.contains(dependency)) {
+        return;
+    }
+    if (d->dependenciesDone) {
+        workerWarn(this) << "dependOn() after dependencies were satisfied, ignoring:" << dependency->printSelf();
+        return;
+    }
+    d->pendingDependencies.insert(dependency);
+    connect(dependency, &Worker::ready, this, [this, dependency]{
+        onDependencyReady(dependency);
+    });
+    connect(dependency, &QObject::destroyed, this, [this, dependency]{
+        if (d->pendingDependencies.contains(dependency)) {
+            workerError(this) << "Dependency destroyed before becoming ready";
+        }
+    });
+    if (dependency->isReady()) {
+        // Could have become ready before connect() --> recheck in own thread
+        QMetaObject::invokeMethod(this, [this, dependency]{
+            onDependencyReady(dependency);
+        }, Qt::QueuedConnection);
+    } else {
+        workerInfo(this) << "waiting for:" << dependency->printSelf();
+    }
+}
+
+void Worker::onDependencyReady(Worker *dependency)
+{
+    if (d->pendingDependencies.remove(dependency)) {
+        checkDependencies();
+    }
+}
+
+void Worker::checkDependencies()
+{
+    if (d->dependenciesDone || !d->onRunDone || !d->pendingDependencies.isEmpty()) {
+        return;
+    }
+    d->dependenciesDone = true;
+    onDependenciesReady();
+}
+
+void Worker::onDependenciesReady()
+{
+    if (!d->readyDeferred) {
+        markReady();
+    }
+}
+
+void Worker::deferReady()
+{
+    d->readyDeferred = true;
+}
+
+void Worker::markReady()
+{
+    if (d->ready.exchange(true)) {
+        return;
+    }
+    emit ready();
 }
 
 void Worker::addConsumer(Worker *consumer, const QList<Interceptor *> &interceptors)
@@ -282,6 +362,20 @@ void Worker::onMsgFromBroker(const Radapter::WorkerMsg &msg)
     }
 }
 
+void Worker::deliver(const WorkerMsg &msg)
+{
+    if (d->inbox.push(msg)) {
+        QMetaObject::invokeMethod(this, &Worker::drainInbox, Qt::QueuedConnection);
+    }
+}
+
+void Worker::drainInbox()
+{
+    d->inbox.drain([this](const WorkerMsg &msg){
+        onMsgFromBroker(msg);
+    });
+}
+
 void Worker::setRole(Role role)
 {
     d->role = role;
@@ -44,6 +44,8 @@ public:
     QList<Interceptor*> pipe(WorkerProxy *proxy) const;
     Broker *broker() const;
     bool wasStarted() const;
+    //! Started and able to serve (e.g. connected). See deferReady()
+    bool isReady() const;
     bool is(const QMetaObject * mobj) const;
     template <typename Target> bool is() const;
     template <typename Target> const Target *as() const;
@@ -65,6 +67,8 @@ signals:
 
     void connectedToConsumer(Radapter::Worker *consumer, QPrivateSignal);
     void connectedToProducer(Radapter::Worker *producer, QPrivateSignal);
+    //! Emitted once
+    void ready();
 public slots:
     void run();
 protected slots:
@@ -73,10 +77,14 @@ protected slots:
     virtual void onCommand(const Radapter::WorkerMsg &msg);
     virtual void onMsg(const Radapter::WorkerMsg &msg);
     virtual void onBroadcast(const Radapter::WorkerMsg &msg);
+    //! Called in worker thread, after onRun() and once all dependOn() workers are ready.
+    //! Default marks worker ready (unless deferReady() was called)
+    virtual void onDependenciesReady();
 private slots:
     void onWorkerDestroyed(QObject *worker);
     void onSendMsgPriv(const Radapter::WorkerMsg &msg);
     void onMsgFromBroker(const Radapter::WorkerMsg &msg);
+    void drainInbox();
 protected:
     void setRole(Role role);
     Settings::Worker &workerConfig();
@@ -84,8 +92,17 @@ protected:
     WorkerMsg prepareMsg(JsonDict &&msg) const;
     WorkerMsg prepareReply(const WorkerMsg &msg, Reply *reply) const;
     WorkerMsg prepareCommand(Command *command) const;
+    //! Delays onDependenciesReady() until dependency is ready. Never blocks. Call before Worker::onRun()
+    void dependOn(Radapter::Worker *dependency);
+    //! Worker will become ready only after explicit markReady() (call in constructor)
+    void deferReady();
+    void markReady();
 private:
     WorkerProxy* createPipe(const QList<Interceptor *> &interceptors = {});
+    //! Thread-safe. Queues msg to inbox, worker thread is woken up once per batch
+    void deliver(const WorkerMsg &msg);
+    void onDependencyReady(Radapter::Worker *dependency);
+    void checkDependencies();
 
     Private *d;
     friend Broker;
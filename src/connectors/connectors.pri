@@ -1,6 +1,16 @@
 SOURCES+= \
    $$PWD/mysqlconnector.cpp \
-   $$PWD/redisconnector.cpp
+   $$PWD/redisconnector.cpp \
+   $$PWD/redispipeline.cpp \
+   $$PWD/redispubsub.cpp \
+   $$PWD/redisrouting.cpp \
+   $$PWD/redisspillfile.cpp \
+   $$PWD/rediswindow.cpp
 HEADERS+= \
    $$PWD/mysqlconnector.h \
-   $$PWD/redisconnector.h
+   $$PWD/redisconnector.h \
+   $$PWD/redispipeline.h \
+   $$PWD/redispubsub.h \
+   $$PWD/redisrouting.h \
+   $$PWD/redisspillfile.h \
+   $$PWD/rediswindow.h
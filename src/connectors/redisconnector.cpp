@@ -6,34 +6,221 @@
 #endif
 #include <QDataStream>
 #include "settings/redissettings.h"
+#include "redisspillfile.h"
+#include "redispipeline.h"
+#include "redispubsub.h"
+#include "redisrouting.h"
+#include "rediswindow.h"
+#include "localstorage.h"
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <algorithm>
+
+#define SHARD_VIRTUAL_NODES 64
+#define CLUSTER_SLOTS 16384
+#define CLUSTER_MAX_REDIRECTS 5
+#define SPILL_REPLAY_INTERVAL_MS 100
 
 using namespace Redis;
 
+static bool isHashReply(const redisReply *reply)
+{
+    return reply && (reply->type == REDIS_REPLY_ARRAY || reply->type == REDIS_REPLY_MAP);
+}
+
+#define LATENCY_EWMA_SHIFT 3
+
+//! One async connection. Lanes are laid out server by server: [server * pool_size + conn]
+struct ConnectorLane {
+    QString name;
+    QString host;
+    quint16 port;
+    //! Not empty --> connect through unix domain socket instead of host:port
+    QString unixSocket;
+    redisAsyncContext* context{};
+    RedisQtAdapter* client{};
+    bool connected{false};
+    //! Dropped while context is still alive (it is freed on reconnect)
+    bool dropped{false};
+};
+
+//! Cluster mode: command is kept encoded until reply, so it can be resent on MOVED/ASK
+struct Connector::ClusterCommand {
+    redisCallbackFn *callback;
+    void *cbData;
+    QByteArray encoded;
+    quint16 slot;
+    int redirects{0};
+    //! Redirected by ASK: ASKING is sent right before it
+    bool asking{false};
+    //! Transaction, that command belongs to (it owns command)
+    ClusterBatch *batch{nullptr};
+};
+
+//! Cluster mode: pipelined transaction is redirected as a whole, since its commands alone would run outside of it.
+//! Replies after a redirect (queued commands, EXECABORT) are not passed to callbacks, transaction is resent once all are in
+struct Connector::ClusterBatch {
+    QVector<ClusterCommand*> commands;
+    quint16 slot;
+    //! Replies, that did not come yet
+    int left{0};
+    int redirects{0};
+    //! Node from first MOVED/ASK of current attempt, -1 --> not redirected
+    int node{-1};
+    bool ask{false};
+    ~ClusterBatch() {
+        qDeleteAll(commands);
+    }
+};
+
+//! One batch of spilled commands in flight. Head of spill file is moved only when all of them are replied
+struct Connector::SpillReplay {
+    qint64 offset;
+    int count;
+    int left{0};
+    bool failed{false};
+};
+
 struct Connector::Private {
     Settings::RedisConnector config;
-    redisAsyncContext* redisContext{};
+    QVector<ConnectorLane> lanes;
+    //! Sharding (not cluster) mode: key --> server index (empty if single server)
+    ShardRing ring;
+    int poolSize{1};
     QTimer* reconnectTimer{};
     QTimer* commandTimeout{};
-    RedisQtAdapter* client{};
     QTimer* pingTimer{nullptr};
     std::atomic<bool> isConnected{false};
+    //! Commands with callbacks, sent and not yet replied (callbacks with nullptr reply count too)
+    Window window{int(config.max_in_flight)};
+    std::atomic<qint64> latencyUs{0};
+    std::atomic<qint64> maxLatencyUs{0};
+    std::atomic<quint64> totalCommands{0};
     quint8 commandTimeoutsCounter{0};
+    bool resp3{false};
+    Pipeline pipeline;
+    int pipelineLane{-1};
+    //! Cluster mode: keyed commands of pipeline must share one slot (transactions do anyway)
+    quint16 pipelineSlot{0};
+    bool cluster{false};
+    bool started{false};
+    //! Lanes of configured servers. Cluster nodes discovered later are appended after them
+    int seedLanes{0};
+    //! Cluster mode: slot --> node index
+    QVector<qint16> slots;
+    bool slotsLoaded{false};
+    bool slotsRefreshing{false};
+    //! Cluster mode: lane --> commands redirected to it while it was connecting, sent once it connects
+    QVector<QPair<int, ClusterCommand*>> awaiting;
+    //! Pub/sub connection: once subscribed, it can not run other commands
+    ConnectorLane subscriber;
+    bool hasSubscriber{false};
+    QStringList channels;
+    QStringList patterns;
+    SpillFile *spill{nullptr};
+    QTimer *spillTimer{nullptr};
+    int spillBatch{1};
+    SpillReplay *spillReplay{nullptr};
+
+    static bool isUsable(const ConnectorLane &lane) {
+        return lane.connected && lane.context && !lane.context->err;
+    }
+    //! Keyless commands stay on first server (PUBLISH must reach its subscribers), any live connection of its pool
+    int keylessLane() const {
+        for (int lane = 0; lane < poolSize && lane < lanes.size(); ++lane) {
+            if (isUsable(lanes[lane])) return lane;
+        }
+        return 0;
+    }
+    int laneFor(QByteArrayView key) const {
+        if (key.isEmpty()) {
+            return keylessLane();
+        }
+        if (cluster) {
+            return laneForSlot(clusterSlot(key));
+        }
+        if (lanes.size() == 1) {
+            return 0;
+        }
+        const auto hash = routingHash(key);
+        return ring.shardFor(hash) * poolSize + int((hash >> 16) % quint32(poolSize));
+    }
+    int laneForSlot(quint16 slot) const {
+        const auto node = slots.isEmpty() ? 0 : qMax<int>(0, slots[slot]);
+        return node * poolSize + slot % poolSize;
+    }
+    int findNode(const QString &host, quint16 port) const {
+        for (int lane = 0; lane < lanes.size(); lane += poolSize) {
+            if (lanes[lane].host == host && lanes[lane].port == port) return lane / poolSize;
+        }
+        return -1;
+    }
+    //! Routed lanes, then subscriber (if any)
+    template <typename Func>
+    void forEachLane(Func func) {
+        for (auto &lane : lanes) {
+            func(lane);
+        }
+        if (hasSubscriber) {
+            func(subscriber);
+        }
+    }
+    //! -1 for subscriber
+    int indexOf(const ConnectorLane *lane) const {
+        const auto index = lane - lanes.constData();
+        return index >= 0 && index < lanes.size() ? int(index) : -1;
+    }
+    ConnectorLane *laneOf(const redisAsyncContext *context) {
+        for (auto &lane : lanes) {
+            if (lane.context == context) return &lane;
+        }
+        if (hasSubscriber && subscriber.context == context) {
+            return &subscriber;
+        }
+        return nullptr;
+    }
+    int connectedLanes() const {
+        int result = 0;
+        for (const auto &lane : lanes) {
+            result += isUsable(lane);
+        }
+        return result;
+    }
+    //! Readiness is per lane: connector is up while any routed lane is, commands to dead lanes fail alone
+    bool ready() const {
+        return connectedLanes() && (!cluster || slotsLoaded);
+    }
 };
 
 Connector::Connector(const Settings::RedisConnector &settings, QThread *thread) :
     Worker(settings.worker, thread),
     d(new Private{settings})
 {
+    d->poolSize = qMax<int>(1, settings.pool_size);
+    d->cluster = settings.cluster;
+    QList<Settings::RedisServer> servers{settings.server};
+    servers.append(settings.shards);
+    QStringList shards;
+    for (const auto &info : servers) {
+        for (int conn = 0; conn < d->poolSize; ++conn) {
+            d->lanes.append(ConnectorLane{info.name.value, info.host.value, info.port.value, info.unix_socket.value});
+        }
+        shards.append(info.name.value);
+    }
+    if (!d->cluster) {
+        d->ring = ShardRing(shards, SHARD_VIRTUAL_NODES);
+    }
+    d->seedLanes = d->lanes.size();
     d->reconnectTimer = new QTimer(this);
     d->commandTimeout = new QTimer(this);
     d->reconnectTimer->setSingleShot(true);
     d->commandTimeout->setSingleShot(true);
     d->reconnectTimer->callOnTimeout(this, &Connector::reconnect);
     d->commandTimeout->callOnTimeout(this, &Connector::onCommandTimeout);
-    connect(this, &Connector::connected, &Connector::selectDb);
-    connect(this, &Connector::connected, d->reconnectTimer, &QTimer::stop);
+    // Dependent workers start once redis is reachable
+    deferReady();
+    connect(this, &Connector::connected, this, &Connector::markReady);
     connect(this, &Connector::disconnected, d->reconnectTimer, QOverload<>::of(&QTimer::start));
     d->reconnectTimer->setInterval(d->config.reconnect_delay);
     d->commandTimeout->setInterval(d->config.command_timeout);
@@ -42,20 +229,54 @@ Connector::Connector(const Settings::RedisConnector &settings, QThread *thread)
 
 Connector::~Connector()
 {
-    if (d->isConnected) {
-        d->redisContext->data = nullptr;
-        redisAsyncDisconnect(d->redisContext);
-    } else if (d->redisContext) {
-        redisAsyncFree(d->redisContext);
-    }
+    failAwaiting(0, d->lanes.size());
+    d->forEachLane([](ConnectorLane &lane) {
+        if (!lane.context) return;
+        if (lane.connected) {
+            lane.context->data = nullptr;
+            redisAsyncDisconnect(lane.context);
+        } else {
+            redisAsyncFree(lane.context);
+        }
+    });
+    delete d->spill;
     delete d;
 }
 
 void Connector::reconnect()
 {
-    workerError(this) << "Connection error or timeout. Trying new connection...";
-    clearContext();
-    tryConnect();
+    // Live lanes keep their connections (and commands in flight), only dropped ones are recreated
+    const auto dropped = clearDeadLanes();
+    if (!dropped) {
+        return;
+    }
+    workerError(this) << "Connection error or timeout. Reconnecting" << dropped << "connection(s)...";
+    if (d->cluster) {
+        if (!d->connectedLanes()) {
+            // Topology could have changed, rediscover it from seeds. Nothing is redirected to these lanes from now on
+            for (int lane = d->seedLanes; lane < d->lanes.size(); ++lane) {
+                d->lanes[lane].dropped = true;
+            }
+            failAwaiting(d->seedLanes, d->lanes.size());
+            for (int lane = d->seedLanes; lane < d->lanes.size(); ++lane) {
+                auto &discovered = d->lanes[lane];
+                // Still connecting: freed while its adapter is alive (pending callbacks get nullptr reply)
+                if (auto context = std::exchange(discovered.context, nullptr)) {
+                    redisAsyncFree(context);
+                }
+                if (discovered.client) {
+                    discovered.client->deleteLater();
+                }
+            }
+            d->lanes.resize(d->seedLanes);
+            d->slots.clear();
+            d->slotsLoaded = false;
+            d->slotsRefreshing = false;
+        } else {
+            refreshSlots();
+        }
+    }
+    connectLanes();
 }
 
 
@@ -65,59 +286,189 @@ void Connector::tryConnect()
         workerError(this) << "Attempt to connect while connected";
         return;
     }
+    connectLanes();
+}
+
+void Connector::connectLanes()
+{
     timeval timeout{0, d->config.tcp_timeout};
-    auto options = redisOptions{};
-    REDIS_OPTIONS_SET_TCP(&options, d->config.server.host->toStdString().c_str(), d->config.server.port);
-    options.connect_timeout = &timeout;
-    d->redisContext = redisAsyncConnectWithOptions(&options);
-    d->redisContext->data = this;
-    d->client->setContext(d->redisContext);
-    redisAsyncSetConnectCallback(d->redisContext, connectCallback);
-    redisAsyncSetDisconnectCallback(d->redisContext, disconnectCallback);
-    if (d->redisContext->err) {
-        workerError(this) << "Connection error:" << d->redisContext->errstr;
-        clearContext();
-        d->reconnectTimer->start();
-    }
+    d->forEachLane([&](ConnectorLane &lane) {
+        if (lane.context) return;
+        auto options = redisOptions{};
+        const auto host = lane.host.toStdString();
+        const auto socket = lane.unixSocket.toStdString();
+        if (socket.empty()) {
+            REDIS_OPTIONS_SET_TCP(&options, host.c_str(), lane.port);
+        } else {
+            REDIS_OPTIONS_SET_UNIX(&options, socket.c_str());
+        }
+        options.connect_timeout = &timeout;
+        lane.context = redisAsyncConnectWithOptions(&options);
+        lane.context->data = this;
+        lane.client->setContext(lane.context);
+        redisAsyncSetConnectCallback(lane.context, connectCallback);
+        redisAsyncSetDisconnectCallback(lane.context, disconnectCallback);
+        if (lane.context->err) {
+            workerError(this) << "Connection error:" << lane.context->errstr << "; Server:" << lane.name;
+            redisAsyncFree(lane.context);
+            lane.context = nullptr;
+            d->reconnectTimer->start();
+        }
+    });
 }
 
 void Connector::clearContext()
 {
-    if (d->redisContext) {
-        redisAsyncFree(d->redisContext);
-        d->redisContext = nullptr;
+    failAwaiting(0, d->lanes.size());
+    d->forEachLane([](ConnectorLane &lane) {
+        lane.connected = false;
+        if (lane.context) {
+            auto context = lane.context;
+            lane.context = nullptr;
+            redisAsyncFree(context);
+        }
+    });
+}
+
+int Connector::clearDeadLanes()
+{
+    int dropped = 0;
+    d->forEachLane([&](ConnectorLane &lane) {
+        // Live or still connecting
+        if (Private::isUsable(lane) || (lane.context && !lane.context->err && !lane.dropped)) return;
+        const auto index = d->indexOf(&lane);
+        failAwaiting(index, index + 1);
+        lane.connected = false;
+        lane.dropped = false;
+        if (lane.context) {
+            auto context = lane.context;
+            lane.context = nullptr;
+            redisAsyncFree(context);
+        }
+        ++dropped;
+    });
+    return dropped;
+}
+
+void Connector::dropLane(const redisAsyncContext *context, const QString &reason)
+{
+    auto lane = context ? d->laneOf(context) : nullptr;
+    if (!lane || !lane->connected) return;
+    workerError(this) << "Connection to" << lane->name << "dropped:" << reason;
+    // Freed by reconnect(), not here: this can be called from callback of its context
+    lane->connected = false;
+    lane->dropped = true;
+    d->reconnectTimer->start();
+    if (d->cluster) {
+        // Slots of dead node could already be served by promoted replica
+        refreshSlots();
     }
+    setConnected(d->ready(), reason);
 }
 
 void Connector::onCommandTimeout()
 {
-    if (++d->commandTimeoutsCounter >= d->config.max_command_errors) {
-        d->commandTimeoutsCounter = d->config.max_command_errors;
-        setConnected(false);
+    if (++d->commandTimeoutsCounter < d->config.max_command_errors) {
+        return;
+    }
+    d->commandTimeoutsCounter = d->config.max_command_errors;
+    // Only lanes, that have unanswered commands, are stalled
+    QVector<const redisAsyncContext*> stalled;
+    for (const auto &lane : qAsConst(d->lanes)) {
+        if (lane.context && lane.context->replies.head) {
+            stalled.append(lane.context);
+        }
+    }
+    if (stalled.isEmpty()) {
+        for (const auto &lane : qAsConst(d->lanes)) {
+            if (lane.context) {
+                stalled.append(lane.context);
+            }
+        }
+    }
+    for (auto context : qAsConst(stalled)) {
+        dropLane(context, QStringLiteral("Command timeout"));
     }
 }
 
 void Connector::selectDb()
 {
-    auto selectCommand = QStringLiteral("SELECT %2").arg(d->config.db_index);
-    runAsyncCommand(&Connector::selectCallback, selectCommand);
+    if (d->cluster) {
+        return;
+    }
+    runOnAllLanes(&Connector::selectCallback, selectCommand());
+}
+
+CommandArgs Connector::selectCommand() const
+{
+    return CommandArgs{"SELECT"} << d->config.db_index;
 }
 
 void Connector::doPing()
 {
-    runAsyncCommand(&Connector::pingCallback, "PING");
+    runOnAllLanes(&Connector::pingCallback, CommandArgs{"PING"});
 }
 
-void Connector::pingCallback(redisReply *replyPtr)
+int Connector::runOnAllLanes(LaneCb callback, const CommandArgs &command)
 {
+    auto status = REDIS_OK;
+    for (auto &lane : d->lanes) {
+        // Dead lanes get it on connect
+        if (Private::isUsable(lane) && runOnLane(lane.context, callback, command) != REDIS_OK) {
+            status = REDIS_ERR;
+        }
+    }
+    return status;
+}
+
+int Connector::runOnLane(redisAsyncContext *context, LaneCb callback, const CommandArgs &command)
+{
+    auto encoded = command.encoded();
+    auto cbData = connAlloc<CallbackArgsWithData<Connector, redisAsyncContext>>(callback, context);
+    cbData->sentAt = monotonicUs();
+    if (redisAsyncFormattedCommand(context, privateCallbackWithData<Connector, redisAsyncContext>, cbData,
+                                   encoded.data(), size_t(encoded.size())) != REDIS_OK) {
+        connDealloc(cbData);
+        return REDIS_ERR;
+    }
+    startAsyncCommand(false);
+    return REDIS_OK;
+}
+
+void Connector::pingCallback(redisReply *replyPtr, redisAsyncContext *context)
+{
+    // No reply --> context is being freed, disconnectCallback() handles it
+    if (!replyPtr) return;
     auto parsed = parseReply(replyPtr);
     bool connected = parsed.toString() == "PONG" ||
                      parsed.toStringList().startsWith("PONG");
-    setConnected(connected, "Ping error");
+    if (!connected) {
+        dropLane(context, QStringLiteral("Ping error"));
+    }
+}
+
+qint64 Connector::monotonicUs()
+{
+    static QElapsedTimer clock = []{
+        QElapsedTimer result;
+        result.start();
+        return result;
+    }();
+    return clock.nsecsElapsed() / 1000 + 1; // 0 is "not stamped"
+}
+
+bool Connector::admitToWindow(int toSend, int commands)
+{
+    return d->window.admit(toSend, commands);
 }
 
 void Connector::startAsyncCommand(bool bypassTrack)
 {
+    ++d->totalCommands;
+    if (d->window.start()) {
+        workerWarn(this) << "In-flight window full:" << d->window.maxInFlight() << "; Rejecting new commands";
+        emit backpressure(true);
+    }
     if (d->pingTimer) {
         d->pingTimer->stop();
     }
@@ -126,15 +477,87 @@ void Connector::startAsyncCommand(bool bypassTrack)
     }
 }
 
-void Connector::finishAsyncCommand()
+void Connector::finishAsyncCommand(qint64 sentAt)
 {
-    setConnected(true);
-    if (!commandsLeft()) {
+    const auto drained = d->window.finish();
+    if (sentAt) {
+        const auto latency = monotonicUs() - sentAt;
+        const auto average = d->latencyUs.load();
+        d->latencyUs = average + ((latency - average) >> LATENCY_EWMA_SHIFT);
+        if (latency > d->maxLatencyUs) {
+            d->maxLatencyUs = latency;
+        }
+    }
+    if (d->ready()) {
+        setConnected(true);
+    }
+    if (drained) {
+        workerInfo(this) << "In-flight window drained";
+        emit backpressure(false);
+    }
+    if (!d->window.inFlight()) {
         emit commandsFinished();
     }
 }
 
-void Connector::selectCallback(redisReply *reply)
+QVariantMap Connector::stats() const
+{
+    return {
+        {"in_flight", d->window.inFlight()},
+        {"max_in_flight", d->window.maxInFlight()},
+        {"reply_latency_us", d->latencyUs.load()},
+        {"max_reply_latency_us", d->maxLatencyUs.load()},
+        {"total_commands", d->totalCommands.load()},
+        {"rejected_commands", d->window.rejected()},
+        {"connected", isConnected()},
+        {"connections", d->lanes.size()},
+        {"connected_lanes", d->connectedLanes()},
+        {"spilled", d->spill ? d->spill->count() : 0},
+    };
+}
+
+void Connector::hello(redisAsyncContext *context)
+{
+    // Sent before any other command, so everything after is parsed as RESP3
+    redisAsyncSetPushCallback(context, pushCallback);
+    auto cbData = connAlloc<CallbackArgs<Connector>>(&Connector::helloCallback);
+    const auto command = CommandArgs{"HELLO", "3"};
+    auto encoded = command.encoded();
+    cbData->sentAt = monotonicUs();
+    if (redisAsyncFormattedCommand(context, privateCallback<Connector>, cbData, encoded.data(), size_t(encoded.size())) != REDIS_OK) {
+        connDealloc(cbData);
+    } else {
+        startAsyncCommand(true);
+    }
+}
+
+void Connector::helloCallback(redisReply *reply)
+{
+    d->resp3 = reply && reply->type == ReplyMap;
+    if (!d->resp3) {
+        workerWarn(this) << "RESP3 not supported by server, using RESP2:" << parseReply(reply);
+    }
+}
+
+void Connector::pushCallback(redisAsyncContext *context, void *reply)
+{
+    auto adapter = static_cast<Connector *>(context->data);
+    if (adapter) {
+        adapter->onPush(static_cast<redisReply*>(reply));
+    }
+}
+
+void Connector::onPush(redisReply *reply)
+{
+    workerWarn(this) << "Unhandled push message:" << parseReply(reply);
+}
+
+bool Connector::isResp3() const
+{
+    return d->resp3;
+}
+
+void Connector::selectCallback(redisReply *reply, redisAsyncContext *)
 {
     workerInfo(this) << "select status:" << parseReply(reply).toString();
 }
@@ -142,35 +565,302 @@ void Connector::selectCallback(redisReply *reply)
 void Connector::connectCallback(const redisAsyncContext *context, int status)
 {
     auto adapter = static_cast<Connector *>(context->data);
-    workerInfo(adapter) << "Connected with status" << status;
+    auto lane = adapter ? adapter->d->laneOf(context) : nullptr;
+    if (!lane) return;
+    workerInfo(adapter) << "Connected to" << lane->name << "with status" << status;
+    const auto index = adapter->d->indexOf(lane);
     if (status != REDIS_OK) {
-        // hiredis already freed the context
-        adapter->d->redisContext = nullptr;
+        // Context is freed by hiredis right after this returns
+        adapter->failAwaiting(index, index + 1);
+        lane->context = nullptr;
         adapter->d->reconnectTimer->start();
     } else {
-        adapter->setConnected(true);
+        const bool routed = lane != &adapter->d->subscriber;
+        // Subscriber too: its messages then come as pushes (still to (P)SUBSCRIBE callback), other pushes --> onPush()
+        if (adapter->d->config.protocol == 3) {
+            adapter->hello(lane->context);
+        }
+        // Queued before anything routed here, since lane is not usable until this returns
+        if (!adapter->d->cluster && routed) {
+            adapter->runOnLane(lane->context, &Connector::selectCallback, adapter->selectCommand());
+        }
+        lane->connected = true;
+        if (!routed) {
+            adapter->restoreSubscriptions();
+        } else if (adapter->d->cluster) {
+            adapter->sendAwaiting(index);
+        }
+        if (adapter->d->cluster && !adapter->d->slotsLoaded && routed) {
+            adapter->refreshSlots();
+        } else if (adapter->d->ready()) {
+            adapter->setConnected(true);
+        }
+    }
+}
+
+void Connector::refreshSlots()
+{
+    if (d->slotsRefreshing) return;
+    // Any live node knows the whole map, so one dead node (seed too) does not block the refresh
+    redisAsyncContext *seed = nullptr;
+    for (const auto &lane : qAsConst(d->lanes)) {
+        if (Private::isUsable(lane)) {
+            seed = lane.context;
+            break;
+        }
+    }
+    if (!seed) return;
+    const auto command = CommandArgs{"CLUSTER", "SLOTS"};
+    auto encoded = command.encoded();
+    if (redisAsyncFormattedCommand(seed, slotsCallback, nullptr, encoded.data(), size_t(encoded.size())) == REDIS_OK) {
+        d->slotsRefreshing = true;
+    }
+}
+
+void Connector::slotsCallback(redisAsyncContext *context, void *reply, void *)
+{
+    auto adapter = static_cast<Connector *>(context->data);
+    if (adapter) {
+        adapter->onSlots(static_cast<redisReply*>(reply));
+    }
+}
+
+void Connector::onSlots(redisReply *reply)
+{
+    d->slotsRefreshing = false;
+    if (!reply) return;
+    if (reply->type != ReplyArray) {
+        workerError(this) << "CLUSTER SLOTS failed, routing everything to first server:" << parseReply(reply);
+        d->slots.clear();
+    } else {
+        d->slots.fill(-1, CLUSTER_SLOTS);
+        // 1) start 2) end 3) master [host, port, id] 4...) replicas
+        for (size_t i = 0; i < reply->elements; ++i) {
+            auto range = reply->element[i];
+            if (range->type != ReplyArray || range->elements < 3 || range->element[2]->elements < 2) continue;
+            auto master = range->element[2];
+            const auto node = clusterNode(toString(master->element[0]), quint16(master->element[1]->integer));
+            const auto end = qMin<long long>(range->element[1]->integer, CLUSTER_SLOTS - 1);
+            for (auto slot = range->element[0]->integer; slot <= end; ++slot) {
+                d->slots[slot] = qint16(node);
+            }
+        }
+        workerInfo(this) << "Cluster nodes:" << d->lanes.size() / d->poolSize;
+    }
+    d->slotsLoaded = true;
+    connectLanes();
+    if (d->ready()) {
+        setConnected(true);
+    }
+}
+
+int Connector::clusterNode(const QString &host, quint16 port)
+{
+    // Empty host --> same host as the node we asked
+    const auto &nodeHost = host.isEmpty() ? d->lanes.constFirst().host : host;
+    auto node = d->findNode(nodeHost, port);
+    if (node >= 0) {
+        return node;
+    }
+    node = d->lanes.size() / d->poolSize;
+    const auto name = QStringLiteral("%1:%2").arg(nodeHost).arg(port);
+    for (int conn = 0; conn < d->poolSize; ++conn) {
+        d->lanes.append(ConnectorLane{name, nodeHost, port});
+        if (d->started) {
+            d->lanes.last().client = new RedisQtAdapter(this);
+        }
+    }
+    return node;
+}
+
+void Connector::clusterCallback(redisAsyncContext *context, void *reply, void *data)
+{
+    auto adapter = static_cast<Connector *>(context->data);
+    auto command = static_cast<ClusterCommand*>(data);
+    if (command->batch) {
+        onBatchReply(adapter, context, static_cast<redisReply*>(reply), command);
+        return;
+    }
+    if (adapter && adapter->redirect(static_cast<redisReply*>(reply), command)) {
+        return;
+    }
+    if (command->callback) {
+        command->callback(context, reply, command->cbData);
+    }
+    delete command;
+}
+
+bool Connector::redirect(redisReply *reply, ClusterCommand *command)
+{
+    if (command->redirects >= CLUSTER_MAX_REDIRECTS) {
+        return false;
+    }
+    const auto target = ClusterRedirect::parse(reply);
+    if (!target.isValid()) {
+        return false;
+    }
+    const auto node = redirectedNode(target);
+    command->asking = target.ask;
+    ++command->redirects;
+    return dispatch(node * d->poolSize + command->slot % d->poolSize, command);
+}
+
+int Connector::redirectedNode(const ClusterRedirect &target)
+{
+    const auto node = clusterNode(target.host, target.port);
+    if (!target.ask) {
+        if (!d->slots.isEmpty()) {
+            d->slots[target.slot] = qint16(node);
+        }
+        refreshSlots();
+    }
+    connectLanes();
+    return node;
+}
+
+bool Connector::dispatch(int lane, ClusterCommand *command)
+{
+    const auto &target = d->lanes[lane];
+    if (Private::isUsable(target)) {
+        return sendClustered(target.context, command) == REDIS_OK;
+    }
+    // Still connecting: waits for it. Dead --> caller gets the reply, that caused redirect
+    if (!target.context || target.context->err || target.dropped) {
+        return false;
     }
+    d->awaiting.append({lane, command});
+    return true;
+}
+
+int Connector::sendClustered(redisAsyncContext *context, ClusterCommand *command)
+{
+    if (command->asking) {
+        const static CommandArgs asking{"ASKING"};
+        auto encoded = asking.encoded();
+        redisAsyncFormattedCommand(context, nullptr, nullptr, encoded.data(), size_t(encoded.size()));
+    }
+    return redisAsyncFormattedCommand(context, clusterCallback, command,
+                                      command->encoded.constData(), size_t(command->encoded.size()));
+}
+
+void Connector::sendAwaiting(int lane)
+{
+    auto context = d->lanes[lane].context;
+    // Swapped out: commands, that fail, are called back and can be redirected again
+    const auto awaiting = std::exchange(d->awaiting, {});
+    for (const auto &[index, command] : awaiting) {
+        if (index != lane) {
+            d->awaiting.append({index, command});
+        } else if (sendClustered(context, command) != REDIS_OK) {
+            clusterCallback(context, nullptr, command);
+        }
+    }
+}
+
+void Connector::failAwaiting(int fromLane, int toLane)
+{
+    const auto awaiting = std::exchange(d->awaiting, {});
+    for (const auto &[index, command] : awaiting) {
+        if (index < fromLane || index >= toLane) {
+            d->awaiting.append({index, command});
+        } else {
+            // Same as for commands, pending on context, that is freed. Lane context is still alive here
+            clusterCallback(d->lanes[index].context, nullptr, command);
+        }
+    }
+}
+
+void Connector::onBatchReply(Connector *adapter, redisAsyncContext *context, redisReply *reply, ClusterCommand *command)
+{
+    auto batch = command->batch;
+    if (adapter && batch->node < 0 && batch->redirects < CLUSTER_MAX_REDIRECTS) {
+        const auto target = ClusterRedirect::parse(reply);
+        if (target.isValid()) {
+            batch->node = adapter->redirectedNode(target);
+            batch->ask = target.ask;
+        }
+    }
+    // Rest of redirected transaction fails (EXECABORT) or is lost with its connection: it is resent whole
+    const bool resending = batch->node >= 0 && (!reply || reply->type == ReplyError);
+    if (!resending && command->callback) {
+        command->callback(context, reply, command->cbData);
+        // Already called back: resent without callback
+        command->callback = nullptr;
+    }
+    if (--batch->left) {
+        return;
+    }
+    if (batch->node >= 0 && adapter && adapter->resendBatch(batch)) {
+        return;
+    }
+    for (auto queued : qAsConst(batch->commands)) {
+        if (queued->callback) {
+            queued->callback(context, nullptr, queued->cbData);
+        }
+    }
+    delete batch;
+}
+
+bool Connector::resendBatch(ClusterBatch *batch)
+{
+    const auto lane = std::exchange(batch->node, -1) * d->poolSize + batch->slot % d->poolSize;
+    ++batch->redirects;
+    // ASKING before MULTI covers whole transaction
+    batch->commands.constFirst()->asking = batch->ask;
+    for (auto command : qAsConst(batch->commands)) {
+        if (!dispatch(lane, command)) {
+            // Unsent ones are called back with the rest, once sent ones are replied
+            break;
+        }
+        ++batch->left;
+    }
+    return batch->left > 0;
 }
 
 QVariantMap Connector::parseHashReply(redisReply *reply) const
 {
-    auto subresult = parseReply(reply).toList();
     QVariantMap result;
-    for (int i = 1; i < subresult.size(); i+=2) {
-        result.insert(subresult[i-1].toString(), subresult[i]);
+    if (!isHashReply(reply)) {
+        parseReply(reply);
+        return result;
+    }
+    for (size_t i = 1; i < reply->elements; i += 2) {
+        result.insert(toString(reply->element[i - 1]), parseReply(reply->element[i]));
     }
     return result;
 }
 
+JsonDict Connector::parseHashReplyNested(redisReply *reply, QChar separator) const
+{
+    JsonDict result;
+    if (!isHashReply(reply)) {
+        parseReply(reply);
+        return result;
+    }
+    for (size_t i = 1; i < reply->elements; i += 2) {
+        result.insert(toString(reply->element[i - 1]), parseReply(reply->element[i]), separator);
+    }
+    return result;
+}
+
+QString Connector::toString(const redisReply *reply)
+{
+    if (!reply || !reply->str) {
+        return {};
+    }
+    return QString::fromUtf8(reply->str, qsizetype(reply->len));
+}
+
 QVariant Connector::parseReply(redisReply *reply) const
 {
     if (!reply) {
         return {};
     }
     auto array = QVariantList{};
+    auto map = QVariantMap{};
     switch (reply->type) {
     case ReplyString:
-        return QString(reply->str);
+        return toString(reply);
     case ReplyArray:
         for (size_t i = 0; i < reply->elements; ++i) {
             array.append(parseReply(reply->element[i]));
@@ -181,7 +871,7 @@ QVariant Connector::parseReply(redisReply *reply) const
     case ReplyNil:
         return {};
     case ReplyStatus:
-        return QString(reply->str);
+        return toString(reply);
     case ReplyError:
         workerError(this) << "Received Error Reply:" << reply->str;
         return {};
@@ -190,20 +880,25 @@ QVariant Connector::parseReply(redisReply *reply) const
     case ReplyBool:
         return bool(reply->integer);
     case ReplyMap:
-        throw std::runtime_error("REDIS_REPLY_MAP Unsupported");
+    case ReplyAttr:
+        for (size_t i = 1; i < reply->elements; i += 2) {
+            map.insert(toString(reply->element[i - 1]), parseReply(reply->element[i]));
+        }
+        return map;
     case ReplySet:
         for (size_t i = 0; i < reply->elements; ++i) {
             array.append(parseReply(reply->element[i]));
         }
         return array;
-    case ReplyAttr:
-        throw std::runtime_error("REDIS_REPLY_ATTR Unsupported");
     case ReplyPush:
-        throw std::runtime_error("REDIS_REPLY_PUSH Unsupported");
+        for (size_t i = 0; i < reply->elements; ++i) {
+            array.append(parseReply(reply->element[i]));
+        }
+        return array;
     case ReplyBignum:
-        return QString(reply->str);
+        return toString(reply);
     case ReplyVerb:
-        return QString(reply->str);
+        return toString(reply);
     default:
         return {};
     }
@@ -212,10 +907,20 @@ QVariant Connector::parseReply(redisReply *reply) const
 void Connector::disconnectCallback(const redisAsyncContext *context, int status)
 {
     auto adapter = static_cast<Connector *>(context->data);
-    workerInfo(adapter) << "Disconnected with status" << status;
-    adapter->setConnected(false);
-    adapter->d->redisContext = nullptr;
-    adapter->setConnected(false);
+    if (!adapter) return;
+    auto lane = adapter->d->laneOf(context);
+    if (!lane) return;
+    workerInfo(adapter) << "Disconnected from" << lane->name << "with status" << status;
+    lane->context = nullptr;
+    lane->connected = false;
+    if (!adapter->d->connectedLanes()) {
+        adapter->d->resp3 = false;
+    }
+    adapter->d->reconnectTimer->start();
+    if (adapter->d->cluster && lane != &adapter->d->subscriber) {
+        adapter->refreshSlots();
+    }
+    adapter->setConnected(adapter->d->ready(), QStringLiteral("Disconnected from ") + lane->name);
 }
 
 bool Connector::isConnected() const
@@ -223,32 +928,126 @@ bool Connector::isConnected() const
     return d->isConnected;
 }
 
-void Connector::waitConnected(Radapter::Worker *who) const
+bool Connector::isBackpressured() const
 {
-    auto name = who ? who->printSelf() : QStringLiteral("Unknown");
-    workerInfo(this) << name << " is waiting for connection...";
-    while (!isConnected()) {
-        QThread::usleep(50);
-    }
+    return d->window.isBackpressured();
 }
 
 int Connector::runAsyncCommand(const QString &command)
 {
-    if (!isConnected() || !isValidContext()) {
+    if (!isConnected()) {
         return REDIS_ERR;
     }
-    return redisAsyncCommand(d->redisContext, nullptr, nullptr, command.toStdString().c_str());
+    return sendCommand(nullptr, nullptr, command);
 }
 
-int Connector::commandsLeft() const
+int Connector::runAsyncCommand(const CommandArgs &command)
+{
+    if (!isConnected()) {
+        return REDIS_ERR;
+    }
+    return sendCommand(nullptr, nullptr, command);
+}
+
+int Connector::sendCommand(redisCallbackFn *callback, void *cbData, const QString &command)
 {
-    auto count = 0;
-    auto current = context()->replies.head;
-    while(current) {
-        count++;
-        current = current->next;
+    return sendCommand(callback, cbData, CommandArgs::fromString(command));
+}
+
+int Connector::sendCommand(redisCallbackFn *callback, void *cbData, const CommandArgs &command)
+{
+    if (command.isEmpty()) {
+        return REDIS_ERR;
+    }
+    return sendEncoded(callback, cbData, command.encoded(), command.routingKey());
+}
+
+int Connector::sendEncoded(redisCallbackFn *callback, void *cbData, QByteArrayView encoded, QByteArrayView routingKey)
+{
+    const auto &lane = d->lanes[d->laneFor(routingKey)];
+    // Only commands routed to dropped lane fail
+    if (!Private::isUsable(lane)) {
+        return REDIS_ERR;
+    }
+    auto target = lane.context;
+    if (d->cluster) {
+        auto wrapped = new ClusterCommand{callback, cbData, encoded.toByteArray(), clusterSlot(routingKey)};
+        auto status = redisAsyncFormattedCommand(target, clusterCallback, wrapped, encoded.data(), size_t(encoded.size()));
+        if (status != REDIS_OK) {
+            delete wrapped;
+        }
+        return status;
+    }
+    return redisAsyncFormattedCommand(target, callback, cbData, encoded.data(), size_t(encoded.size()));
+}
+
+void Connector::pipelineCommand(const CommandArgs &command)
+{
+    enqueuePipelined(nullptr, nullptr, nullptr, nullptr, command);
+}
+
+void Connector::enqueuePipelined(redisCallbackFn *callback, void *cbData, qint64 *sentAt, void (*dealloc)(void *), const CommandArgs &command)
+{
+    // Whole pipeline goes to one connection (MULTI/EXEC must not be split), picked by first key
+    if (d->pipelineLane < 0 && !command.routingKey().isEmpty()) {
+        d->pipelineLane = d->laneFor(command.routingKey());
+        d->pipelineSlot = clusterSlot(command.routingKey());
+    }
+    d->pipeline.append(callback, cbData, sentAt, dealloc, command);
+}
+
+int Connector::pipelinedCount() const
+{
+    return d->pipeline.count();
+}
+
+int Connector::flushPipeline(bool needBypassTracking, int *sentCount)
+{
+    const auto &lane = d->lanes[d->pipelineLane < 0 ? d->keylessLane() : d->pipelineLane];
+    const auto slot = d->pipelineSlot;
+    d->pipelineLane = -1;
+    d->pipelineSlot = 0;
+    // Whole pipeline is refused up front if it does not fit into window (not cut in the middle)
+    const auto canSend = isConnected() && Private::isUsable(lane) && admitToWindow(d->pipeline.callbacks(), d->pipeline.count());
+    auto target = lane.context;
+    // Cluster mode: commands are redirected one by one, transaction only as a whole
+    auto batch = d->cluster && d->pipeline.hasTransaction() ? new ClusterBatch{{}, slot} : nullptr;
+    auto result = d->pipeline.send([&](redisCallbackFn *callback, void *cbData, QByteArrayView encoded){
+        auto status = REDIS_OK;
+        if (d->cluster) {
+            auto wrapped = new ClusterCommand{callback, cbData, encoded.toByteArray(), slot};
+            wrapped->batch = batch;
+            status = sendClustered(target, wrapped);
+            if (status != REDIS_OK) {
+                delete wrapped;
+            } else if (batch) {
+                batch->commands.append(wrapped);
+                ++batch->left;
+            }
+        } else {
+            status = redisAsyncFormattedCommand(target, callback, cbData, encoded.data(), size_t(encoded.size()));
+        }
+        // Only commands with callbacks are finished, so only they are counted
+        if (status == REDIS_OK && callback) {
+            startAsyncCommand(needBypassTracking);
+        }
+        return status;
+    }, canSend, monotonicUs());
+    if (batch && batch->commands.isEmpty()) {
+        delete batch;
+    }
+    if (result.transactionOpen) {
+        dropLane(target, QStringLiteral("Transaction could not be closed"));
     }
-    return count;
+    if (sentCount) {
+        *sentCount = result.sent;
+    }
+    return result.status;
+}
+
+int Connector::commandsLeft() const
+{
+    return d->window.inFlight();
 }
 
 void Connector::setConnected(bool state, const QString &reason)
@@ -291,17 +1090,200 @@ void Connector::disablePingKeepalive()
 
 redisAsyncContext *Connector::context()
 {
-    return d->redisContext;
+    return d->lanes.constFirst().context;
 }
 
 const redisAsyncContext *Connector::context() const
 {
-    return d->redisContext;
+    return d->lanes.constFirst().context;
+}
+
+int Connector::poolSize() const
+{
+    return d->lanes.size();
+}
+
+bool Connector::isValidContext(QByteArrayView routingKey) const
+{
+    return Private::isUsable(d->lanes[d->laneFor(routingKey)]);
+}
+
+void Connector::subscribe(const QStringList &channels, bool patterns)
+{
+    if (!d->hasSubscriber) {
+        const auto &first = d->lanes.constFirst();
+        d->subscriber = ConnectorLane{first.name + QStringLiteral(" (pub/sub)"), first.host, first.port, first.unixSocket};
+        d->hasSubscriber = true;
+        if (d->started) {
+            d->subscriber.client = new RedisQtAdapter(this);
+            connectLanes();
+        }
+    }
+    auto &known = patterns ? d->patterns : d->channels;
+    QStringList added;
+    for (const auto &channel : channels) {
+        if (!known.contains(channel)) {
+            known.append(channel);
+            added.append(channel);
+        }
+    }
+    if (d->subscriber.connected) {
+        sendSubscribe(added, patterns);
+    }
+}
+
+void Connector::restoreSubscriptions()
+{
+    if (!d->hasSubscriber) return;
+    sendSubscribe(d->channels, false);
+    sendSubscribe(d->patterns, true);
+}
+
+void Connector::sendSubscribe(const QStringList &channels, bool patterns)
+{
+    if (channels.isEmpty() || !d->subscriber.context) return;
+    auto command = CommandArgs{patterns ? "PSUBSCRIBE" : "SUBSCRIBE"};
+    for (const auto &channel : channels) {
+        command << channel;
+    }
+    auto encoded = command.encoded();
+    // hiredis keeps callback per channel and calls it for every message, until UNSUBSCRIBE
+    if (redisAsyncFormattedCommand(d->subscriber.context, messageCallback, nullptr, encoded.data(), size_t(encoded.size())) != REDIS_OK) {
+        workerError(this) << "Could not subscribe to:" << channels;
+    }
+}
+
+void Connector::messageCallback(redisAsyncContext *context, void *reply, void *)
+{
+    auto adapter = static_cast<Connector *>(context->data);
+    if (!adapter) return;
+    // (P)SUBSCRIBE confirmations come here too, they are skipped
+    const auto message = PubSubMessage::parse(static_cast<redisReply*>(reply));
+    if (message.isValid()) {
+        adapter->onMessage(message.pattern, message.channel, message.payload);
+    }
+}
+
+void Connector::onMessage(const QString &pattern, const QString &channel, redisReply *message)
+{
+    workerWarn(this) << "Unhandled message on" << channel << "(pattern:" << pattern << "):" << toString(message);
+}
+
+void Connector::enableSpill(const Settings::RedisSpill &config)
+{
+    if (d->spill) {
+        return;
+    }
+    auto path = config.file.value;
+    if (QDir::isRelativePath(path)) {
+        path = QDir(LocalStorage::instance()->currentDirectory()).filePath(path);
+    }
+    d->spill = new SpillFile(path, qint64(config.max_mb) * 1024 * 1024);
+    if (!d->spill->open()) {
+        throw std::runtime_error("Could not open spill file: " + path.toStdString());
+    }
+    d->spillBatch = qMax(1, int(config.replay_rate * SPILL_REPLAY_INTERVAL_MS / 1000));
+    d->spillTimer = new QTimer(this);
+    d->spillTimer->setInterval(SPILL_REPLAY_INTERVAL_MS);
+    d->spillTimer->callOnTimeout(this, &Connector::replaySpill);
+    connect(this, &Connector::connected, d->spillTimer, QOverload<>::of(&QTimer::start));
+    connect(this, &Connector::disconnected, d->spillTimer, &QTimer::stop);
+    if (!d->spill->isEmpty()) {
+        workerWarn(this) << "Spill file" << path << "has" << d->spill->count() << "commands, replaying them after connect";
+    }
+}
+
+bool Connector::isSpillEnabled() const
+{
+    return d->spill;
 }
 
-bool Connector::isValidContext()
+bool Connector::isSpilling() const
 {
-    return context() && !context()->err;
+    return d->spill && !d->spill->isEmpty();
+}
+
+int Connector::spill(const CommandArgs &command)
+{
+    if (!d->spill || command.isEmpty()) {
+        return REDIS_ERR;
+    }
+    const bool wasEmpty = d->spill->isEmpty();
+    if (!d->spill->append(command.routingKey(), command.encoded())) {
+        return REDIS_ERR;
+    }
+    if (wasEmpty) {
+        workerWarn(this) << "Redis unavailable, spilling writes to:" << d->spill->path();
+    }
+    if (isConnected() && !d->spillTimer->isActive()) {
+        d->spillTimer->start();
+    }
+    return REDIS_OK;
+}
+
+void Connector::replaySpill()
+{
+    if (!d->spill || d->spill->isEmpty()) {
+        d->spillTimer->stop();
+        return;
+    }
+    if (d->spillReplay || !isConnected()) {
+        return;
+    }
+    QVector<SpillFile::Record> records;
+    const auto offset = d->spill->peek(d->spillBatch, records);
+    auto replay = new SpillReplay{offset, int(records.size())};
+    // Sent one after another, so hiredis writes them as a pipeline
+    for (const auto &record : qAsConst(records)) {
+        if (sendEncoded(spillCallback, replay, record.command, record.key) != REDIS_OK) {
+            replay->failed = true;
+            break;
+        }
+        ++replay->left;
+        startAsyncCommand(false);
+    }
+    if (!replay->left) {
+        delete replay;
+        return;
+    }
+    d->spillReplay = replay;
+}
+
+void Connector::spillCallback(redisAsyncContext *context, void *reply, void *data)
+{
+    auto adapter = static_cast<Connector *>(context->data);
+    auto replay = static_cast<SpillReplay*>(data);
+    if (adapter) {
+        adapter->onSpillReplayed(static_cast<redisReply*>(reply), replay);
+    } else if (!--replay->left) {
+        delete replay;
+    }
+}
+
+void Connector::onSpillReplayed(redisReply *reply, SpillReplay *replay)
+{
+    finishAsyncCommand();
+    if (!reply) {
+        replay->failed = true;
+    } else if (reply->type == ReplyError) {
+        // Would fail again on retry, so it is dropped
+        workerError(this) << "Spilled command failed:" << reply->str;
+    }
+    if (--replay->left) {
+        return;
+    }
+    if (d->spillReplay == replay) {
+        d->spillReplay = nullptr;
+    }
+    // Failed batch stays in file and is replayed whole again
+    if (!replay->failed) {
+        d->spill->commit(replay->offset, replay->count);
+        if (d->spill->isEmpty()) {
+            workerInfo(this) << "All spilled writes replayed";
+            emit spillReplayed();
+        }
+    }
+    delete replay;
 }
 
 void Connector::setDbIndex(const quint16 dbIndex)
@@ -316,7 +1298,16 @@ void Connector::onRun()
 {
     workerInfo(this, .noquote().nospace()) << ": Connnecting to: " << d->config.print() <<
                                     "(Host: " << d->config.server.host.value << "; Port: " << d->config.server.port.value << ")";
-    d->client = new RedisQtAdapter(this);
+    if (!d->config.server.unix_socket->isEmpty()) {
+        workerInfo(this) << "Using unix socket:" << d->config.server.unix_socket.value;
+    }
+    if (d->lanes.size() > 1) {
+        workerInfo(this) << "Connections in pool:" << d->lanes.size() << "; Shards:" << d->lanes.size() / d->poolSize;
+    }
+    d->forEachLane([this](ConnectorLane &lane) {
+        lane.client = new RedisQtAdapter(this);
+    });
+    d->started = true;
     tryConnect();
     Radapter::Worker::onRun();
 }
@@ -3,11 +3,15 @@
 
 #include "broker/workers/worker.h"
 #include "lib/hiredis/adapters/qt.h"
+#include "formatting/redis/rediscommandargs.h"
 
 namespace Settings {
 struct RedisConnector;
+struct RedisSpill;
 }
 namespace Redis {
+class SpillFile;
+struct ClusterRedirect;
 class RADAPTER_API Connector : public Radapter::Worker
 {
     Q_OBJECT
@@ -37,12 +41,22 @@ public:
     explicit Connector(const Settings::RedisConnector &settings, QThread *thread);
     ~Connector() override;
     bool isConnected() const;
-    void waitConnected(Radapter::Worker *who = nullptr) const;
+    //! In-flight commands (sent, waiting for reply). O(1)
     int commandsLeft() const;
+    //! Thread-safe gauges: in-flight depth, reply latency, rejected by max_in_flight
+    QVariantMap stats() const;
+    //! Total connections (pool_size * servers)
+    int poolSize() const;
+    //! Last state reported by backpressure()
+    bool isBackpressured() const;
 signals:
     void connected();
     void disconnected();
     void commandsFinished();
+    //! true --> max_in_flight reached, new commands are rejected (REDIS_ERR) until half of window is free
+    void backpressure(bool active);
+    //! Spill became empty: every spilled command was replayed and replied
+    void spillReplayed();
 protected slots:
     void onRun() override;
     void tryConnect();
@@ -57,14 +71,57 @@ protected:
     template <class User>
     int runAsyncCommand(MethodCb<User> callback, const QString &command, bool needBypassTracking = false);
     int runAsyncCommand(const QString &command);
+    template <class User, class Data>
+    int runAsyncCommand(MethodCbWithData<User, Data> callback, const CommandArgs &command, Data* data, bool needBypassTracking = false);
+    template <class User>
+    int runAsyncCommand(MethodCb<User> callback, const CommandArgs &command, bool needBypassTracking = false);
+    int runAsyncCommand(const CommandArgs &command);
+    //! Pipeline: commands are encoded into one buffer and handed to hiredis together on flushPipeline(),
+    //! hiredis then sends them in a single write. Callbacks are called per command, same as runAsyncCommand().
+    //! See Redis::Pipeline
+    template <class User, class Data>
+    void pipelineCommand(MethodCbWithData<User, Data> callback, const CommandArgs &command, Data* data);
+    template <class User>
+    void pipelineCommand(MethodCb<User> callback, const CommandArgs &command);
+    void pipelineCommand(const CommandArgs &command);
+    int pipelinedCount() const;
+    //! Sending stops at first command that fails, so commands are sent as a prefix of the pipeline.
+    //! Callbacks (and data) of commands that were not sent are never called.
+    //! Transaction cut in the middle is discarded (connection is dropped, if even DISCARD can not be sent).
+    //! Nothing is sent, if commands with callbacks do not fit into max_in_flight window.
+    //! Cluster mode: keyed commands must share one slot. MOVED/ASK resends commands one by one, transaction as a whole
+    //! \param sentCount commands, that were handed to hiredis (their callbacks own their data)
+    //! \return REDIS_ERR if any of queued commands could not be sent
+    int flushPipeline(bool needBypassTracking = false, int *sentCount = nullptr);
     void setDbIndex(const quint16 dbIndex);
     QVariant parseReply(redisReply *reply) const;
     QVariantMap parseHashReply(redisReply *reply) const;
-    bool isValidContext();
+    //! Decodes field/value pairs straight into nested dict (no intermediate lists)
+    JsonDict parseHashReplyNested(redisReply *reply, QChar separator = ':') const;
+    static QString toString(const redisReply *reply);
+    //! Connection, that commands with this routing key go to, is up
+    bool isValidContext(QByteArrayView routingKey = {}) const;
+    bool isResp3() const;
+    //! RESP3 out-of-band messages (e.g. CLIENT TRACKING invalidations). Reply is freed after return
+    virtual void onPush(redisReply *reply);
+    //! Pub/sub on dedicated connection (created on first call), so normal commands are not blocked by it.
+    //! Subscriptions are restored after reconnect. Messages (RESP2 arrays or RESP3 pushes) --> onMessage()
+    void subscribe(const QStringList &channels, bool patterns = false);
+    //! Pattern is empty for SUBSCRIBE channels. Reply is freed after return
+    virtual void onMessage(const QString &pattern, const QString &channel, redisReply *message);
     void setConnected(bool state, const QString &reason = {});
     void enablePingKeepalive();
     void disablePingKeepalive();
+    //! Durable buffer for writes, which redis can not take now (disconnected, max_in_flight reached).
+    //! Spilled commands are replayed in order after connect, throttled to replay_rate. Delivery is at-least-once
+    void enableSpill(const Settings::RedisSpill &config);
+    bool isSpillEnabled() const;
+    //! While true, new writes must go to spill() too, so order is kept
+    bool isSpilling() const;
+    //! \return REDIS_ERR if spill is not enabled or is full
+    int spill(const CommandArgs &command);
 
+    //! First connection of pool (the one keyless commands go to)
     redisAsyncContext *context();
     const redisAsyncContext* context() const;
 private:
@@ -74,26 +131,81 @@ private:
     static void privateCallback(redisAsyncContext* ctx, void* reply, void* data);
     static void connectCallback(const redisAsyncContext *context, int status);
     static void disconnectCallback(const redisAsyncContext *context, int status);
-    void selectCallback(redisReply *replyPtr);
-    void pingCallback(redisReply *replyPtr);
+    static void pushCallback(redisAsyncContext *context, void *reply);
+    static void messageCallback(redisAsyncContext *context, void *reply, void *);
+    void restoreSubscriptions();
+    void sendSubscribe(const QStringList &channels, bool patterns);
+    struct ClusterCommand;
+    struct ClusterBatch;
+    static void slotsCallback(redisAsyncContext *context, void *reply, void *);
+    static void clusterCallback(redisAsyncContext *context, void *reply, void *data);
+    static void onBatchReply(Connector *adapter, redisAsyncContext *context, redisReply *reply, ClusterCommand *command);
+    void refreshSlots();
+    void onSlots(redisReply *reply);
+    //! \return node index (adds connections to unknown node)
+    int clusterNode(const QString &host, quint16 port);
+    //! \return true if command was resent to other node (or waits for its connection)
+    bool redirect(redisReply *reply, ClusterCommand *command);
+    //! Updates slot map on MOVED. \return node index
+    int redirectedNode(const ClusterRedirect &target);
+    bool resendBatch(ClusterBatch *batch);
+    //! Sends command to lane, or queues it until lane connects. \return false if lane is dead
+    bool dispatch(int lane, ClusterCommand *command);
+    int sendClustered(redisAsyncContext *context, ClusterCommand *command);
+    void sendAwaiting(int lane);
+    //! Commands, that wait for lanes [fromLane, toLane), get nullptr reply
+    void failAwaiting(int fromLane, int toLane);
+    void connectLanes();
+    void hello(redisAsyncContext *context);
+    //! Callback gets context, command was sent to
+    using LaneCb = MethodCbWithData<Connector, redisAsyncContext>;
+    //! Connection-level commands (SELECT, PING) are sent to every live connection of pool
+    int runOnAllLanes(LaneCb callback, const CommandArgs &command);
+    int runOnLane(redisAsyncContext *context, LaneCb callback, const CommandArgs &command);
+    CommandArgs selectCommand() const;
+    //! Marks connection dead (commands routed to it fail) and schedules its reconnect
+    void dropLane(const redisAsyncContext *context, const QString &reason);
+    //! Frees dead connections. \return count of them
+    int clearDeadLanes();
+    void helloCallback(redisReply *replyPtr);
+    void selectCallback(redisReply *replyPtr, redisAsyncContext *context);
+    void pingCallback(redisReply *replyPtr, redisAsyncContext *context);
+    struct SpillReplay;
+    void replaySpill();
+    static void spillCallback(redisAsyncContext *context, void *reply, void *data);
+    void onSpillReplayed(redisReply *reply, SpillReplay *replay);
+    struct CallbackStamp {
+        qint64 sentAt{0};
+    };
+    static qint64 monotonicUs();
+    //! Commands with callbacks fit into max_in_flight window (see Redis::Window). Refused ones are counted as rejected
+    //! \param toSend commands with callbacks, that are about to be sent
+    //! \param commands all commands, that are refused with them
+    bool admitToWindow(int toSend = 1, int commands = 1);
     void startAsyncCommand(bool bypassTrack);
-    void finishAsyncCommand();
-    template <typename CallbackArgs_t, typename Callback>
-    int runAsyncCommandImplementation(Callback callback, const QString &command, CallbackArgs_t* optData, bool needTrackingBypass);
+    void finishAsyncCommand(qint64 sentAt = 0);
+    template <typename CallbackArgs_t, typename Callback, typename CommandT>
+    int runAsyncCommandImplementation(Callback callback, const CommandT &command, CallbackArgs_t* optData, bool needTrackingBypass);
+    int sendCommand(redisCallbackFn *callback, void *cbData, const QString &command);
+    int sendCommand(redisCallbackFn *callback, void *cbData, const CommandArgs &command);
+    int sendEncoded(redisCallbackFn *callback, void *cbData, QByteArrayView encoded, QByteArrayView routingKey);
+    void enqueuePipelined(redisCallbackFn *callback, void *cbData, qint64 *sentAt, void (*dealloc)(void*), const CommandArgs &command);
 
     Private *d;
-    template <class User, class Data>                      
-    struct CallbackArgsWithData {
+    template <class User, class Data>
+    struct CallbackArgsWithData : CallbackStamp {
         MethodCbWithData<User, Data> callback;
         Data *data;
     };
-    template <class User> struct CallbackArgs {
+    template <class User> struct CallbackArgs : CallbackStamp {
         MethodCb<User> callback;
     };
     template <typename CallbackArgs_t, typename ...Args>
     static CallbackArgs_t* connAlloc(Args... args);
     template <typename CallbackArgs_t>
     static void connDealloc(CallbackArgs_t* ptr);
+    template <typename CallbackArgs_t>
+    static void connDeallocErased(void* ptr);
 };
 
 template<typename User>
@@ -118,13 +230,49 @@ int Connector::runAsyncCommand(MethodCb<User> callback, const QString &command,
                                          needBypassTracking);
 }
 
-template <typename CallbackArgs_t, typename Callback>
-int Connector::runAsyncCommandImplementation(Callback callback, const QString &command, CallbackArgs_t* cbData, bool needTrackingBypass) {
-    if (!isConnected() || !isValidContext()) {
+template<typename User, typename Data>
+int Connector::runAsyncCommand(MethodCbWithData<User, Data> callback, const CommandArgs &command, Data* data, bool needBypassTracking) {
+    return runAsyncCommandImplementation<CallbackArgsWithData<User, Data>>(
+                                         privateCallbackWithData<User, Data>,
+                                         command,
+                                         connAlloc<CallbackArgsWithData<User, Data>>(callback, data),
+                                         needBypassTracking);
+}
+template<typename User>
+int Connector::runAsyncCommand(MethodCb<User> callback, const CommandArgs &command, bool needBypassTracking) {
+    return runAsyncCommandImplementation<CallbackArgs<User>>(
+                                         privateCallback<User>,
+                                         command,
+                                         connAlloc<CallbackArgs<User>>(callback),
+                                         needBypassTracking);
+}
+
+template<typename User, typename Data>
+void Connector::pipelineCommand(MethodCbWithData<User, Data> callback, const CommandArgs &command, Data* data) {
+    auto cbData = connAlloc<CallbackArgsWithData<User, Data>>(callback, data);
+    enqueuePipelined(privateCallbackWithData<User, Data>,
+                     cbData, &cbData->sentAt,
+                     connDeallocErased<CallbackArgsWithData<User, Data>>,
+                     command);
+}
+template<typename User>
+void Connector::pipelineCommand(MethodCb<User> callback, const CommandArgs &command) {
+    auto cbData = connAlloc<CallbackArgs<User>>(callback);
+    enqueuePipelined(privateCallback<User>,
+                     cbData, &cbData->sentAt,
+                     connDeallocErased<CallbackArgs<User>>,
+                     command);
+}
+
+template <typename CallbackArgs_t, typename Callback, typename CommandT>
+int Connector::runAsyncCommandImplementation(Callback callback, const CommandT &command, CallbackArgs_t* cbData, bool needTrackingBypass) {
+    // Lane of command is checked on send
+    if (!isConnected() || !admitToWindow()) {
         connDealloc(cbData);
         return REDIS_ERR;
     }
-    auto status = redisAsyncCommand(context(), callback, cbData, command.toStdString().c_str());
+    cbData->sentAt = monotonicUs();
+    auto status = sendCommand(callback, cbData, command);
     if (status != REDIS_OK) {
         connDealloc(cbData);
     } else {
@@ -137,20 +285,20 @@ template<typename User, typename Data>
 void Connector::privateCallbackWithData(redisAsyncContext* ctx, void* reply, void* data) {
     auto args = static_cast<CallbackArgsWithData<User, Data>*>(data);
     (getSender<User>(ctx)->*(args->callback))(static_cast<redisReply*>(reply), static_cast<Data*>(args->data));
-    getSender<User>(ctx)->finishAsyncCommand();
+    getSender<User>(ctx)->finishAsyncCommand(args->sentAt);
     connDealloc(args);
 }
 template<typename User>
 void Connector::privateCallback(redisAsyncContext* ctx, void* reply, void* data) {
     auto args = static_cast<CallbackArgs<User>*>(data);
     (getSender<User>(ctx)->*(args->callback))(static_cast<redisReply*>(reply));
-    getSender<User>(ctx)->finishAsyncCommand();
+    getSender<User>(ctx)->finishAsyncCommand(args->sentAt);
     connDealloc(args);
 }
 
 template <typename CallbackArgs_t, typename ...Args> inline CallbackArgs_t* Connector::connAlloc(Args... args)
 {
-    return new CallbackArgs_t{args...};
+    return new CallbackArgs_t{{}, args...};
 }
 
 template <typename CallbackArgs_t> inline void Connector::connDealloc(CallbackArgs_t* ptr)
@@ -158,6 +306,11 @@ template <typename CallbackArgs_t> inline void Connector::connDealloc(CallbackAr
     delete ptr;
 }
 
+template <typename CallbackArgs_t> inline void Connector::connDeallocErased(void* ptr)
+{
+    connDealloc(static_cast<CallbackArgs_t*>(ptr));
+}
+
 }
 
 #endif // REDISCONNECTOR_H
@@ -0,0 +1,89 @@
+#include "redispipeline.h"
+
+using namespace Redis;
+
+static bool isCommand(QByteArrayView encoded, const CommandArgs &expected)
+{
+    return encoded.compare(expected.encoded(), Qt::CaseInsensitive) == 0;
+}
+
+void Pipeline::append(redisCallbackFn *callback, void *cbData, qint64 *sentAt, void (*dealloc)(void *), const CommandArgs &command)
+{
+    const static CommandArgs multi{"MULTI"}, exec{"EXEC"}, discard{"DISCARD"};
+    auto encoded = command.encoded();
+    auto kind = Plain;
+    if (isCommand(encoded, multi)) {
+        kind = Multi;
+        m_transaction = true;
+    } else if (isCommand(encoded, exec) || isCommand(encoded, discard)) {
+        kind = CloseTransaction;
+    }
+    m_commands.append(Command{callback, cbData, sentAt, dealloc, m_buffer.size(), encoded.size(), kind});
+    if (callback) {
+        ++m_callbacks;
+    }
+    m_buffer.append(encoded);
+}
+
+int Pipeline::count() const
+{
+    return m_commands.size();
+}
+
+int Pipeline::callbacks() const
+{
+    return m_callbacks;
+}
+
+bool Pipeline::isEmpty() const
+{
+    return m_commands.isEmpty();
+}
+
+bool Pipeline::hasTransaction() const
+{
+    return m_transaction;
+}
+
+Pipeline::Result Pipeline::send(const Sender &sender, bool canSend, qint64 sentAt)
+{
+    Result result;
+    bool inTransaction = false;
+    for (const auto &queued : qAsConst(m_commands)) {
+        auto status = REDIS_ERR;
+        if (canSend) {
+            if (queued.sentAt) {
+                *queued.sentAt = sentAt;
+            }
+            status = sender(queued.callback, queued.cbData, QByteArrayView(m_buffer).sliced(queued.offset, queued.size));
+        }
+        if (status == REDIS_OK) {
+            ++result.sent;
+            if (queued.kind != Plain) {
+                inTransaction = queued.kind == Multi;
+            }
+            continue;
+        }
+        if (queued.dealloc) {
+            queued.dealloc(queued.cbData);
+        }
+        // Rest is not sent: EXEC must not follow a lost command of its transaction
+        canSend = false;
+        result.status = REDIS_ERR;
+    }
+    if (inTransaction) {
+        // Otherwise every later command of connection would be just QUEUED
+        const static CommandArgs discard{"DISCARD"};
+        result.transactionOpen = sender(nullptr, nullptr, discard.encoded()) != REDIS_OK;
+    }
+    clear();
+    return result;
+}
+
+void Pipeline::clear()
+{
+    m_commands.clear();
+    m_buffer.resize(0);
+    m_callbacks = 0;
+    m_transaction = false;
+}
@@ -0,0 +1,64 @@
+#ifndef REDIS_PIPELINE_H
+#define REDIS_PIPELINE_H
+
+#include "lib/hiredis/async.h"
+#include "formatting/redis/rediscommandargs.h"
+#include <functional>
+
+namespace Redis {
+
+//! Commands encoded into one buffer, handed to hiredis together (hiredis then sends them in a single write).
+//! Sending stops at first command that fails, so commands are sent as a prefix of the pipeline
+class RADAPTER_API Pipeline
+{
+public:
+    //! Hands one encoded command to connection. \return REDIS_OK if it was queued for write
+    using Sender = std::function<int(redisCallbackFn *callback, void *cbData, QByteArrayView encoded)>;
+    struct Result {
+        int status{REDIS_OK};
+        //! Commands handed to sender (their callbacks own their data)
+        int sent{0};
+        //! MULTI was sent, but neither EXEC nor DISCARD could follow it: connection must be dropped
+        bool transactionOpen{false};
+    };
+    //! \param sentAt stamped right before command is sent (may be nullptr)
+    //! \param dealloc frees cbData of command, that was not sent (may be nullptr)
+    void append(redisCallbackFn *callback, void *cbData, qint64 *sentAt, void (*dealloc)(void*), const CommandArgs &command);
+    int count() const;
+    //! Commands with callbacks (they take in-flight window slots)
+    int callbacks() const;
+    bool isEmpty() const;
+    //! Has MULTI
+    bool hasTransaction() const;
+    //! Sends commands in order, then clears pipeline. Callbacks (and data) of commands that were not sent are never called.
+    //! Transaction cut by a failed command is closed with DISCARD, so its commands, that were sent, are not executed
+    //! \param canSend false --> nothing is sent (everything is deallocated)
+    Result send(const Sender &sender, bool canSend, qint64 sentAt);
+    //! Drops commands without sending them
+    void clear();
+private:
+    enum Kind : quint8 {
+        Plain = 0,
+        Multi,
+        //! EXEC or DISCARD
+        CloseTransaction
+    };
+    struct Command {
+        redisCallbackFn *callback;
+        void *cbData;
+        qint64 *sentAt;
+        void (*dealloc)(void*);
+        qsizetype offset;
+        qsizetype size;
+        Kind kind;
+    };
+
+    QVector<Command> m_commands;
+    QByteArray m_buffer;
+    int m_callbacks{0};
+    bool m_transaction{false};
+};
+
+} // namespace Redis
+
+#endif // REDIS_PIPELINE_H
@@ -0,0 +1,58 @@
+#include "redispubsub.h"
+
+#define KEYSPACE_PREFIX "__keyspace@"
+#define KEYEVENT_PREFIX "__keyevent@"
+#define NOTIFICATION_SEPARATOR "__:"
+
+namespace Redis {
+
+static QString toString(const redisReply *reply)
+{
+    return reply && reply->str ? QString::fromUtf8(reply->str, qsizetype(reply->len)) : QString{};
+}
+
+PubSubMessage PubSubMessage::parse(const redisReply *frame)
+{
+    PubSubMessage result;
+    if (!frame || (frame->type != REDIS_REPLY_ARRAY && frame->type != REDIS_REPLY_PUSH) || frame->elements < 3) {
+        return result;
+    }
+    const auto kind = frame->element[0];
+    if (kind->type != REDIS_REPLY_STRING) {
+        return result;
+    }
+    const auto name = QByteArrayView(kind->str, qsizetype(kind->len));
+    if (name == QByteArrayView("message")) {
+        result.channel = toString(frame->element[1]);
+        result.payload = frame->element[2];
+    } else if (name == QByteArrayView("pmessage") && frame->elements >= 4) {
+        result.pattern = toString(frame->element[1]);
+        result.channel = toString(frame->element[2]);
+        result.payload = frame->element[3];
+    }
+    return result;
+}
+
+bool PubSubMessage::isValid() const
+{
+    return payload;
+}
+
+KeyEvent::KeyEvent(const QString &channel, const QString &payload) :
+    key(channel),
+    event(payload)
+{
+    const auto separator = channel.indexOf(QLatin1String(NOTIFICATION_SEPARATOR));
+    if (separator <= 0) {
+        return;
+    }
+    const auto name = channel.mid(separator + int(qstrlen(NOTIFICATION_SEPARATOR)));
+    if (channel.startsWith(QLatin1String(KEYSPACE_PREFIX))) {
+        key = name;
+    } else if (channel.startsWith(QLatin1String(KEYEVENT_PREFIX))) {
+        key = payload;
+        event = name;
+    }
+}
+
+} // namespace Redis
@@ -0,0 +1,35 @@
+#ifndef REDIS_PUBSUB_H
+#define REDIS_PUBSUB_H
+
+#include "private/global.h"
+#include "lib/hiredis/hiredis.h"
+#include <QString>
+
+namespace Redis {
+
+//! message <channel> <payload> | pmessage <pattern> <channel> <payload>.
+//! Same layout comes as RESP2 array and as RESP3 push
+struct RADAPTER_API PubSubMessage {
+    //! (P)SUBSCRIBE confirmations and other frames --> invalid
+    static PubSubMessage parse(const redisReply *frame);
+    bool isValid() const;
+
+    //! Empty for plain message
+    QString pattern;
+    QString channel;
+    //! Element of frame (valid while frame is)
+    redisReply *payload{nullptr};
+};
+
+//! Keyspace notification, normalized to key + event
+struct RADAPTER_API KeyEvent {
+    //! __keyspace@<db>__:<key> -> event; __keyevent@<db>__:<event> -> key; other channels: channel -> payload
+    KeyEvent(const QString &channel, const QString &payload);
+
+    QString key;
+    QString event;
+};
+
+} // namespace Redis
+
+#endif // REDIS_PUBSUB_H
@@ -0,0 +1,95 @@
+#include "redisrouting.h"
+#include <algorithm>
+
+#define CLUSTER_SLOTS 16384
+
+using namespace Redis;
+
+quint32 Redis::routingHash(QByteArrayView key)
+{
+    quint32 hash = 2166136261u;
+    for (auto ch : key) {
+        hash ^= quint8(ch);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+quint16 Redis::clusterSlot(QByteArrayView key)
+{
+    auto open = std::find(key.begin(), key.end(), '{');
+    if (open != key.end()) {
+        auto close = std::find(open + 1, key.end(), '}');
+        if (close != key.end() && close != open + 1) {
+            key = QByteArrayView(open + 1, close);
+        }
+    }
+    quint16 crc = 0;
+    for (auto ch : key) {
+        crc ^= quint16(quint8(ch)) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 0x8000 ? quint16((crc << 1) ^ 0x1021) : quint16(crc << 1);
+        }
+    }
+    return crc % CLUSTER_SLOTS;
+}
+
+ShardRing::ShardRing(const QStringList &shards, int virtualNodes)
+{
+    if (shards.size() < 2) {
+        return;
+    }
+    for (int shard = 0; shard < shards.size(); ++shard) {
+        for (int node = 0; node < virtualNodes; ++node) {
+            auto point = QStringLiteral("%1#%2").arg(shards[shard], QString::number(node)).toUtf8();
+            m_points.append({routingHash(point), shard});
+        }
+    }
+    std::sort(m_points.begin(), m_points.end());
+}
+
+bool ShardRing::isEmpty() const
+{
+    return m_points.isEmpty();
+}
+
+int ShardRing::shardFor(quint32 hash) const
+{
+    if (m_points.isEmpty()) {
+        return 0;
+    }
+    auto point = std::lower_bound(m_points.cbegin(), m_points.cend(), hash, [](const QPair<quint32, int> &point, quint32 hash){
+        return point.first < hash;
+    });
+    return point == m_points.cend() ? m_points.constFirst().second : point->second;
+}
+
+ClusterRedirect ClusterRedirect::parse(const redisReply *reply)
+{
+    ClusterRedirect result;
+    if (!reply || reply->type != REDIS_REPLY_ERROR || !reply->str) {
+        return result;
+    }
+    const auto parts = QByteArray(reply->str, qsizetype(reply->len)).split(' ');
+    const bool moved = parts.constFirst() == "MOVED";
+    if (parts.size() < 3 || (!moved && parts.constFirst() != "ASK")) {
+        return result;
+    }
+    bool ok = false;
+    const auto slot = parts[1].toInt(&ok);
+    const auto portSep = parts[2].lastIndexOf(':');
+    const auto port = parts[2].mid(portSep + 1).toUShort();
+    if (!ok || slot < 0 || slot >= CLUSTER_SLOTS || portSep < 0 || !port) {
+        return result;
+    }
+    result.ask = !moved;
+    result.slot = slot;
+    result.host = QString::fromUtf8(parts[2].left(portSep));
+    result.port = port;
+    return result;
+}
+
+bool ClusterRedirect::isValid() const
+{
+    return port != 0;
+}
@@ -0,0 +1,46 @@
+#ifndef REDIS_ROUTING_H
+#define REDIS_ROUTING_H
+
+#include "private/global.h"
+#include "lib/hiredis/hiredis.h"
+#include <QByteArrayView>
+#include <QStringList>
+#include <QVector>
+
+namespace Redis {
+
+//! FNV-1a: stable between runs and processes, unlike qHash()
+RADAPTER_API quint32 routingHash(QByteArrayView key);
+//! CRC16-CCITT (XMODEM) of key or of its {hash tag}, as in Redis Cluster spec
+RADAPTER_API quint16 clusterSlot(QByteArrayView key);
+
+//! Consistent hash ring of shards: keys of a removed shard are spread over the rest, others stay in place
+class RADAPTER_API ShardRing
+{
+public:
+    ShardRing() = default;
+    //! \param virtualNodes points of every shard on ring (more --> more even spread)
+    ShardRing(const QStringList &shards, int virtualNodes);
+    bool isEmpty() const;
+    //! \return index of shard in list, given to constructor (0 if ring is empty)
+    int shardFor(quint32 hash) const;
+private:
+    QVector<QPair<quint32, int>> m_points;
+};
+
+//! "MOVED|ASK <slot> <host>:<port>" error reply of cluster node
+struct RADAPTER_API ClusterRedirect {
+    //! Not a redirect --> invalid
+    static ClusterRedirect parse(const redisReply *reply);
+    bool isValid() const;
+
+    bool ask{false};
+    int slot{-1};
+    //! Empty --> same host as the node, that replied
+    QString host;
+    quint16 port{0};
+};
+
+} // namespace Redis
+
+#endif // REDIS_ROUTING_H
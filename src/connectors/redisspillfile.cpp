@@ -0,0 +1,136 @@
+#include "redisspillfile.h"
+#include <QtEndian>
+#include "radapterlogging.h"
+
+#define SPILL_HEADER_SIZE   8
+#define SPILL_RECORD_HEADER 10
+
+using namespace Redis;
+
+SpillFile::SpillFile(const QString &path, qint64 maxBytes) :
+    m_file(path),
+    m_maxBytes(maxBytes)
+{
+}
+
+bool SpillFile::open()
+{
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        reError() << "Spill file: could not open" << m_file.fileName() << ":" << m_file.errorString();
+        return false;
+    }
+    m_head = SPILL_HEADER_SIZE;
+    m_count = 0;
+    if (m_file.size() >= SPILL_HEADER_SIZE) {
+        char head[SPILL_HEADER_SIZE];
+        m_file.read(head, SPILL_HEADER_SIZE);
+        m_head = qMax<qint64>(SPILL_HEADER_SIZE, qFromLittleEndian<qint64>(head));
+    }
+    // Count valid records, first broken one and everything after it is dropped
+    m_tail = m_head;
+    m_file.seek(m_head);
+    while (true) {
+        char header[SPILL_RECORD_HEADER];
+        if (m_file.read(header, SPILL_RECORD_HEADER) != SPILL_RECORD_HEADER) break;
+        const auto keySize = qFromLittleEndian<quint32>(header);
+        const auto commandSize = qFromLittleEndian<quint32>(header + 4);
+        const auto crc = qFromLittleEndian<quint16>(header + 8);
+        const auto body = m_file.read(qint64(keySize) + commandSize);
+        if (body.size() != qint64(keySize) + commandSize || qChecksum(body) != crc) break;
+        m_tail += SPILL_RECORD_HEADER + body.size();
+        ++m_count;
+    }
+    if (m_file.size() > m_tail) {
+        reWarn() << "Spill file: dropping torn tail of" << m_file.fileName();
+    }
+    m_file.resize(m_tail);
+    return writeHead();
+}
+
+QString SpillFile::path() const
+{
+    return m_file.fileName();
+}
+
+bool SpillFile::isEmpty() const
+{
+    return !m_count;
+}
+
+int SpillFile::count() const
+{
+    return m_count;
+}
+
+qint64 SpillFile::bytes() const
+{
+    return m_tail - m_head;
+}
+
+bool SpillFile::append(QByteArrayView routingKey, QByteArrayView command)
+{
+    const auto recordSize = SPILL_RECORD_HEADER + routingKey.size() + command.size();
+    if (!m_file.isOpen() || m_tail + recordSize > m_maxBytes) {
+        return false;
+    }
+    QByteArray record;
+    record.reserve(recordSize);
+    record.resize(SPILL_RECORD_HEADER);
+    record.append(routingKey.data(), routingKey.size());
+    record.append(command.data(), command.size());
+    qToLittleEndian<quint32>(quint32(routingKey.size()), record.data());
+    qToLittleEndian<quint32>(quint32(command.size()), record.data() + 4);
+    qToLittleEndian<quint16>(qChecksum(QByteArrayView(record).sliced(SPILL_RECORD_HEADER)), record.data() + 8);
+    if (!m_file.seek(m_tail) || m_file.write(record) != record.size() || !m_file.flush()) {
+        reError() << "Spill file: write error:" << m_file.errorString();
+        m_file.resize(m_tail);
+        return false;
+    }
+    m_tail += record.size();
+    ++m_count;
+    return true;
+}
+
+qint64 SpillFile::peek(int maxCount, QVector<Record> &target)
+{
+    target.clear();
+    auto offset = m_head;
+    if (!m_file.seek(offset)) {
+        return offset;
+    }
+    while (target.size() < maxCount && offset < m_tail) {
+        char header[SPILL_RECORD_HEADER];
+        if (m_file.read(header, SPILL_RECORD_HEADER) != SPILL_RECORD_HEADER) break;
+        const auto keySize = qFromLittleEndian<quint32>(header);
+        const auto commandSize = qFromLittleEndian<quint32>(header + 4);
+        Record record{m_file.read(keySize), m_file.read(commandSize)};
+        if (record.key.size() != qint64(keySize) || record.command.size() != qint64(commandSize)) break;
+        offset += SPILL_RECORD_HEADER + keySize + commandSize;
+        target.append(std::move(record));
+    }
+    return offset;
+}
+
+void SpillFile::commit(qint64 offset, int count)
+{
+    m_head = qMin(offset, m_tail);
+    m_count = qMax(0, m_count - count);
+    if (!m_count || m_head == m_tail) {
+        // Everything replayed: start over, so file does not grow forever
+        m_count = 0;
+        m_head = m_tail = SPILL_HEADER_SIZE;
+        m_file.resize(m_tail);
+    }
+    writeHead();
+}
+
+bool SpillFile::writeHead()
+{
+    char head[SPILL_HEADER_SIZE];
+    qToLittleEndian<qint64>(m_head, head);
+    if (!m_file.seek(0) || m_file.write(head, SPILL_HEADER_SIZE) != SPILL_HEADER_SIZE || !m_file.flush()) {
+        reError() << "Spill file: could not update head:" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
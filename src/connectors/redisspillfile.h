@@ -0,0 +1,46 @@
+#ifndef REDIS_SPILLFILE_H
+#define REDIS_SPILLFILE_H
+
+#include "private/global.h"
+#include <QFile>
+#include <QByteArrayView>
+#include <QVector>
+
+namespace Redis {
+
+//! Append-only file of encoded commands, kept while redis is unreachable.
+//! Layout: [head offset: 8][record]..., record: [key size: 4][command size: 4][crc16: 2][key][command].
+//! Head is moved forward only when replayed commands are confirmed, file is truncated once all are replayed.
+//! Torn tail after crash is dropped on open()
+class RADAPTER_API SpillFile
+{
+public:
+    SpillFile(const QString &path, qint64 maxBytes);
+    bool open();
+    QString path() const;
+    bool isEmpty() const;
+    int count() const;
+    qint64 bytes() const;
+    //! \return false if file is full or not writable
+    bool append(QByteArrayView routingKey, QByteArrayView command);
+    struct Record {
+        QByteArray key;
+        QByteArray command;
+    };
+    //! Reads up to maxCount records from head, without removing them
+    //! \return offset after the last one (pass it to commit())
+    qint64 peek(int maxCount, QVector<Record> &target);
+    void commit(qint64 offset, int count);
+private:
+    bool writeHead();
+
+    QFile m_file;
+    qint64 m_maxBytes;
+    qint64 m_head{0};
+    qint64 m_tail{0};
+    int m_count{0};
+};
+
+} // namespace Redis
+
+#endif // REDIS_SPILLFILE_H
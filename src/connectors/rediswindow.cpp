@@ -0,0 +1,64 @@
+#include "rediswindow.h"
+
+using namespace Redis;
+
+Window::Window(int maxInFlight) :
+    m_maxInFlight(maxInFlight)
+{
+}
+
+int Window::maxInFlight() const
+{
+    return m_maxInFlight;
+}
+
+int Window::inFlight() const
+{
+    return m_inFlight;
+}
+
+quint64 Window::rejected() const
+{
+    return m_rejected;
+}
+
+bool Window::isBackpressured() const
+{
+    return m_backpressure;
+}
+
+bool Window::isFull(int toSend) const
+{
+    return m_maxInFlight && m_inFlight && m_inFlight + toSend > m_maxInFlight;
+}
+
+bool Window::admit(int toSend, int commands)
+{
+    if (!isFull(toSend)) {
+        return true;
+    }
+    m_rejected += quint64(commands);
+    return false;
+}
+
+bool Window::start()
+{
+    ++m_inFlight;
+    if (m_maxInFlight && !m_backpressure && m_inFlight >= m_maxInFlight) {
+        m_backpressure = true;
+        return true;
+    }
+    return false;
+}
+
+bool Window::finish()
+{
+    if (m_inFlight > 0) {
+        --m_inFlight;
+    }
+    if (m_backpressure && m_inFlight <= m_maxInFlight / 2) {
+        m_backpressure = false;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef REDIS_WINDOW_H
+#define REDIS_WINDOW_H
+
+#include "private/global.h"
+#include <atomic>
+
+namespace Redis {
+
+//! max_in_flight window: commands with callbacks, that were sent and not yet replied (0 --> unlimited).
+//! Full window turns backpressure on, it is turned off once window drains to half
+class RADAPTER_API Window
+{
+public:
+    explicit Window(int maxInFlight = 0);
+    int maxInFlight() const;
+    int inFlight() const;
+    //! Commands, refused by admit()
+    quint64 rejected() const;
+    bool isBackpressured() const;
+    //! Pure check. Batch larger than whole window still goes through, once window is empty
+    //! \param toSend commands with callbacks, that are about to be sent
+    bool isFull(int toSend = 1) const;
+    //! Same check, for commands that are being sent: if refused, they are counted as rejected
+    //! \param commands all commands, that are refused with them
+    bool admit(int toSend = 1, int commands = 1);
+    //! \return true if backpressure was turned on
+    bool start();
+    //! \return true if backpressure was turned off
+    bool finish();
+private:
+    std::atomic<int> m_inFlight{0};
+    std::atomic<quint64> m_rejected{0};
+    int m_maxInFlight;
+    bool m_backpressure{false};
+};
+
+} // namespace Redis
+
+#endif // REDIS_WINDOW_H
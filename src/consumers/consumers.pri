@@ -1,10 +1,12 @@
 SOURCES+= \
    $$PWD/rediscacheconsumer.cpp \
+   $$PWD/redisclientcache.cpp \
    $$PWD/rediskeyeventsconsumer.cpp \
    $$PWD/redisstreamconsumer.cpp \
    $$PWD/sqlkeyvaultconsumer.cpp
 HEADERS+= \
    $$PWD/rediscacheconsumer.h \
+   $$PWD/redisclientcache.h \
    $$PWD/rediskeyeventsconsumer.h \
    $$PWD/redisstreamconsumer.h \
    $$PWD/sqlkeyvaultconsumer.h
@@ -1,5 +1,7 @@
 #include "rediscacheconsumer.h"
+#include "redisclientcache.h"
 #include "formatting/redis/rediscachequeries.h"
+#include "formatting/redis/redishashdelta.h"
 #include "radapterlogging.h"
 #include <QTimer>
 #include "settings/redissettings.h"
@@ -15,7 +17,15 @@ struct CacheConsumer::Private {
     QString objectKey;
     Radapter::ContextManager<CacheContext> manager;
     QTimer *objectRead;
-    bool subscribed{false};
+    bool tracking{false};
+    bool incremental{false};
+    //! Incremental mode: fields changed since last HMGET was sent
+    QSet<QString> changed{};
+    bool fetchingChanged{false};
+    //! Filled only while CLIENT TRACKING is on
+    ClientCache cache{};
+    QHash<CtxHandle, QString> pendingObjects{};
+    QHash<CtxHandle, QString> pendingKeys{};
 };
 
 CacheConsumer::CacheConsumer(const Settings::RedisCacheConsumer &config, QThread *thread) :
@@ -27,13 +37,18 @@ CacheConsumer::CacheConsumer(const Settings::RedisCacheConsumer &config, QThread
             d->objectRead = new QTimer(this);
             d->objectRead->callOnTimeout(this, &CacheConsumer::requestObjectSimple);
             d->objectRead->setInterval(config.update_rate);
+        } else if (config.incremental) {
+            d->incremental = true;
+            // Whole object once per connection, then only changed fields
+            connect(this, &Connector::connected, this, &CacheConsumer::requestObjectSimple);
+            Connector::subscribe({changesChannel(d->objectKey)});
         } else {
-            connect(this, &Connector::connected, this, &CacheConsumer::subscribe);
-            connect(this, &Connector::disconnected, this, [this]{
-                d->subscribed = false;
-            });
+            Connector::subscribe({d->objectKey}, true);
         }
     }
+    if (config.client_tracking) {
+        connect(this, &Connector::connected, this, &CacheConsumer::enableTracking);
+    }
     connect(this, &Connector::disconnected, this, &CacheConsumer::onDisconnect);
 }
 
@@ -42,44 +57,131 @@ CacheConsumer::~CacheConsumer()
     delete d;
 }
 
-void CacheConsumer::subscribe()
+void CacheConsumer::onMessage(const QString &pattern, const QString &channel, redisReply *message)
+{
+    Q_UNUSED(pattern)
+    Q_UNUSED(channel)
+    if (!d->incremental) {
+        requestObjectSimple();
+        return;
+    }
+    const auto fields = toString(message).split('\n', Qt::SkipEmptyParts);
+    for (const auto &field : fields) {
+        d->changed.insert(field);
+    }
+    // Changes that come while HMGET is in flight are merged into next one
+    if (!d->fetchingChanged) {
+        requestChanged();
+    }
+}
+
+void CacheConsumer::requestChanged()
+{
+    if (d->changed.isEmpty() || !isConnected()) return;
+    auto fields = new QStringList(d->changed.values());
+    d->changed.clear();
+    auto hmget = CommandArgs{"HMGET"}.appendKey(d->objectKey);
+    for (const auto &field : qAsConst(*fields)) {
+        hmget << field;
+    }
+    if (runAsyncCommand(&CacheConsumer::readChangedCallback, hmget, fields) != REDIS_OK) {
+        workerError(this) << "Changed fields request fail";
+        delete fields;
+        return;
+    }
+    d->fetchingChanged = true;
+}
+
+void CacheConsumer::readChangedCallback(redisReply *reply, QStringList *fields)
+{
+    d->fetchingChanged = false;
+    ChangedFieldsReply changed(*fields, reply);
+    if (changed.isValid()) {
+        if (!changed.delta.isEmpty()) {
+            auto handle = d->manager.create<SimpleMsgContext>(this);
+            getCtx(handle).reply(ReplyJson(std::move(changed.delta)));
+            d->manager.clearDone();
+        }
+    } else if (reply) {
+        workerError(this) << "Changed fields read fail:" << parseReply(reply);
+    }
+    delete fields;
+    requestChanged();
+}
+
+void CacheConsumer::enableTracking()
+{
+    // Keyless --> first connection of pool, the only one with client_tracking (reads go there too)
+    runAsyncCommand(&CacheConsumer::trackingCallback, CommandArgs{"CLIENT", "TRACKING", "ON"});
+}
+
+void CacheConsumer::trackingCallback(redisReply *reply)
+{
+    d->tracking = isResp3() && parseReply(reply).toString() == "OK";
+    if (!d->tracking) {
+        workerWarn(this) << "Client tracking unavailable, cache disabled";
+    }
+}
+
+void CacheConsumer::onPush(redisReply *reply)
 {
-    if (d->subscribed) return;
-    runAsyncCommand(&CacheConsumer::onEvent, subscribeTo({d->objectKey}));
+    if (!d->cache.invalidate(reply)) {
+        Connector::onPush(reply);
+    }
 }
 
-void CacheConsumer::onEvent(redisReply *)
+void CacheConsumer::dropCache()
 {
-    requestObjectSimple();
+    d->cache.clear();
+    d->pendingObjects.clear();
+    d->pendingKeys.clear();
 }
 
 void CacheConsumer::onDisconnect()
 {
+    d->tracking = false;
+    d->changed.clear();
+    dropCache();
     d->manager.forEach(&CacheContext::fail, "Disconnected");
     d->manager.clearAll();
 }
 
 void CacheConsumer::requestObject(const QString &objectKey, CtxHandle handle)
 {
-    auto command = QStringLiteral("HGETALL ") + objectKey;
+    if (d->tracking) {
+        if (auto cached = d->cache.object(objectKey)) {
+            getCtx(handle).reply(ReplyJson(*cached));
+            return;
+        }
+        d->pendingObjects.insert(handle, objectKey);
+    }
+    auto command = CommandArgs{"HGETALL"}.appendKey(objectKey);
     if (runAsyncCommand(&CacheConsumer::readObjectCallback, command, handle) != REDIS_OK) {
+        d->pendingObjects.remove(handle);
         getCtx(handle).fail("Object request fail");
     }
 }
 
 void CacheConsumer::readObjectCallback(redisReply *reply, CtxHandle handle)
 {
-    auto result = parseHashReply(reply);
-    workerInfo(this) << ": Found object fields: " << result.count();
+    auto result = parseHashReplyNested(reply);
+    workerInfo(this) << ": Found object fields: " << result.deepCount();
     if (result.isEmpty()) {
         getCtx(handle).fail("Empty object hash!");
     }
-    getCtx(handle).reply(ReplyJson(JsonDict{result}));
+    auto tracked = d->pendingObjects.take(handle);
+    if (d->tracking && !tracked.isEmpty() && !result.isEmpty()) {
+        d->cache.setObject(tracked, result);
+    }
+    getCtx(handle).reply(ReplyJson(std::move(result)));
 }
 
 void CacheConsumer::requestKeys(const QStringList &keys, CtxHandle handle)
 {
-    auto command = QStringLiteral("MGET ") + keys.join(" ");
+    CommandArgs command{"MGET"};
+    for (const auto &key : keys) {
+        command.appendKey(key);
+    }
     if (runAsyncCommand(&CacheConsumer::readKeysCallback, command, handle) != REDIS_OK) {
         getCtx(handle).fail("MGET Error");
     }
@@ -94,8 +196,16 @@ void CacheConsumer::readKeysCallback(redisReply *reply, CtxHandle handle)
 
 void CacheConsumer::requestKey(const QString &key, CtxHandle handle)
 {
-    auto command = QStringLiteral("GET ") + key;
+    if (d->tracking) {
+        if (auto cached = d->cache.value(key)) {
+            getCtx(handle).reply(ReadKey::WantedReply(*cached));
+            return;
+        }
+        d->pendingKeys.insert(handle, key);
+    }
+    auto command = CommandArgs{"GET"}.appendKey(key);
     if (runAsyncCommand(&CacheConsumer::readKeyCallback, command, handle) != REDIS_OK) {
+        d->pendingKeys.remove(handle);
         getCtx(handle).fail("GET Error");
     }
 }
@@ -104,12 +214,16 @@ void CacheConsumer::readKeyCallback(redisReply *replyPtr, CtxHandle handle)
 {
     auto foundKey = parseReply(replyPtr).toString();
     workerInfo(this) << "Key found:" << foundKey;
+    auto tracked = d->pendingKeys.take(handle);
+    if (d->tracking && !tracked.isEmpty() && replyPtr && replyPtr->type == ReplyString) {
+        d->cache.setValue(tracked, foundKey);
+    }
     getCtx(handle).reply(ReadKey::WantedReply(foundKey));
 }
 
 void CacheConsumer::requestHash(const QString &hash, CtxHandle handle)
 {
-    auto command = QStringLiteral("HGETALL ") + hash;
+    auto command = CommandArgs{"HGETALL"}.appendKey(hash);
     if (runAsyncCommand(&CacheConsumer::readHashCallback, command, handle) != REDIS_OK) {
         getCtx(handle).fail("HGETALL Error");
     }
@@ -124,7 +238,7 @@ void CacheConsumer::readHashCallback(redisReply *replyPtr, CtxHandle handle)
 
 void CacheConsumer::requestSet(const QString &setKey, CtxHandle handle)
 {
-    auto command = QStringLiteral("SMEMBERS ") + setKey;
+    auto command = CommandArgs{"SMEMBERS"}.appendKey(setKey);
     if (runAsyncCommand(&CacheConsumer::readSetCallback, command, handle) != REDIS_OK) {
         getCtx(handle).fail("SMEMBERS Error");
     }
@@ -140,7 +254,7 @@ void CacheConsumer::readSetCallback(redisReply *replyPtr, CtxHandle handle)
 void CacheConsumer::requestObjectSimple()
 {
     if (!isConnected()) return;
-    auto command = QStringLiteral("HGETALL ") + d->objectKey;
+    auto command = CommandArgs{"HGETALL"}.appendKey(d->objectKey);
     auto handle = d->manager.create<SimpleMsgContext>(this);
     if (runAsyncCommand(&CacheConsumer::readObjectCallback, command, handle) != REDIS_OK) {
         getCtx(handle).fail("Object request fail");
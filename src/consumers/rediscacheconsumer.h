@@ -21,10 +21,13 @@ public slots:
     void onCommand(const Radapter::WorkerMsg &msg) override;
 private slots:
     void onDisconnect();
-    void subscribe();
-    void onEvent(redisReply *);
+    void enableTracking();
 private:
     void onRun() override;
+    void onPush(redisReply *reply) override;
+    void onMessage(const QString &pattern, const QString &channel, redisReply *message) override;
+    void trackingCallback(redisReply *reply);
+    void dropCache();
     CacheContext &getCtx(CtxHandle handle);
     void handleCommand(const Radapter::Command* command, CtxHandle handle);
 
@@ -34,6 +37,9 @@ private:
     void requestObjectSimple();
     void requestObject(const QString &objectKey, CtxHandle handle);
     void readObjectCallback(redisReply *replyPtr, CtxHandle handle);
+    //! Incremental mode: HMGET of fields named in change messages
+    void requestChanged();
+    void readChangedCallback(redisReply *replyPtr, QStringList *fields);
 
     void requestKeys(const QStringList &keys, CtxHandle handle);
     void readKeysCallback(redisReply *reply, CtxHandle handle);
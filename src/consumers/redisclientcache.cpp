@@ -0,0 +1,56 @@
+#include "redisclientcache.h"
+#include "lib/hiredis/hiredis.h"
+
+using namespace Redis;
+
+const JsonDict *ClientCache::object(const QString &key) const
+{
+    auto found = m_objects.constFind(key);
+    return found == m_objects.cend() ? nullptr : &*found;
+}
+
+void ClientCache::setObject(const QString &key, const JsonDict &object)
+{
+    m_objects.insert(key, object);
+}
+
+const QString *ClientCache::value(const QString &key) const
+{
+    auto found = m_values.constFind(key);
+    return found == m_values.cend() ? nullptr : &*found;
+}
+
+void ClientCache::setValue(const QString &key, const QString &value)
+{
+    m_values.insert(key, value);
+}
+
+bool ClientCache::invalidate(const redisReply *push)
+{
+    if (!push || push->elements < 2 || push->element[0]->type == REDIS_REPLY_NIL ||
+        QByteArrayView(push->element[0]->str, qsizetype(push->element[0]->len)) != QByteArrayView("invalidate")) {
+        return false;
+    }
+    auto keys = push->element[1];
+    if (keys->type != REDIS_REPLY_ARRAY) {
+        clear();
+        return true;
+    }
+    for (size_t i = 0; i < keys->elements; ++i) {
+        const auto key = QString::fromUtf8(keys->element[i]->str, qsizetype(keys->element[i]->len));
+        m_objects.remove(key);
+        m_values.remove(key);
+    }
+    return true;
+}
+
+void ClientCache::clear()
+{
+    m_objects.clear();
+    m_values.clear();
+}
+
+int ClientCache::size() const
+{
+    return m_objects.size() + m_values.size();
+}
@@ -0,0 +1,31 @@
+#ifndef REDIS_CLIENTCACHE_H
+#define REDIS_CLIENTCACHE_H
+
+#include "jsondict/jsondict.h"
+
+struct redisReply;
+
+namespace Redis {
+
+//! Client-side cache (CLIENT TRACKING): values are served locally until redis invalidates their keys.
+//! Invalidations come only to connection, that did the reads, so all of them must go through one connection
+class RADAPTER_API ClientCache
+{
+public:
+    const JsonDict *object(const QString &key) const;
+    void setObject(const QString &key, const JsonDict &object);
+    const QString *value(const QString &key) const;
+    void setValue(const QString &key, const QString &value);
+    //! RESP3 push: >2 "invalidate" [keys] | nil (flushed)
+    //! \return false if push is not an invalidation
+    bool invalidate(const redisReply *push);
+    void clear();
+    int size() const;
+private:
+    QHash<QString, JsonDict> m_objects;
+    QHash<QString, QString> m_values;
+};
+
+} // namespace Redis
+
+#endif // REDIS_CLIENTCACHE_H
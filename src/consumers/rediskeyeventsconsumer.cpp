@@ -1,34 +1,52 @@
 #include "rediskeyeventsconsumer.h"
 #include "radapterlogging.h"
+#include "connectors/redispubsub.h"
 #include "settings/redissettings.h"
+#include <QTimer>
 
 using namespace Redis;
 
 KeyEventsConsumer::KeyEventsConsumer(const Settings::RedisKeyEventSubscriber &config, QThread *thread)
     : Connector(config, thread),
-      m_keyEventNotifications(config.keyEvents)
+      m_maxBatch(qMax<int>(1, config.max_batch)),
+      m_flushTimer(new QTimer(this))
 {
-    connect(this, &KeyEventsConsumer::connected, this, &KeyEventsConsumer::subscribe);
-    connect(this, &KeyEventsConsumer::disconnected, this, &KeyEventsConsumer::unsubscribe);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(config.coalesce_ms);
+    m_flushTimer->callOnTimeout(this, &KeyEventsConsumer::flush);
+    subscribe(config.keyEvents, true);
 }
 
-void KeyEventsConsumer::readMessageCallback(redisReply *reply)
+void KeyEventsConsumer::onMessage(const QString &pattern, const QString &channel, redisReply *message)
 {
-    auto parsed = parseReply(reply);
-}
-
-void KeyEventsConsumer::subscribe()
-{
-    if (m_keyEventNotifications.isEmpty() || m_isSubscribed) {
-        return;
+    const KeyEvent keyEvent(channel, toString(message));
+    auto &events = m_batch[pattern.isEmpty() ? channel : pattern][keyEvent.key];
+    if (events.isEmpty()) {
+        ++m_batchKeys;
     }
-    if (runAsyncCommand(&KeyEventsConsumer::readMessageCallback, subscribeTo(m_keyEventNotifications)) != REDIS_OK) {
-        throw std::runtime_error("Incorrect Patterns for subscribtion: " + m_keyEventNotifications.join(", ").toStdString());
+    if (!events.contains(keyEvent.event)) {
+        events.append(keyEvent.event);
+    }
+    if (m_batchKeys >= m_maxBatch) {
+        flush();
+    } else if (!m_flushTimer->isActive()) {
+        // Window starts at first event, so latency is bounded by coalesce_ms under constant load
+        m_flushTimer->start();
     }
-    m_isSubscribed = true;
 }
 
-void KeyEventsConsumer::unsubscribe()
+void KeyEventsConsumer::flush()
 {
-    m_isSubscribed = false;
+    m_flushTimer->stop();
+    if (!m_batchKeys) return;
+    JsonDict result;
+    for (auto pattern = m_batch.cbegin(); pattern != m_batch.cend(); ++pattern) {
+        for (auto key = pattern->cbegin(); key != pattern->cend(); ++key) {
+            // Keys are not split by ':', they are sent as is
+            result.insert(QStringList{pattern.key(), key.key()}, QVariant(key.value()));
+        }
+    }
+    m_batch.clear();
+    m_batchKeys = 0;
+    emit send(result);
 }
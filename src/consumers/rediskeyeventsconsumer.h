@@ -2,7 +2,6 @@
 #define REDISKEYEVENTSCONSUMER_H
 
 #include "connectors/redisconnector.h"
-#include "formatting/redis/rediscachequeries.h"
 
 namespace Settings {
 struct RedisKeyEventSubscriber;
@@ -11,19 +10,22 @@ namespace Redis {
 class RADAPTER_API KeyEventsConsumer;
 }
 
+//! Change feed: {<pattern>: {<key>: [events]}}, events of one key are coalesced within batch
 class Redis::KeyEventsConsumer : public Connector
 {
     Q_OBJECT
 public:
     explicit KeyEventsConsumer(const Settings::RedisKeyEventSubscriber &config, QThread *thread);
 private slots:
-    void subscribe();
-    void unsubscribe();
+    void flush();
 private:
-    void readMessageCallback(redisReply *reply);
+    void onMessage(const QString &pattern, const QString &channel, redisReply *message) override;
 
-    QStringList m_keyEventNotifications;
-    bool m_isSubscribed{false};
+    //! pattern --> key --> events (in arrival order, without repeats)
+    QHash<QString, QHash<QString, QStringList>> m_batch;
+    int m_batchKeys{0};
+    int m_maxBatch;
+    QTimer *m_flushTimer;
 };
 
 #endif // REDISKEYEVENTSCONSUMER_H
@@ -18,27 +18,65 @@ StreamConsumer::StreamConsumer(const Settings::RedisStreamConsumer &config,
                                QThread *thread)
     : Connector(config, thread),
       m_streamKey(config.stream_key),
+      m_streams{config.stream_key},
       m_startMode(config.start_from),
-      m_lastStreamId{"$"}
+      m_sendBatches(config.send_batches)
 {
+    for (const auto &stream : config.extra_streams) {
+        if (!m_streams.contains(stream)) {
+            m_streams.append(stream);
+        }
+    }
     disablePingKeepalive();
     connect(this, &StreamConsumer::commandsFinished, this, &StreamConsumer::doRead);
     connect(this, &StreamConsumer::connected, this, [this](){
-        Connector::runAsyncCommand(QString("INCR readers:%1").arg(m_streamKey));
+        for (const auto &stream : qAsConst(m_streams)) {
+            Connector::runAsyncCommand(CommandArgs{"INCR"}.appendKey(QStringLiteral("readers:") + stream));
+        }
+    });
+    connect(this, &StreamConsumer::disconnected, this, [this](){
+        m_readPending = false;
     });
     connect(this, &StreamConsumer::connected, this, &StreamConsumer::doRead);
 }
 
+StreamConsumer::StreamConsumer(const Settings::RedisStreamGroupConsumer &config,
+                               QThread *thread)
+    : StreamConsumer(static_cast<const Settings::RedisStreamConsumer&>(config), thread)
+{
+    if (m_streams.size() > 1) {
+        throw std::runtime_error("extra_streams are not supported by group consumer: " + config.worker->name.value.toStdString());
+    }
+    m_groupMode = true;
+    m_groupFromLast = config.start_from_last_unread;
+    m_groupName = config.consumer_group_name;
+    m_consumerName = config.consumer_name->isEmpty() ? config.worker->name.value : config.consumer_name.value;
+    m_claimMinIdle = config.claim_min_idle_ms;
+    connect(this, &StreamConsumer::connected, this, &StreamConsumer::startGroup);
+    connect(this, &StreamConsumer::disconnected, this, [this](){
+        m_groupReady = false;
+    });
+}
+
 QString StreamConsumer::lastReadId() const
 {
-    auto lastId = m_lastStreamId;
+    return lastReadId(m_streamKey);
+}
+
+QString StreamConsumer::lastReadId(const QString &stream) const
+{
+    // Read in this run --> continue from it, even if its checkpoint is not saved yet
+    auto read = m_lastStreamIds.constFind(stream);
+    if (read != m_lastStreamIds.cend()) {
+        return *read;
+    }
     if (m_startMode == Settings::RedisStreamConsumer::StartPersistentId) {
-        auto fromLast = LocalStorage::instance()->getLastStreamId(m_streamKey);
-        lastId = fromLast.isEmpty() ? lastId : fromLast;
+        auto fromLast = LocalStorage::instance()->getLastStreamId(stream);
+        return fromLast.isEmpty() ? QStringLiteral("$") : fromLast;
     } else if (m_startMode == Settings::RedisStreamConsumer::StartFromFirst) {
-        lastId = "0-0";
+        return QStringLiteral("0-0");
     }
-    return lastId;
+    return QStringLiteral("$");
 }
 
 const QString &StreamConsumer::streamKey() const
@@ -46,31 +84,196 @@ const QString &StreamConsumer::streamKey() const
     return m_streamKey;
 }
 
+const QStringList &StreamConsumer::streams() const
+{
+    return m_streams;
+}
+
+bool StreamConsumer::isGroupMode() const
+{
+    return m_groupMode;
+}
+
 void StreamConsumer::doRead()
 {
-    auto startId = lastReadId();
-    auto readCommand = readStream(m_streamKey, ENTRIES_PER_READ, BLOCK_TIMEOUT_MS, startId);
-    runAsyncCommand(&StreamConsumer::readCallback, readCommand);
+    if (m_readPending) {
+        return;
+    }
+    CommandArgs readCommand;
+    if (m_groupMode) {
+        if (!m_groupReady) {
+            return;
+        }
+        readCommand = readGroup(m_streamKey, m_groupName, m_consumerName, ENTRIES_PER_READ, BLOCK_TIMEOUT_MS);
+    } else {
+        QStringList startIds;
+        for (const auto &stream : qAsConst(m_streams)) {
+            startIds.append(lastReadId(stream));
+        }
+        readCommand = readStreams(m_streams, ENTRIES_PER_READ, BLOCK_TIMEOUT_MS, startIds);
+    }
+    m_readPending = runAsyncCommand(&StreamConsumer::readCallback, readCommand) == REDIS_OK;
 }
 
-void StreamConsumer::readCallback(redisReply *reply)
+void StreamConsumer::startGroup()
 {
-    auto parsed = parseReply(reply).toList();
-    if (parsed.isEmpty()) return;
-    auto replies = parsed.first().toList().last().toList();
-    for (const auto &entry: replies) {
-        auto parsedEntry = StreamEntry(entry.toList());
-        emit send(parsedEntry.values);
-        setLastReadId(parsedEntry.streamId());
+    m_groupReady = false;
+    auto command = createGroup(m_streamKey, m_groupName, m_groupFromLast ? "$" : "0");
+    runAsyncCommand(&StreamConsumer::createGroupCallback, command);
+}
+
+void StreamConsumer::createGroupCallback(redisReply *reply)
+{
+    if (reply && reply->type == ReplyError && !QByteArray(reply->str).startsWith("BUSYGROUP")) {
+        workerError(this) << "Could not create group:" << m_groupName << "; Reason:" << reply->str;
     }
+    m_claimCursor = "0-0";
+    doClaim();
 }
 
-void StreamConsumer::setLastReadId(const QString &lastId)
+void StreamConsumer::doClaim()
 {
-    if (m_startMode == Settings::RedisStreamConsumer::StartPersistentId) {
-        LocalStorage::instance()->setLastStreamId(m_streamKey, lastId);
+    auto command = autoClaim(m_streamKey, m_groupName, m_consumerName, m_claimMinIdle, m_claimCursor, ENTRIES_PER_READ);
+    m_claimStart = m_claimCursor;
+    m_claimClock.start();
+    runAsyncCommand(&StreamConsumer::claimCallback, command);
+}
+
+void StreamConsumer::claimCallback(redisReply *reply)
+{
+    AutoClaimReply claimed(reply);
+    if (!claimed.isValid()) {
+        parseReply(reply);
+        workerWarn(this) << "Could not claim pending entries (XAUTOCLAIM needs redis 6.2+)";
+        m_groupReady = true;
+        return;
+    }
+    deliver(m_streamKey, claimed.entries, nullptr);
+    ackDeleted(claimed.deletedIds);
+    m_claimCursor = claimed.cursor;
+    if (!claimed.unknownDeleted) {
+        continueClaim();
+        return;
+    }
+    // Redis 6.2: ids of deleted ones are not returned. They are now pending on this consumer,
+    // idle since this claim (older own pending entries are idle for longer)
+    m_claimedIds = claimed.claimedIds;
+    const auto end = m_claimCursor == "0-0" ? QStringLiteral("+") : "(" + m_claimCursor;
+    auto command = pendingOf(m_streamKey, m_groupName, m_consumerName, m_claimStart, end, ENTRIES_PER_READ * 2);
+    if (runAsyncCommand(&StreamConsumer::pendingCallback, command) != REDIS_OK) {
+        continueClaim();
+    }
+}
+
+void StreamConsumer::pendingCallback(redisReply *reply)
+{
+    if (reply && reply->type == ReplyArray) {
+        ackDeleted(recentlyClaimed(reply, m_claimClock.elapsed(), m_claimedIds));
     } else {
-        m_lastStreamId = lastId;
+        parseReply(reply);
+    }
+    m_claimedIds.clear();
+    continueClaim();
+}
+
+void StreamConsumer::continueClaim()
+{
+    if (m_claimCursor == "0-0") {
+        m_groupReady = true;
+    } else {
+        doClaim();
+    }
+}
+
+void StreamConsumer::ackDeleted(const QStringList &ids)
+{
+    if (ids.isEmpty()) {
+        return;
+    }
+    workerWarn(this) << "Acking" << ids.size() << "pending entries, deleted from stream:" << m_streamKey;
+    runAsyncCommand(&StreamConsumer::ackCallback, ackEntries(m_streamKey, m_groupName, ids));
+}
+
+void StreamConsumer::readCallback(redisReply *reply)
+{
+    m_readPending = false;
+    ReadStreamsReply read(reply);
+    if (!read.isValid()) {
+        parseReply(reply);
+        return;
+    }
+    if (!m_groupMode) {
+        for (const auto &stream : qAsConst(read.streams)) {
+            if (!stream.lastId.isEmpty()) {
+                m_lastStreamIds.insert(stream.key, stream.lastId);
+            }
+        }
+    }
+    // Read-ahead: next read is already in flight (from ids above), while this batch is dispatched
+    doRead();
+    JsonDict batch;
+    for (const auto &stream : qAsConst(read.streams)) {
+        deliver(stream.key, stream.entries, m_sendBatches ? &batch : nullptr);
+    }
+    if (!batch.isEmpty()) {
+        emit send(batch);
+    }
+    // Checkpoint moves only once batch is delivered: entries, lost by a crash before that, are read again on restart
+    if (!m_groupMode) {
+        for (const auto &stream : qAsConst(read.streams)) {
+            if (!stream.lastId.isEmpty()) {
+                saveCheckpoint(stream.key, stream.lastId);
+            }
+        }
     }
 }
 
+void StreamConsumer::deliver(const QString &stream, const redisReply *entries, JsonDict *batch)
+{
+    if (entries->type != ReplyArray || !entries->elements) {
+        return;
+    }
+    CommandArgs ack;
+    if (m_groupMode) {
+        ack << "XACK";
+        ack.appendKey(stream) << m_groupName;
+    }
+    QVariantList collected;
+    bool delivered = false;
+    for (size_t i = 0; i < entries->elements; ++i) {
+        auto parsedEntry = StreamEntry(entries->element[i]);
+        if (!parsedEntry.isValid()) {
+            // entry was deleted, while pending
+            continue;
+        }
+        if (batch) {
+            collected.append(parsedEntry.values.toVariant());
+        } else {
+            emit send(parsedEntry.values);
+        }
+        delivered = true;
+        if (m_groupMode) {
+            auto id = entries->element[i]->element[0];
+            ack.append(id->str, qsizetype(id->len));
+        }
+    }
+    if (batch && !collected.isEmpty()) {
+        // Stream keys are not split by ':'
+        batch->insert(QStringList{stream}, QVariant(collected));
+    }
+    if (m_groupMode && delivered) {
+        runAsyncCommand(&StreamConsumer::ackCallback, ack);
+    }
+}
+
+void StreamConsumer::ackCallback(redisReply *reply)
+{
+    parseReply(reply);
+}
+
+void StreamConsumer::saveCheckpoint(const QString &stream, const QString &lastId)
+{
+    if (m_startMode == Settings::RedisStreamConsumer::StartPersistentId) {
+        LocalStorage::instance()->setLastStreamId(stream, lastId);
+    }
+}
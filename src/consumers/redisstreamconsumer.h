@@ -3,6 +3,7 @@
 
 #include "connectors/redisconnector.h"
 #include "settings/redissettings.h"
+#include <QElapsedTimer>
 
 namespace Redis{
 
@@ -11,18 +12,51 @@ class RADAPTER_API StreamConsumer : public Connector
     Q_OBJECT
 public:
     explicit StreamConsumer(const Settings::RedisStreamConsumer &config, QThread *thread);
+    //! Consumer group mode: XREADGROUP, batched XACK, XAUTOCLAIM of stale entries on connect.
+    //! Entries are acked once handed to broker, not when receivers handled them: delivery is at-most-once
+    explicit StreamConsumer(const Settings::RedisStreamGroupConsumer &config, QThread *thread);
     QString lastReadId() const;
+    QString lastReadId(const QString &stream) const;
     const QString &streamKey() const;
+    //! stream_key + extra_streams
+    const QStringList &streams() const;
+    bool isGroupMode() const;
 private slots:
     void doRead();
+    void startGroup();
 private:
+    void doClaim();
     void readCallback(redisReply *replyPtr);
+    void createGroupCallback(redisReply *replyPtr);
+    void claimCallback(redisReply *replyPtr);
+    void pendingCallback(redisReply *replyPtr);
+    void continueClaim();
+    //! Deleted while pending: otherwise they stay in PEL and are claimed again on every start
+    void ackDeleted(const QStringList &ids);
+    void ackCallback(redisReply *replyPtr);
+    //! batch != nullptr --> entries are collected into it instead of being sent one by one
+    void deliver(const QString &stream, const redisReply *entries, JsonDict *batch);
     int toCommandTimeout(int timeoutMsecs) const;
-    void setLastReadId(const QString &lastId);
+    //! StartPersistentId: saves position of delivered entries
+    void saveCheckpoint(const QString &stream, const QString &lastId);
 
     QString m_streamKey;
+    QStringList m_streams;
     Settings::RedisStreamConsumer::StartMode m_startMode;
-    QString m_lastStreamId;
+    //! Read in this run (reads continue from them, see saveCheckpoint())
+    QHash<QString, QString> m_lastStreamIds;
+    bool m_sendBatches{false};
+    bool m_readPending{false};
+    bool m_groupMode{false};
+    bool m_groupReady{false};
+    bool m_groupFromLast{true};
+    QString m_groupName;
+    QString m_consumerName;
+    quint32 m_claimMinIdle{0};
+    QString m_claimCursor;
+    QString m_claimStart;
+    QSet<QString> m_claimedIds;
+    QElapsedTimer m_claimClock;
 };
 
 }
@@ -10,10 +10,12 @@ NamespaceFilter::NamespaceFilter(const QString& targetNamespace) :
 
 void NamespaceFilter::onMsgFromWorker(WorkerMsg &msg)
 {
-    auto copy = msg;
-    copy.clearJson();
-    if (msg.contains(m_namespace)) {
-        copy[m_namespace] = msg[m_namespace];
+    // msg is shared with other pipes: read through const to not detach it
+    const auto &source = std::as_const(msg);
+    if (source.contains(m_namespace)) {
+        auto copy = msg;
+        copy.clearJson();
+        copy[m_namespace] = source[m_namespace];
         emit msgFromWorker(copy);
     }
 }
@@ -50,9 +50,10 @@ void ProducerFilter::filterStrictByName(Radapter::WorkerMsg &srcMsg)
         emit msgFromWorker(srcMsg);
     }
     bool shouldAdd = false;
-    for (auto &item : srcMsg) {
-        auto currentValue = item.value();
-        auto lastValue = d->last[item.key()];
+    const auto &last = std::as_const(d->last);
+    for (auto &item : std::as_const(srcMsg)) {
+        const auto &currentValue = item.value();
+        auto lastValue = last[item.key()];
         auto currentKey = item.key().join(":");
         if (!d->all_fields.contains(currentKey)) {
             shouldAdd = true;
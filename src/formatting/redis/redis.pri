@@ -1,8 +1,12 @@
 SOURCES+= \
    $$PWD/rediscachequeries.cpp \
+   $$PWD/rediscommandargs.cpp \
+   $$PWD/redishashdelta.cpp \
    $$PWD/redisstreamentry.cpp \
    $$PWD/redisstreamqueries.cpp
 HEADERS+= \
    $$PWD/rediscachequeries.h \
+   $$PWD/rediscommandargs.h \
+   $$PWD/redishashdelta.h \
    $$PWD/redisstreamentry.h \
    $$PWD/redisstreamqueries.h
@@ -2,21 +2,34 @@
 #include "jsondict/jsondict.h"
 #include <QStringList>
 
-QString Redis::subscribeTo(const QStringList &events)
+QString Redis::changesChannel(const QString &hash)
 {
-    return QStringLiteral("PSUBSCRIBE ") + events.join(' ');
+    return hash + QStringLiteral(":changes");
 }
 
-QString Redis::toMultipleSet(const JsonDict &data)
+Redis::CommandArgs Redis::toMultipleSet(const JsonDict &data)
 {
-    QStringList keys;
-    for (auto &iter : data) {
-        keys.append(iter.key().join(':') + iter.value().toString());
+    CommandArgs result{"MSET"};
+    data.visit([&](QStringView key, const QVariant &value) {
+        result.appendKey(key) << value;
+    });
+    return result;
+}
+
+Redis::CommandArgs Redis::toUpdateSet(const QString &set, const QStringList &keys)
+{
+    auto result = CommandArgs{"SADD"}.appendKey(set);
+    for (const auto &key : keys) {
+        result << key;
     }
-    return QStringLiteral("MSET ") + keys.join(' ');
+    return result;
 }
 
-QString Redis::toUpdateSet(const QString &set, const QStringList &keys)
+Redis::CommandArgs Redis::toHashSet(const QString &hash, const JsonDict &data)
 {
-    return QStringLiteral("SADD %1 %2").arg(set, keys.join(' '));
+    auto result = CommandArgs{"HMSET"}.appendKey(hash);
+    data.visit([&](QStringView key, const QVariant &value) {
+        result << key << value;
+    });
+    return result;
 }
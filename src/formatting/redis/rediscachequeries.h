@@ -2,14 +2,17 @@
 #define REDIS_CACHE_QUIERIES
 
 #include "private/global.h"
+#include "rediscommandargs.h"
 
 class JsonDict;
 
 namespace Redis {
 
-QString subscribeTo(const QStringList &events);
-QString toMultipleSet(const JsonDict &data);
-QString toUpdateSet(const QString &set, const QStringList &keys);
+CommandArgs toMultipleSet(const JsonDict &data);
+CommandArgs toUpdateSet(const QString &set, const QStringList &keys);
+CommandArgs toHashSet(const QString &hash, const JsonDict &data);
+//! Channel with names of changed hash fields ('\n'-separated), published by delta writes
+QString changesChannel(const QString &hash);
 
 }
 
@@ -0,0 +1,192 @@
+#include "rediscommandargs.h"
+#include <charconv>
+#include <cstring>
+
+#define HEADER_RESERVE  16
+
+using namespace Redis;
+
+CommandArgs::CommandArgs(int reserveBytes) :
+    m_buffer(HEADER_RESERVE, '\0')
+{
+    m_buffer.reserve(HEADER_RESERVE + reserveBytes);
+}
+
+CommandArgs::CommandArgs(std::initializer_list<QByteArrayView> args) :
+    CommandArgs()
+{
+    for (const auto &arg : args) {
+        append(arg);
+    }
+}
+
+CommandArgs CommandArgs::fromString(const QString &command)
+{
+    CommandArgs result(command.size() + 16);
+    for (const auto &part : command.split(' ', Qt::SkipEmptyParts)) {
+        if (result.count() == 1) {
+            result.appendKey(part);
+        } else {
+            result.append(part);
+        }
+    }
+    return result;
+}
+
+CommandArgs &CommandArgs::append(const char *data, qsizetype size)
+{
+    char lenBuff[24];
+    lenBuff[0] = '$';
+    auto lenEnd = std::to_chars(lenBuff + 1, lenBuff + sizeof(lenBuff) - 2, size).ptr;
+    *lenEnd++ = '\r';
+    *lenEnd++ = '\n';
+    const auto lenSize = lenEnd - lenBuff;
+    const auto was = m_buffer.size();
+    m_buffer.resize(was + lenSize + size + 2);
+    auto out = m_buffer.data() + was;
+    std::memcpy(out, lenBuff, lenSize);
+    if (size) {
+        std::memcpy(out + lenSize, data, size);
+    }
+    out[lenSize + size] = '\r';
+    out[lenSize + size + 1] = '\n';
+    ++m_count;
+    return *this;
+}
+
+CommandArgs &CommandArgs::append(QByteArrayView arg)
+{
+    return append(arg.data(), arg.size());
+}
+
+CommandArgs &CommandArgs::append(const QByteArray &arg)
+{
+    return append(arg.constData(), arg.size());
+}
+
+CommandArgs &CommandArgs::append(const QString &arg)
+{
+    return append(arg.toUtf8());
+}
+
+CommandArgs &CommandArgs::append(QStringView arg)
+{
+    char buff[128];
+    if (arg.size() > qsizetype(sizeof(buff))) {
+        return append(arg.toUtf8());
+    }
+    for (qsizetype i = 0; i < arg.size(); ++i) {
+        const auto ch = arg[i].unicode();
+        if (ch >= 0x80) {
+            return append(arg.toUtf8());
+        }
+        buff[i] = char(ch);
+    }
+    return append(buff, arg.size());
+}
+
+CommandArgs &CommandArgs::append(QLatin1String arg)
+{
+    return append(arg.data(), arg.size());
+}
+
+CommandArgs &CommandArgs::append(const char *arg)
+{
+    return append(arg, qsizetype(std::strlen(arg)));
+}
+
+CommandArgs &CommandArgs::append(const QVariant &arg)
+{
+    switch (arg.typeId()) {
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return appendInteger(arg.toLongLong());
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        return appendInteger(qint64(arg.toULongLong()));
+    case QMetaType::QByteArray:
+        return append(*reinterpret_cast<const QByteArray*>(arg.constData()));
+    case QMetaType::QString:
+        return append(*reinterpret_cast<const QString*>(arg.constData()));
+    default:
+        return append(arg.toString());
+    }
+}
+
+CommandArgs &CommandArgs::appendInteger(qint64 arg)
+{
+    char buff[24];
+    auto end = std::to_chars(buff, buff + sizeof(buff), arg).ptr;
+    return append(buff, end - buff);
+}
+
+int CommandArgs::count() const
+{
+    return m_count;
+}
+
+bool CommandArgs::isEmpty() const
+{
+    return !m_count;
+}
+
+void CommandArgs::clear()
+{
+    m_buffer.resize(HEADER_RESERVE);
+    m_count = 0;
+    m_keyOffset = -1;
+    m_keySize = 0;
+}
+
+void CommandArgs::reserve(int bytes)
+{
+    m_buffer.reserve(HEADER_RESERVE + bytes);
+}
+
+void CommandArgs::markKey(qsizetype argStart)
+{
+    // argStart points to "$<len>\r\n<data>\r\n"
+    const auto begin = m_buffer.constData() + argStart;
+    auto lenEnd = std::from_chars(begin + 1, m_buffer.constData() + m_buffer.size(), m_keySize).ptr;
+    m_keyOffset = (lenEnd + 2) - m_buffer.constData();
+}
+
+QByteArrayView CommandArgs::routingKey() const
+{
+    if (m_keyOffset < 0) {
+        return {};
+    }
+    return QByteArrayView(m_buffer.constData() + m_keyOffset, m_keySize);
+}
+
+QByteArrayView CommandArgs::encoded() const
+{
+    char header[HEADER_RESERVE];
+    header[0] = '*';
+    auto end = std::to_chars(header + 1, header + HEADER_RESERVE - 2, m_count).ptr;
+    *end++ = '\r';
+    *end++ = '\n';
+    const auto headerSize = end - header;
+    const auto headerStart = HEADER_RESERVE - headerSize;
+    std::memcpy(m_buffer.data() + headerStart, header, headerSize);
+    return QByteArrayView(m_buffer.constData() + headerStart, m_buffer.size() - headerStart);
+}
+
+QString CommandArgs::print() const
+{
+    QStringList result;
+    auto current = m_buffer.constData() + HEADER_RESERVE;
+    const auto end = m_buffer.constData() + m_buffer.size();
+    while (current < end) {
+        qsizetype size{};
+        auto lenEnd = std::from_chars(current + 1, end, size).ptr;
+        current = lenEnd + 2;
+        result.append(QString::fromUtf8(current, size));
+        current += size + 2;
+    }
+    return result.join(' ');
+}
@@ -0,0 +1,71 @@
+#ifndef REDIS_COMMANDARGS_H
+#define REDIS_COMMANDARGS_H
+
+#include "private/global.h"
+#include <QByteArrayView>
+
+namespace Redis {
+
+//! Binary-safe command builder. Arguments are encoded as RESP bulk strings
+//! straight into one buffer, which is kept (with its capacity) between clear() calls.
+//! Front of the buffer is reserved for the "*<argc>\r\n" header, so encoded() does not copy.
+class RADAPTER_API CommandArgs
+{
+public:
+    explicit CommandArgs(int reserveBytes = 128);
+    CommandArgs(std::initializer_list<QByteArrayView> args);
+    //! Splits by whitespace (legacy plain-text commands), second word is taken as routing key.
+    //! Prefer append() for user data
+    static CommandArgs fromString(const QString &command);
+
+    CommandArgs &append(const char *data, qsizetype size);
+    CommandArgs &append(QByteArrayView arg);
+    CommandArgs &append(const QByteArray &arg);
+    CommandArgs &append(const QString &arg);
+    //! ASCII is written straight into buffer, other text goes through toUtf8()
+    CommandArgs &append(QStringView arg);
+    CommandArgs &append(QLatin1String arg);
+    CommandArgs &append(const char *arg);
+    CommandArgs &append(const QVariant &arg);
+    template <typename Int>
+    std::enable_if_t<std::is_integral_v<Int> && !std::is_same_v<Int, bool>, CommandArgs&>
+    append(Int arg) {
+        return appendInteger(static_cast<qint64>(arg));
+    }
+    template <typename T>
+    CommandArgs &operator<<(const T &arg) {
+        return append(arg);
+    }
+    //! Appends argument and marks it as routing key (first marked key wins).
+    //! Connector picks connection/shard by it, so commands on same key keep their order
+    template <typename T>
+    CommandArgs &appendKey(const T &arg) {
+        const auto was = m_buffer.size();
+        append(arg);
+        if (m_keyOffset < 0) markKey(was);
+        return *this;
+    }
+    //! Empty if no key was marked
+    QByteArrayView routingKey() const;
+
+    int count() const;
+    bool isEmpty() const;
+    //! Resets arguments, but keeps allocated buffer for reuse
+    void clear();
+    void reserve(int bytes);
+    //! Full RESP encoding of command (valid until next modification)
+    QByteArrayView encoded() const;
+    QString print() const;
+private:
+    CommandArgs &appendInteger(qint64 arg);
+    void markKey(qsizetype argStart);
+
+    mutable QByteArray m_buffer;
+    int m_count{0};
+    qsizetype m_keyOffset{-1};
+    qsizetype m_keySize{0};
+};
+
+} // namespace Redis
+
+#endif // REDIS_COMMANDARGS_H
@@ -0,0 +1,79 @@
+#include "redishashdelta.h"
+#include "lib/hiredis/hiredis.h"
+
+namespace Redis {
+
+HashDelta::HashDelta(const FlatJson &target, const FlatJson &shadow, bool replace) :
+    changed(target.diff(shadow))
+{
+    if (!replace) {
+        return;
+    }
+    for (const auto &entry : shadow) {
+        if (!target.contains(entry.key)) {
+            removed.append(entry.key);
+        }
+    }
+}
+
+bool HashDelta::isEmpty() const
+{
+    return changed.isEmpty() && removed.isEmpty();
+}
+
+QStringList HashDelta::fieldNames() const
+{
+    QStringList names;
+    names.reserve(changed.size() + removed.size());
+    for (const auto &entry : changed) {
+        names.append(JsonKeys::joined(entry.key));
+    }
+    for (auto id : removed) {
+        names.append(JsonKeys::joined(id));
+    }
+    return names;
+}
+
+QVarLengthArray<CommandArgs, 2> HashDelta::commands(const QString &hash) const
+{
+    QVarLengthArray<CommandArgs, 2> result;
+    if (!changed.isEmpty()) {
+        auto &hset = result.emplace_back(CommandArgs{"HSET"}.appendKey(hash));
+        for (const auto &entry : changed) {
+            hset << JsonKeys::joined(entry.key) << entry.value;
+        }
+    }
+    if (!removed.isEmpty()) {
+        auto &hdel = result.emplace_back(CommandArgs{"HDEL"}.appendKey(hash));
+        for (auto id : removed) {
+            hdel << JsonKeys::joined(id);
+        }
+    }
+    return result;
+}
+
+ChangedFieldsReply::ChangedFieldsReply(const QStringList &fields, const redisReply *source)
+{
+    if (!source || source->type != REDIS_REPLY_ARRAY || source->elements != size_t(fields.size())) {
+        return;
+    }
+    for (size_t i = 0; i < source->elements; ++i) {
+        const auto value = source->element[i];
+        if (value->type == REDIS_REPLY_NIL) {
+            delta.insert(fields.at(int(i)), QVariant::fromValue(nullptr));
+        } else if (value->type == REDIS_REPLY_STRING) {
+            delta.insert(fields.at(int(i)), QString::fromUtf8(value->str, qsizetype(value->len)));
+        } else {
+            delta.clear();
+            return;
+        }
+    }
+    m_valid = true;
+}
+
+bool ChangedFieldsReply::isValid() const
+{
+    return m_valid;
+}
+
+} // namespace Redis
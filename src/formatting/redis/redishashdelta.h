@@ -0,0 +1,40 @@
+#ifndef REDIS_HASHDELTA_H
+#define REDIS_HASHDELTA_H
+
+#include "private/global.h"
+#include "rediscommandargs.h"
+#include "jsondict/flatjson.h"
+#include <QVarLengthArray>
+
+struct redisReply;
+
+namespace Redis {
+
+//! Write, that brings hash from its last written state (shadow) to target
+struct RADAPTER_API HashDelta {
+    //! \param replace Fields of shadow, missing in target, are deleted. Otherwise target is merged into hash
+    HashDelta(const FlatJson &target, const FlatJson &shadow, bool replace);
+    bool isEmpty() const;
+    //! Written, then deleted field names (joined by ':')
+    QStringList fieldNames() const;
+    //! HSET of changed fields, then HDEL of removed ones. Empty parts are skipped
+    QVarLengthArray<CommandArgs, 2> commands(const QString &hash) const;
+
+    FlatJson changed;
+    QList<JsonKeys::Id> removed;
+};
+
+//! HMGET reply of fields, named in changes channel
+struct RADAPTER_API ChangedFieldsReply {
+    ChangedFieldsReply(const QStringList &fields, const redisReply *source);
+    bool isValid() const;
+
+    //! Fields nested by ':'. Deleted ones (nil) are null, so receivers drop them too
+    JsonDict delta;
+private:
+    bool m_valid{false};
+};
+
+} // namespace Redis
+
+#endif // REDIS_HASHDELTA_H
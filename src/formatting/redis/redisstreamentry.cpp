@@ -1,4 +1,6 @@
 #include "redisstreamentry.h"
+#include "lib/hiredis/hiredis.h"
+#include <charconv>
 
 namespace Redis {
 
@@ -10,10 +12,136 @@ StreamEntry::StreamEntry(const QVariantList &source) {
     for (auto i = 1; i <= asList.size(); i+=2) {
         values.insert(asList[i - 1].toString(), asList[i].toString());
     }
+    m_valid = true;
+}
+
+StreamEntry::StreamEntry(const redisReply *source)
+{
+    if (!source || source->type != REDIS_REPLY_ARRAY || source->elements < 2) {
+        return;
+    }
+    auto streamId = source->element[0];
+    auto fields = source->element[1];
+    if (streamId->type != REDIS_REPLY_STRING || fields->type != REDIS_REPLY_ARRAY) {
+        return;
+    }
+    const auto idEnd = streamId->str + streamId->len;
+    auto parsed = std::from_chars(streamId->str, idEnd, timestamp);
+    if (parsed.ec != std::errc() || parsed.ptr == idEnd || *parsed.ptr != '-') {
+        return;
+    }
+    if (std::from_chars(parsed.ptr + 1, idEnd, id).ec != std::errc()) {
+        return;
+    }
+    for (size_t i = 1; i < fields->elements; i += 2) {
+        auto field = fields->element[i - 1];
+        auto value = fields->element[i];
+        values.insert(QString::fromUtf8(field->str, qsizetype(field->len)),
+                      QVariant(QString::fromUtf8(value->str, qsizetype(value->len))));
+    }
+    m_valid = true;
+}
+
+bool StreamEntry::isValid() const
+{
+    return m_valid;
 }
 
 QString StreamEntry::streamId() const {
     return QString::number(timestamp) + "-" + QString::number(id);
 }
 
+static QString toString(const redisReply *reply)
+{
+    return reply && reply->str ? QString::fromUtf8(reply->str, qsizetype(reply->len)) : QString{};
+}
+
+static bool isNil(const redisReply *reply)
+{
+    return !reply || reply->type == REDIS_REPLY_NIL;
+}
+
+AutoClaimReply::AutoClaimReply(const redisReply *source)
+{
+    if (!source || source->type != REDIS_REPLY_ARRAY || source->elements < 2 ||
+        source->element[1]->type != REDIS_REPLY_ARRAY) {
+        return;
+    }
+    cursor = toString(source->element[0]);
+    entries = source->element[1];
+    for (size_t i = 0; i < entries->elements; ++i) {
+        auto entry = entries->element[i];
+        if (isNil(entry)) {
+            ++unknownDeleted;
+        } else if (entry->type == REDIS_REPLY_ARRAY && entry->elements >= 2 && isNil(entry->element[1])) {
+            deletedIds.append(toString(entry->element[0]));
+        } else if (entry->type == REDIS_REPLY_ARRAY && entry->elements) {
+            claimedIds.insert(toString(entry->element[0]));
+        }
+    }
+    if (source->elements >= 3 && source->element[2]->type == REDIS_REPLY_ARRAY) {
+        auto deleted = source->element[2];
+        for (size_t i = 0; i < deleted->elements; ++i) {
+            deletedIds.append(toString(deleted->element[i]));
+        }
+    }
+    m_valid = true;
+}
+
+bool AutoClaimReply::isValid() const
+{
+    return m_valid;
+}
+
+ReadStreamsReply::ReadStreamsReply(const redisReply *source)
+{
+    if (!source) {
+        return;
+    }
+    auto append = [this](const redisReply *key, const redisReply *entries) {
+        Stream stream{toString(key), entries, {}};
+        auto last = entries->type == REDIS_REPLY_ARRAY && entries->elements ? entries->element[entries->elements - 1] : nullptr;
+        if (last && last->type == REDIS_REPLY_ARRAY && last->elements) {
+            stream.lastId = toString(last->element[0]);
+        }
+        streams.append(stream);
+    };
+    if (source->type == REDIS_REPLY_MAP) {
+        for (size_t i = 1; i < source->elements; i += 2) {
+            append(source->element[i - 1], source->element[i]);
+        }
+    } else if (source->type == REDIS_REPLY_ARRAY) {
+        for (size_t i = 0; i < source->elements; ++i) {
+            auto stream = source->element[i];
+            if (stream->type == REDIS_REPLY_ARRAY && stream->elements >= 2) {
+                append(stream->element[0], stream->element[1]);
+            }
+        }
+    }
+}
+
+bool ReadStreamsReply::isValid() const
+{
+    return !streams.isEmpty();
+}
+
+QStringList recentlyClaimed(const redisReply *pending, qint64 maxIdleMs, const QSet<QString> &except)
+{
+    QStringList result;
+    if (!pending || pending->type != REDIS_REPLY_ARRAY) {
+        return result;
+    }
+    for (size_t i = 0; i < pending->elements; ++i) {
+        auto entry = pending->element[i];
+        if (entry->type != REDIS_REPLY_ARRAY || entry->elements < 3 || entry->element[2]->type != REDIS_REPLY_INTEGER) {
+            continue;
+        }
+        auto id = toString(entry->element[0]);
+        if (entry->element[2]->integer <= maxIdleMs && !except.contains(id)) {
+            result.append(id);
+        }
+    }
+    return result;
+}
+
 } // namespace Redis
@@ -2,19 +2,67 @@
 #define REDIS_STREAMENTRY_H
 
 #include "private/global.h"
+#include "jsondict/jsondict.h"
+#include <QSet>
+#include <QVector>
 
+struct redisReply;
 
 namespace Redis {
 
 struct StreamEntry {
-    quint64 timestamp;
-    quint64 id;
-    QVariantMap values;
+    quint64 timestamp{};
+    quint64 id{};
+    JsonDict values;
 
     StreamEntry(const QVariantList &source);
+    //! Decodes [id, [field, value, ...]] reply in place. Fields are nested by ':'
+    explicit StreamEntry(const redisReply *source);
+    bool isValid() const;
     QString streamId() const;
+private:
+    bool m_valid{false};
 };
 
+//! XAUTOCLAIM reply: [next cursor, [entries], [deleted ids] (redis 7+)]
+struct AutoClaimReply {
+    explicit AutoClaimReply(const redisReply *source);
+    bool isValid() const;
+
+    QString cursor;
+    //! [[id, fields], ...] as is (see StreamEntry), not valid ones are skipped on delivery
+    const redisReply *entries{nullptr};
+    //! Claimed entries, that are still in stream
+    QSet<QString> claimedIds;
+    //! Pending entries, that were deleted from stream: listed apart by redis 7+, or returned as [id, nil]
+    QStringList deletedIds;
+    //! Redis 6.2 returns deleted entries as bare nil, without id
+    int unknownDeleted{0};
+private:
+    bool m_valid{false};
+};
+
+//! XREAD(GROUP) reply: [[stream, entries], ...] (RESP2) or {stream: entries, ...} (RESP3)
+struct ReadStreamsReply {
+    struct Stream {
+        QString key;
+        //! [[id, fields], ...] as is (see StreamEntry)
+        const redisReply *entries{nullptr};
+        //! Id of last entry (deleted ones too), empty if there are none
+        QString lastId;
+    };
+    explicit ReadStreamsReply(const redisReply *source);
+    //! Has any stream (nil, timeout of blocking read, is not valid)
+    bool isValid() const;
+
+    QVector<Stream> streams;
+};
+
+//! Extended XPENDING reply: [[id, consumer, idle ms, deliveries], ...]
+//! 
+eturn ids, that were idle for at most maxIdleMs (claimed since then), except known ones
+QStringList recentlyClaimed(const redisReply *pending, qint64 maxIdleMs, const QSet<QString> &except);
+
 
 } // namespace Redis
 
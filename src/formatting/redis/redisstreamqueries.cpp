@@ -2,38 +2,83 @@
 #include "jsondict/jsondict.h"
 #include <QStringList>
 
-QString Redis::addToStream(const QString &stream, const JsonDict &data, quint32 size)
+Redis::CommandArgs Redis::addToStream(const QString &stream, const JsonDict &data, quint32 size)
 {
-    QString fields;
-    fields.reserve(150);
-    for (const auto &iter : data) {
-        fields.append(" ").append(iter.key().join(':')).append(" ").append(iter.value().toString());
+    CommandArgs result(256);
+    addToStream(result, stream, data, size);
+    return result;
+}
+
+void Redis::addToStream(CommandArgs &target, const QString &stream, const JsonDict &data, quint32 size)
+{
+    target.clear();
+    target << "XADD";
+    target.appendKey(stream);
+    if (size) {
+        target << "MAXLEN" << "~" << size;
+    }
+    target << "*";
+    const auto headerCount = target.count();
+    data.visit([&](QStringView key, const QVariant &value) {
+        target << key << value;
+    });
+    if (target.count() == headerCount) {
+        target.clear();
     }
-    return QStringLiteral("XADD %1 MAXLEN ~ %2 * %3").arg(stream).arg(size).arg(fields);
 }
 
-QString Redis::trimStream(const QString &stream, quint32 maxLen)
+Redis::CommandArgs Redis::trimStream(const QString &stream, quint32 maxLen)
 {
-    return QStringLiteral("XTRIM %1 MAXLEN ~ %2").arg(stream).arg(maxLen);
+    return CommandArgs{"XTRIM"}.appendKey(stream) << "MAXLEN" << "~" << maxLen;
 }
 
-QString Redis::readStream(const QString &stream, const qint32 count, const qint32 blockTimeout, const QString &lastId)
+Redis::CommandArgs Redis::readStream(const QString &stream, const qint32 count, const qint32 blockTimeout, const QString &lastId)
 {
-    return QStringLiteral("XREAD COUNT %1 BLOCK %2 STREAMS %3 %4").arg(count).arg(blockTimeout).arg(stream, lastId);
+    auto result = CommandArgs{"XREAD", "COUNT"} << count << "BLOCK" << blockTimeout << "STREAMS";
+    result.appendKey(stream) << lastId;
+    return result;
 }
 
-QString Redis::readGroup(const QString &stream, const QString &groupName, const QString &consumerName, qint32 blockTimeout, const QString &id)
+Redis::CommandArgs Redis::readStreams(const QStringList &streams, qint32 count, qint32 blockTimeout, const QStringList &lastIds)
 {
-    return QStringLiteral("XREADGROUP GROUP %1 %2 BLOCK %3 STREAMS %4 %5").arg(groupName, consumerName).arg(blockTimeout).arg(stream, id);
+    auto result = CommandArgs{"XREAD", "COUNT"} << count << "BLOCK" << blockTimeout << "STREAMS";
+    for (const auto &stream : streams) {
+        result.appendKey(stream);
+    }
+    for (const auto &id : lastIds) {
+        result << id;
+    }
+    return result;
 }
 
-QString Redis::ackEntries(const QString &streamKey, const QString &groupName, const QStringList &idList)
+Redis::CommandArgs Redis::readGroup(const QString &stream, const QString &groupName, const QString &consumerName, qint32 count, qint32 blockTimeout, const QString &id)
 {
-    return QString("XACK %1 %2 %3").arg(streamKey, groupName, idList.join(" "));
+    auto result = CommandArgs{"XREADGROUP", "GROUP"} << groupName << consumerName << "COUNT" << count
+                                                     << "BLOCK" << blockTimeout << "STREAMS";
+    result.appendKey(stream) << id;
+    return result;
 }
 
-QString Redis::createGroup(const QString &streamKey, const QString &groupName, const QString &startId)
+Redis::CommandArgs Redis::ackEntries(const QString &streamKey, const QString &groupName, const QStringList &idList)
 {
-    return QStringLiteral("XGROUP CREATE %1 %2 %3 MKSTREAM").arg(streamKey, groupName, startId);
+    auto result = CommandArgs{"XACK"}.appendKey(streamKey) << groupName;
+    for (const auto &id : idList) {
+        result << id;
+    }
+    return result;
 }
 
+Redis::CommandArgs Redis::createGroup(const QString &streamKey, const QString &groupName, const QString &startId)
+{
+    return CommandArgs{"XGROUP", "CREATE"}.appendKey(streamKey) << groupName << startId << "MKSTREAM";
+}
+
+Redis::CommandArgs Redis::autoClaim(const QString &streamKey, const QString &groupName, const QString &consumerName, quint32 minIdleMs, const QString &startId, qint32 count)
+{
+    return CommandArgs{"XAUTOCLAIM"}.appendKey(streamKey) << groupName << consumerName << minIdleMs << startId << "COUNT" << count;
+}
+
+Redis::CommandArgs Redis::pendingOf(const QString &streamKey, const QString &groupName, const QString &consumerName, const QString &start, const QString &end, qint32 count)
+{
+    return CommandArgs{"XPENDING"}.appendKey(streamKey) << groupName << start << end << count << consumerName;
+}
@@ -2,17 +2,25 @@
 #define REDIS_STREAM_QUIERIES
 
 #include "private/global.h"
+#include "rediscommandargs.h"
 
 class JsonDict;
 
 namespace Redis {
 
-QString addToStream(const QString &stream, const JsonDict &data, quint32 size = 0u);
-QString trimStream(const QString &stream, quint32 maxLen);
-QString readStream(const QString &stream, const qint32 count, const qint32 blockTimeout, const QString &lastId);
-QString readGroup(const QString &stream, const QString &groupName, const QString &consumerName, qint32 blockTimeout, const QString &id);
-QString ackEntries(const QString &streamKey, const QString &groupName, const QStringList &idList);
-QString createGroup(const QString &streamKey, const QString &groupName, const QString &startId);
+CommandArgs addToStream(const QString &stream, const JsonDict &data, quint32 size = 0u);
+//! Fills reusable target (cleared first). Leaves it empty if data has no fields
+void addToStream(CommandArgs &target, const QString &stream, const JsonDict &data, quint32 size = 0u);
+CommandArgs trimStream(const QString &stream, quint32 maxLen);
+CommandArgs readStream(const QString &stream, const qint32 count, const qint32 blockTimeout, const QString &lastId);
+//! One XREAD for all streams, lastIds go in same order. First stream is the routing key
+CommandArgs readStreams(const QStringList &streams, qint32 count, qint32 blockTimeout, const QStringList &lastIds);
+CommandArgs readGroup(const QString &stream, const QString &groupName, const QString &consumerName, qint32 count, qint32 blockTimeout, const QString &id = ">");
+CommandArgs ackEntries(const QString &streamKey, const QString &groupName, const QStringList &idList);
+CommandArgs createGroup(const QString &streamKey, const QString &groupName, const QString &startId);
+//! Extended form: pending entries of consumer in [start, end] (exclusive bounds start with '(')
+CommandArgs pendingOf(const QString &streamKey, const QString &groupName, const QString &consumerName, const QString &start, const QString &end, qint32 count);
+CommandArgs autoClaim(const QString &streamKey, const QString &groupName, const QString &consumerName, quint32 minIdleMs, const QString &startId, qint32 count);
 
 }
 
@@ -4,6 +4,9 @@
 #include "consumers/rediscacheconsumer.h"
 #include "producers/rediscacheproducer.h"
 #include "commands/rediscommands.h"
+#include "modbus/modbusmaster.h"
+#include "settings/modbussettings.h"
+#include "sync/channel.h"
 #include "launcher.h"
 #include "radapterconfig.h"
 #include <QHttpServer>
@@ -40,6 +43,7 @@ ApiServer::ApiServer(const Settings::RadapterApi &settings, QThread *thread, Lau
     });
     configEndpoints();
     redisEndpoints();
+    modbusEndpoints();
 }
 
 ApiServer::~ApiServer()
@@ -74,6 +78,13 @@ void ApiServer::configEndpoints()
 
 void ApiServer::redisEndpoints()
 {
+    d->server->route("/redis/stats", Method::Get, [this]() {
+        JsonDict result;
+        for (auto worker : broker()->getAll(&Redis::Connector::staticMetaObject)) {
+            result.top().insert(worker->workerName(), static_cast<Redis::Connector*>(worker)->stats());
+        }
+        return result.toBytes(d->settings.json_format);
+    });
     d->server->route("/redis/cache/object/<arg>", Method::Get, [this](const QString &objName, const QHttpServerRequest &request) {
         auto workerName = request.query().queryItemValue("worker");
         auto executor = broker()->getWorker(workerName)->as<Redis::CacheConsumer>();
@@ -100,3 +111,19 @@ void ApiServer::redisEndpoints()
     });
 
 }
+
+void ApiServer::modbusEndpoints()
+{
+    // Masters on same device share one channel (bus)
+    d->server->route("/modbus/stats", Method::Get, [this]() {
+        JsonDict result;
+        for (auto worker : broker()->getAll(&Modbus::Master::staticMetaObject)) {
+            const auto &device = static_cast<Modbus::Master*>(worker)->config().m_device;
+            const auto busName = device.tcp->port ? device.tcp->name : device.rtu->name;
+            if (!result.top().contains(busName)) {
+                result.top().insert(busName, device.channel->stats());
+            }
+        }
+        return result.toBytes(d->settings.json_format);
+    });
+}
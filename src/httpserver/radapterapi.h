@@ -21,6 +21,7 @@ private:
     void serviceEndpoints();
     void configEndpoints();
     void redisEndpoints();
+    void modbusEndpoints();
 
     Private *d;
 };
@@ -18,7 +18,7 @@ void DuplicatingInterceptor::onMsgFromWorker(WorkerMsg &msg)
 {
     for (auto iter = m_settings->_by_field.cbegin(); iter != m_settings->_by_field.cend(); ++iter) {
         auto key = iter.key().split(':');
-        msg[iter.value()] = msg[key];
+        msg[iter.value()] = std::as_const(msg)[key];
     }
     emit msgFromWorker(msg);
 }
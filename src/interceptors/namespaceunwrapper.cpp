@@ -26,7 +26,7 @@ NamespaceUnwrapper::~NamespaceUnwrapper()
 
 void NamespaceUnwrapper::onMsgFromWorker(WorkerMsg &msg)
 {
-    msg.json() = JsonDict(msg.json()[d->settings.unwrap_from], false);
+    msg.json() = JsonDict(std::as_const(msg).json()[d->settings.unwrap_from], false);
     if (!msg.isEmpty()) {
         emit msgFromWorker(msg);
     }
@@ -27,8 +27,9 @@ Radapter::Interceptor *ValidatingInterceptor::newCopy() const
 
 void ValidatingInterceptor::onMsgFromWorker(WorkerMsg &msg)
 {
-    validate(msg);
-    msg.json() = msg.sanitized();
+    if (validate(msg)) {
+        msg.json() = msg.sanitized();
+    }
     if (!msg.isEmpty()) {
         emit msgFromWorker(msg);
     }
@@ -68,9 +69,22 @@ void ValidatingInterceptor::checkKeyVal(const QStringList &key, QVariant& val)
     }
 }
 
-void ValidatingInterceptor::validate(WorkerMsg &msg)
+bool ValidatingInterceptor::validate(WorkerMsg &msg)
 {
-    for (auto &[key, val]: msg.json()) {
-        checkKeyVal(key, val);
+    // Scan shared msg read-only, then detach only paths to invalid values
+    QList<QStringList> invalid;
+    bool hadInvalid = false;
+    for (auto &iter: std::as_const(msg).json()) {
+        auto val = iter.value();
+        checkKeyVal(iter.key(), val);
+        if (!iter.value().isValid()) {
+            hadInvalid = true;
+        } else if (!val.isValid()) {
+            invalid.append(iter.key());
+        }
+    }
+    for (const auto &key: invalid) {
+        msg[key].clear();
     }
+    return hadInvalid || !invalid.isEmpty();
 }
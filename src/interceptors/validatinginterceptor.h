@@ -19,7 +19,8 @@ public:
 public slots:
     virtual void onMsgFromWorker(Radapter::WorkerMsg &msg) override;
 private:
-    void validate(WorkerMsg &msg);
+    //! \return msg has invalid values (it must be sanitized)
+    bool validate(WorkerMsg &msg);
     void checkKeyVal(const QStringList &key, QVariant &val);
 
     ValidatingInterceptorPrivate *d;
@@ -0,0 +1,191 @@
+#include "flatjson.h"
+#include <QReadWriteLock>
+#include <deque>
+
+namespace {
+struct KeysTable {
+    struct Key {
+        QString joined;
+        QStringList path;
+    };
+    QReadWriteLock lock;
+    QHash<QString, JsonKeys::Id> ids;
+    std::deque<Key> keys; // references are stable on push_back
+};
+}
+
+Q_GLOBAL_STATIC(KeysTable, keysTable)
+
+JsonKeys::Id JsonKeys::intern(const QStringList &path)
+{
+    return intern(path.join(':'));
+}
+
+JsonKeys::Id JsonKeys::intern(const QString &joined, QChar separator)
+{
+    auto normalized = separator == ':' ? joined : QString(joined).replace(separator, ':');
+    {
+        QReadLocker lock(&keysTable->lock);
+        auto found = keysTable->ids.constFind(normalized);
+        if (found != keysTable->ids.cend()) {
+            return *found;
+        }
+    }
+    QWriteLocker lock(&keysTable->lock);
+    auto found = keysTable->ids.constFind(normalized);
+    if (found != keysTable->ids.cend()) {
+        return *found;
+    }
+    auto id = Id(keysTable->keys.size());
+    keysTable->keys.push_back({normalized, normalized.split(':')});
+    keysTable->ids.insert(normalized, id);
+    return id;
+}
+
+const QStringList &JsonKeys::path(Id id)
+{
+    QReadLocker lock(&keysTable->lock);
+    return keysTable->keys.at(id).path;
+}
+
+const QString &JsonKeys::joined(Id id)
+{
+    QReadLocker lock(&keysTable->lock);
+    return keysTable->keys.at(id).joined;
+}
+
+FlatJson::FlatJson(const JsonDict &nested)
+{
+    for (auto &iter : nested) {
+        insert(JsonKeys::intern(iter.key()), iter.value());
+    }
+}
+
+JsonDict FlatJson::toJson() const
+{
+    JsonDict result;
+    for (const auto &entry : m_entries) {
+        result.insert(entry.path(), entry.value);
+    }
+    return result;
+}
+
+void FlatJson::reserve(int size)
+{
+    m_entries.reserve(size);
+}
+
+QVector<FlatJson::Entry>::iterator FlatJson::lowerBound(Id key)
+{
+    return std::lower_bound(m_entries.begin(), m_entries.end(), key, [](const Entry &entry, Id key){
+        return entry.key < key;
+    });
+}
+
+QVector<FlatJson::Entry>::const_iterator FlatJson::lowerBound(Id key) const
+{
+    return std::lower_bound(m_entries.cbegin(), m_entries.cend(), key, [](const Entry &entry, Id key){
+        return entry.key < key;
+    });
+}
+
+void FlatJson::insert(Id key, const QVariant &value)
+{
+    insert(key, QVariant(value));
+}
+
+void FlatJson::insert(Id key, QVariant &&value)
+{
+    auto pos = lowerBound(key);
+    if (pos != m_entries.end() && pos->key == key) {
+        pos->value = std::move(value);
+    } else {
+        m_entries.insert(pos, Entry{key, std::move(value)});
+    }
+}
+
+void FlatJson::append(Id key, QVariant &&value)
+{
+    if (!m_entries.isEmpty() && m_entries.constLast().key >= key) {
+        insert(key, std::move(value));
+    } else {
+        m_entries.append(Entry{key, std::move(value)});
+    }
+}
+
+const QVariant *FlatJson::find(Id key) const
+{
+    auto pos = lowerBound(key);
+    return pos != m_entries.cend() && pos->key == key ? &pos->value : nullptr;
+}
+
+QVariant FlatJson::value(Id key, const QVariant &adefault) const
+{
+    auto found = find(key);
+    return found ? *found : adefault;
+}
+
+bool FlatJson::contains(Id key) const
+{
+    return find(key);
+}
+
+bool FlatJson::remove(Id key)
+{
+    auto pos = lowerBound(key);
+    if (pos == m_entries.end() || pos->key != key) {
+        return false;
+    }
+    m_entries.erase(pos);
+    return true;
+}
+
+FlatJson FlatJson::diff(const FlatJson &other) const
+{
+    FlatJson result;
+    auto theirs = other.m_entries.cbegin();
+    const auto theirsEnd = other.m_entries.cend();
+    for (const auto &entry : m_entries) {
+        while (theirs != theirsEnd && theirs->key < entry.key) {
+            ++theirs;
+        }
+        if (theirs == theirsEnd || theirs->key != entry.key || theirs->value != entry.value) {
+            result.m_entries.append(entry);
+        }
+    }
+    return result;
+}
+
+FlatJson FlatJson::update(const FlatJson &src)
+{
+    auto delta = src.diff(*this);
+    for (const auto &entry : delta.m_entries) {
+        insert(entry.key, entry.value);
+    }
+    return delta;
+}
+
+void FlatJson::clear()
+{
+    m_entries.clear();
+}
+
+int FlatJson::size() const
+{
+    return m_entries.size();
+}
+
+bool FlatJson::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+FlatJson::const_iterator FlatJson::begin() const
+{
+    return m_entries.cbegin();
+}
+
+FlatJson::const_iterator FlatJson::end() const
+{
+    return m_entries.cend();
+}
@@ -0,0 +1,67 @@
+#ifndef FLAT_JSON_H
+#define FLAT_JSON_H
+
+#include "jsondict.h"
+
+//! Process-wide table of interned key paths ("domain:field" <--> id). Thread-safe, ids are never freed
+class RADAPTER_API JsonKeys
+{
+public:
+    using Id = quint32;
+    static Id intern(const QStringList &path);
+    static Id intern(const QString &joined, QChar separator = ':');
+    //! References stay valid for the whole process lifetime
+    static const QStringList &path(Id id);
+    static const QString &joined(Id id);
+};
+
+/*!
+ * \ingroup JsonDict
+ * \brief Плоское представление JsonDict: (id ключа, значение), отсортированные по id.
+ *
+ *  Для известных схем (регистры Modbus и т.д.) поиск, обход и diff не аллоцируют и не
+ *  разбивают строки ключей. В JsonDict конвертируется только на границах (toJson()).
+ */
+class RADAPTER_API FlatJson
+{
+public:
+    using Id = JsonKeys::Id;
+    struct Entry {
+        Id key;
+        QVariant value;
+        const QStringList &path() const {return JsonKeys::path(key);}
+    };
+    using const_iterator = QVector<Entry>::const_iterator;
+
+    FlatJson() = default;
+    explicit FlatJson(const JsonDict &nested);
+    [[nodiscard]] JsonDict toJson() const;
+
+    void reserve(int size);
+    void insert(Id key, const QVariant &value);
+    void insert(Id key, QVariant &&value);
+    //! Faster insert, when keys are added in ascending order (e.g. by precomputed schema)
+    void append(Id key, QVariant &&value);
+    [[nodiscard]] const QVariant *find(Id key) const;
+    [[nodiscard]] QVariant value(Id key, const QVariant &adefault = {}) const;
+    [[nodiscard]] bool contains(Id key) const;
+    bool remove(Id key);
+    //! @return Entries of this, missing or different in other
+    [[nodiscard]] FlatJson diff(const FlatJson &other) const;
+    //! @return Entries that were added/changed
+    FlatJson update(const FlatJson &src);
+    void clear();
+    [[nodiscard]] int size() const;
+    [[nodiscard]] bool isEmpty() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+private:
+    QVector<Entry>::iterator lowerBound(Id key);
+    QVector<Entry>::const_iterator lowerBound(Id key) const;
+
+    QVector<Entry> m_entries;
+};
+
+Q_DECLARE_TYPEINFO(FlatJson::Entry, Q_RELOCATABLE_TYPE);
+
+#endif // FLAT_JSON_H
@@ -4,16 +4,21 @@
 int JsonDict::deepCount() const
 {
     int count = 0;
-    for (const auto &iter: *this) {
-        Q_UNUSED(iter);
+    visit([&](QStringView, const QVariant &) {
         ++count;
-    }
+    });
     return count;
 }
 
 QStringList JsonDict::keys(const QString &separator) const
 {
     QStringList result{};
+    if (separator.size() == 1) {
+        visit([&](QStringView key, const QVariant &) {
+            result.append(key.toString());
+        }, separator.front());
+        return result;
+    }
     for (const auto &iter: *this) {
         result.append(iter.key().join(separator));
     }
@@ -46,17 +51,65 @@ bool JsonDict::contains(const QStringList &key) const
     return value(key).isValid();
 }
 
+static bool hasLeaves(const QVariant &val)
+{
+    if (val.typeId() == QMetaType::QVariantMap) {
+        for (const auto &sub: *reinterpret_cast<const QVariantMap*>(val.constData())) {
+            if (hasLeaves(sub)) return true;
+        }
+        return false;
+    } else if (val.typeId() == QMetaType::QVariantList) {
+        for (const auto &sub: *reinterpret_cast<const QVariantList*>(val.constData())) {
+            if (hasLeaves(sub)) return true;
+        }
+        return false;
+    }
+    return val.isValid();
+}
+
+// Walks both trees side by side: every leaf of src must be present and equal in target
+static bool containsLeaves(const QVariant *target, const QVariant &src)
+{
+    if (src.typeId() == QMetaType::QVariantMap) {
+        const auto &srcMap = *reinterpret_cast<const QVariantMap*>(src.constData());
+        if (!target || target->typeId() != QMetaType::QVariantMap) {
+            return !hasLeaves(src);
+        }
+        const auto &targetMap = *reinterpret_cast<const QVariantMap*>(target->constData());
+        for (auto iter = srcMap.cbegin(); iter != srcMap.cend(); ++iter) {
+            auto found = targetMap.constFind(iter.key());
+            if (!containsLeaves(found != targetMap.cend() ? &found.value() : nullptr, iter.value())) {
+                return false;
+            }
+        }
+        return true;
+    } else if (src.typeId() == QMetaType::QVariantList) {
+        const auto &srcList = *reinterpret_cast<const QVariantList*>(src.constData());
+        if (!target || target->typeId() != QMetaType::QVariantList) {
+            return !hasLeaves(src);
+        }
+        const auto &targetList = *reinterpret_cast<const QVariantList*>(target->constData());
+        for (qsizetype i = 0; i < srcList.size(); ++i) {
+            if (!containsLeaves(i < targetList.size() ? &targetList[i] : nullptr, srcList[i])) {
+                return false;
+            }
+        }
+        return true;
+    } else if (!src.isValid()) {
+        return true;
+    }
+    return target && target->isValid() && *target == src;
+}
+
 bool JsonDict::contains(const JsonDict &src) const
 {
-    for (const auto &otherItem: src)
-    {
-        auto thisItem = value(otherItem.key());
-        if (!thisItem.isValid() || (thisItem != otherItem.value())) {
+    for (auto iter = src.m_dict.cbegin(); iter != src.m_dict.cend(); ++iter) {
+        auto found = m_dict.constFind(iter.key());
+        if (!containsLeaves(found != m_dict.cend() ? &found.value() : nullptr, iter.value())) {
             return false;
         }
     }
     return true;
-
 }
 
 qint64 JsonDict::toIndex(const QString &key)
@@ -257,6 +310,12 @@ QVariant JsonDict::take(const QString &akey, const QString &separator)
 QVariantMap JsonDict::flatten(const QString &separator) const
 {
     QVariantMap result;
+    if (separator.size() == 1) {
+        visit([&](QStringView key, const QVariant &value) {
+            result.insert(key.toString(), value);
+        }, separator.front());
+        return result;
+    }
     for (const auto& iter : *this) {
         auto key = iter.key().join(separator);
         auto value = iter.value();
@@ -471,7 +530,9 @@ QVariant JsonDict::take(const QString &akey, QChar separator)
 
 bool JsonDict::isEmpty() const
 {
-    return !deepCount();
+    return visit([](QStringView, const QVariant &) {
+        return false;
+    });
 }
 
 JsonDict JsonDict::diff(const JsonDict &other, bool full) const
@@ -11,6 +11,8 @@
 #include <QJsonObject>
 #include <QList>
 #include <stdexcept>
+#include <charconv>
+#include <type_traits>
 #include "private/global.h"
 /*!
  * \defgroup JsonDict JsonDict
@@ -130,6 +132,12 @@ public:
     JsonDict::const_iterator end() const;
     JsonDict::const_iterator cbegin() const;
     JsonDict::const_iterator cend() const;
+    //! Обход листьев без выделения памяти на каждом шаге (в отличие от итераторов).
+    /// visitor(QStringView key, const QVariant &value) -> void | bool (false прерывает обход).
+    /// key - полный ключ, склеенный через separator, валиден только внутри вызова
+    /// \return false, если обход был прерван
+    template <typename Visitor>
+    bool visit(Visitor &&visitor, QChar separator = ':') const;
     QString print() const;
     friend QDebug operator<<(QDebug dbg, const JsonDict &json);
 protected:
@@ -144,8 +152,74 @@ protected:
     static QVariant *find(QVariantList *list, qint64 index);
 private:
     QString processWarn(const QStringList &src, const int& index);
+    template <typename Visitor>
+    static bool visitValue(const QVariant &value, QString &path, QChar separator, Visitor &visitor);
+    template <typename Visitor>
+    static bool visitLevel(const QVariantMap &map, QString &path, QChar separator, Visitor &visitor);
+    template <typename Visitor>
+    static bool visitLevel(const QVariantList &list, QString &path, QChar separator, Visitor &visitor);
 };
 
+template <typename Visitor>
+bool JsonDict::visit(Visitor &&visitor, QChar separator) const
+{
+    QString path;
+    path.reserve(128);
+    return visitLevel(m_dict, path, separator, visitor);
+}
+
+template <typename Visitor>
+bool JsonDict::visitValue(const QVariant &value, QString &path, QChar separator, Visitor &visitor)
+{
+    switch (value.typeId()) {
+    case QMetaType::QVariantMap:
+        return visitLevel(*reinterpret_cast<const QVariantMap*>(value.constData()), path, separator, visitor);
+    case QMetaType::QVariantList:
+        return visitLevel(*reinterpret_cast<const QVariantList*>(value.constData()), path, separator, visitor);
+    case QMetaType::UnknownType:
+        return true;
+    default:
+        if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, QStringView, const QVariant&>, bool>) {
+            return visitor(QStringView(path), value);
+        } else {
+            visitor(QStringView(path), value);
+            return true;
+        }
+    }
+}
+
+template <typename Visitor>
+bool JsonDict::visitLevel(const QVariantMap &map, QString &path, QChar separator, Visitor &visitor)
+{
+    const auto was = path.size();
+    for (auto iter = map.cbegin(); iter != map.cend(); ++iter) {
+        if (was) path.append(separator);
+        path.append(iter.key());
+        const bool proceed = visitValue(iter.value(), path, separator, visitor);
+        path.truncate(was);
+        if (!proceed) return false;
+    }
+    return true;
+}
+
+template <typename Visitor>
+bool JsonDict::visitLevel(const QVariantList &list, QString &path, QChar separator, Visitor &visitor)
+{
+    const auto was = path.size();
+    char index[24];
+    for (qsizetype i = 0; i < list.size(); ++i) {
+        if (was) path.append(separator);
+        index[0] = '[';
+        auto end = std::to_chars(index + 1, index + sizeof(index) - 1, i).ptr;
+        *end++ = ']';
+        path.append(QLatin1String(index, end - index));
+        const bool proceed = visitValue(list[i], path, separator, visitor);
+        path.truncate(was);
+        if (!proceed) return false;
+    }
+    return true;
+}
+
 struct JsonDict::const_iterator {
     using iter = QVariantMap::const_iterator;
     ~const_iterator();
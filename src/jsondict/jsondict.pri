@@ -1,4 +1,6 @@
 SOURCES+= \
+   $$PWD/flatjson.cpp \
    $$PWD/jsondict.cpp
 HEADERS+= \
+   $$PWD/flatjson.h \
    $$PWD/jsondict.h
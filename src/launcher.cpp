@@ -90,6 +90,9 @@ void Launcher::initConfig()
     for (const auto& config: d->config.redis->stream->consumers) {
         addWorker(new Redis::StreamConsumer(config, newThread()));
     }
+    for (const auto& config: d->config.redis->stream->group_consumers) {
+        addWorker(new Redis::StreamConsumer(config, newThread()));
+    }
     for (const auto& config: d->config.sockets->udp->consumers) {
         addWorker(new Udp::Consumer(config, newThread()));
     }
@@ -158,6 +161,8 @@ void Launcher::initConfig()
         addWorker(new ApiServer(d->config.api, newThread(), this));
     }
     LocalStorage::init(this);
+    LocalStorage::instance()->setCommitPolicy(d->config.local_storage->commit_interval_ms,
+                                              d->config.local_storage->compact_after);
 }
 void Launcher::parseCommandlineArgs()
 {
@@ -1,15 +1,73 @@
 #include "localstorage.h"
+#include <QSaveFile>
+#include <QTimer>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #define DEFAULT_STORAGE_NAME "localstorage.ini"
 #define DEFAULT_STORAGE_DIRECTORY "conf"
+#define CHECKPOINT_LOG_NAME "checkpoints.log"
+#define DEFAULT_COMMIT_INTERVAL_MS 1000
+#define DEFAULT_COMPACT_AFTER 10000u
 
 #define LAST_STREAM_ID "last_id"
 
+// Checkpoint log record: <percent-encoded key>\t<value>\t<crc16 hex>\n
+// Torn tail (no newline or bad crc) after crash is dropped on load
+static QByteArray toRecord(const QString &key, const QString &value)
+{
+    auto record = key.toUtf8().toPercentEncoding() + '\t' + value.toUtf8();
+    auto crc = qChecksum(record);
+    return record + '\t' + QByteArray::number(crc, 16) + '\n';
+}
+
+static bool fromRecord(QByteArrayView line, QString &key, QString &value)
+{
+    auto crcPos = line.lastIndexOf('\t');
+    if (crcPos < 0) {
+        return false;
+    }
+    auto record = line.first(crcPos);
+    bool ok = false;
+    auto crc = line.sliced(crcPos + 1).toByteArray().toUShort(&ok, 16);
+    auto keyEnd = record.indexOf('\t');
+    if (!ok || keyEnd < 0 || crc != qChecksum(record)) {
+        return false;
+    }
+    key = QString::fromUtf8(QByteArray::fromPercentEncoding(record.first(keyEnd).toByteArray()));
+    value = QString::fromUtf8(record.sliced(keyEnd + 1));
+    return true;
+}
+
+static bool syncToDisk(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return ::_commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
 LocalStorage::LocalStorage(QObject *parent)
     : QObject(parent),
       m_cache{},
+      m_checkpointsLoaded(false),
+      m_needCompact(false),
+      m_logRecords(0u),
+      m_compactAfter(DEFAULT_COMPACT_AFTER),
+      m_commitTimer(new QTimer(this)),
       m_storageName(DEFAULT_STORAGE_NAME)
 {
+    m_commitTimer->setInterval(DEFAULT_COMMIT_INTERVAL_MS);
+    m_commitTimer->callOnTimeout(this, &LocalStorage::commit);
+    m_commitTimer->start();
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &LocalStorage::commit);
     if (QDir::isAbsolutePath(DEFAULT_STORAGE_DIRECTORY)) {
         m_storageDirectory = DEFAULT_STORAGE_DIRECTORY;
     } else {
@@ -19,6 +77,11 @@ LocalStorage::LocalStorage(QObject *parent)
     }
 }
 
+LocalStorage::~LocalStorage()
+{
+    commit();
+}
+
 LocalStorage *LocalStorage::prvInstance(QObject *parent)
 {
     static LocalStorage storage(parent);
@@ -61,8 +124,22 @@ bool LocalStorage::setStorageDirectory(const QString &path)
         reDebug() << QString("Localstorage: Directory change failed (%1 is empty)").arg(path);
         return false;
     }
+    commit();
+    QMutexLocker logLock(&m_logLock);
+    QMutexLocker lock(&m_checkpointsLock);
     m_storageDirectory = newDir.canonicalPath();
     m_cache.clear();
+    m_checkpointLog.close();
+    m_checkpoints.clear();
+    m_logRecords = 0u;
+    m_needCompact = false;
+    m_checkpointsLoaded = false;
+    // Log of new directory is read before anything can be compacted into it
+    loadCheckpoints();
+    // Not committed changes are newer than the log
+    for (auto iter = m_dirtyCheckpoints.cbegin(); iter != m_dirtyCheckpoints.cend(); ++iter) {
+        m_checkpoints.insert(iter.key(), iter.value());
+    }
     return true;
 }
 
@@ -86,6 +163,15 @@ void LocalStorage::init(QObject *parent)
 QString LocalStorage::getLastStreamId(const QString &streamKey)
 {
     auto key = QString("%1/%2").arg(streamKey, LAST_STREAM_ID);
+    {
+        QMutexLocker lock(&m_checkpointsLock);
+        loadCheckpoints();
+        auto found = m_checkpoints.constFind(key);
+        if (found != m_checkpoints.cend()) {
+            return *found;
+        }
+    }
+    // checkpoints, stored by older versions
     auto lastStreamId = getValue(key).toString();
     return lastStreamId;
 }
@@ -105,7 +191,140 @@ QString LocalStorage::getFullName(const QString &wantedName) const
 void LocalStorage::setLastStreamId(const QString &streamKey, const QString &lastId)
 {
     auto key = QString("%1/%2").arg(streamKey, LAST_STREAM_ID);
-    setValue(key, lastId);
+    {
+        QMutexLocker lock(&m_checkpointsLock);
+        loadCheckpoints();
+        m_checkpoints.insert(key, lastId);
+        m_dirtyCheckpoints.insert(key, lastId);
+    }
+    if (!m_commitTimer->interval()) {
+        commit();
+    }
+}
+
+void LocalStorage::setCommitPolicy(quint32 intervalMs, quint32 compactAfter)
+{
+    m_compactAfter = compactAfter;
+    m_commitTimer->setInterval(int(intervalMs));
+    if (intervalMs) {
+        m_commitTimer->start();
+    } else {
+        m_commitTimer->stop();
+    }
+}
+
+void LocalStorage::commit()
+{
+    // Disk is touched only under log lock, so writers of checkpoints never wait for fsync
+    QMutexLocker logLock(&m_logLock);
+    QHash<QString, QString> dirty;
+    bool needCompact;
+    {
+        QMutexLocker lock(&m_checkpointsLock);
+        dirty.swap(m_dirtyCheckpoints);
+        needCompact = m_needCompact;
+    }
+    if (dirty.isEmpty() && !needCompact) {
+        return;
+    }
+    if (!m_checkpointLog.isOpen() && !openCheckpointLog()) {
+        restoreDirty(dirty);
+        return;
+    }
+    QByteArray batch;
+    for (auto iter = dirty.cbegin(); iter != dirty.cend(); ++iter) {
+        batch.append(toRecord(iter.key(), iter.value()));
+    }
+    if (m_checkpointLog.write(batch) != batch.size() || !syncToDisk(m_checkpointLog)) {
+        reError() << "Localstorage: Could not write checkpoints:" << m_checkpointLog.errorString();
+        m_checkpointLog.close();
+        restoreDirty(dirty);
+        return;
+    }
+    m_logRecords += dirty.size();
+    if (needCompact || (m_compactAfter && m_logRecords > m_compactAfter)) {
+        compactCheckpoints();
+    }
+}
+
+void LocalStorage::restoreDirty(const QHash<QString, QString> &dirty)
+{
+    QMutexLocker lock(&m_checkpointsLock);
+    for (auto iter = dirty.cbegin(); iter != dirty.cend(); ++iter) {
+        if (!m_dirtyCheckpoints.contains(iter.key())) {
+            m_dirtyCheckpoints.insert(iter.key(), iter.value());
+        }
+    }
+}
+
+void LocalStorage::loadCheckpoints()
+{
+    if (m_checkpointsLoaded) {
+        return;
+    }
+    m_checkpointsLoaded = true;
+    QFile log(getFullName(CHECKPOINT_LOG_NAME));
+    if (!log.exists()) {
+        return;
+    }
+    if (!log.open(QIODevice::ReadOnly)) {
+        reError() << "Localstorage: Could not read checkpoints:" << log.errorString();
+        return;
+    }
+    auto content = log.readAll();
+    QByteArrayView view(content);
+    QString key, value;
+    qsizetype start = 0, end;
+    while ((end = view.indexOf('\n', start)) >= 0) {
+        if (!fromRecord(view.sliced(start, end - start), key, value)) {
+            break;
+        }
+        m_checkpoints.insert(key, value);
+        start = end + 1;
+    }
+    if (start != content.size()) {
+        reWarn() << "Localstorage: Dropped torn tail of checkpoint log:" << content.size() - start << "bytes";
+    }
+    // Next commit starts from clean (compacted) log
+    m_needCompact = true;
+}
+
+bool LocalStorage::compactCheckpoints()
+{
+    QHash<QString, QString> snapshot;
+    {
+        QMutexLocker lock(&m_checkpointsLock);
+        // Snapshot replaces the log, so it must contain everything from it
+        loadCheckpoints();
+        snapshot = m_checkpoints;
+        m_needCompact = false;
+    }
+    m_checkpointLog.close();
+    QSaveFile file(getFullName(CHECKPOINT_LOG_NAME));
+    if (!file.open(QIODevice::WriteOnly)) {
+        reError() << "Localstorage: Could not compact checkpoints:" << file.errorString();
+        return false;
+    }
+    for (auto iter = snapshot.cbegin(); iter != snapshot.cend(); ++iter) {
+        file.write(toRecord(iter.key(), iter.value()));
+    }
+    // QSaveFile syncs to disk and atomically replaces old log
+    if (!file.commit()) {
+        reError() << "Localstorage: Could not compact checkpoints:" << file.errorString();
+        return false;
+    }
+    m_logRecords = snapshot.size();
+    return openCheckpointLog();
+}
+
+bool LocalStorage::openCheckpointLog()
+{
+    m_checkpointLog.setFileName(getFullName(CHECKPOINT_LOG_NAME));
+    if (!m_checkpointLog.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        reError() << "Localstorage: Could not open checkpoint log:" << m_checkpointLog.errorString();
+        return false;
+    }
+    return true;
 }
 
 QVariant LocalStorage::getValue(const QString &key, const bool forceFileRead)
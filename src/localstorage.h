@@ -7,8 +7,11 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QMutex>
 #include "radapterlogging.h"
 
+class QTimer;
+
 class RADAPTER_API LocalStorage : public QObject
 {
     Q_OBJECT
@@ -21,24 +24,44 @@ public:
     bool setStorageDirectory(const QString &path);
     bool setStorageName(const QString &name);
 
+    //! Stream checkpoints are kept in memory and appended to checkpoint log on commit()
     QString getLastStreamId(const QString &streamKey);
     void setLastStreamId(const QString &streamKey, const QString &lastId);
+    //! \param intervalMs 0 --> commit on every change
+    void setCommitPolicy(quint32 intervalMs, quint32 compactAfter);
 
     QVariant getValue(const QString &path, const bool forceFileRead = false);
     void setValue(const QString &path, const QVariant &value);
 signals:
 
 public slots:
+    void commit();
 
 private:
     explicit LocalStorage(QObject *parent = nullptr);
+    ~LocalStorage() override;
     static LocalStorage* prvInstance(QObject *parent = nullptr);
 
     QString getFullName()const;
     QString getFullName(const QString &wantedFile)const;
+    void loadCheckpoints();
+    bool compactCheckpoints();
+    bool openCheckpointLog();
+    void restoreDirty(const QHash<QString, QString> &dirty);
 
     QVariantMap m_cache;
 
+    QMutex m_logLock;
+    QMutex m_checkpointsLock;
+    QHash<QString, QString> m_checkpoints;
+    QHash<QString, QString> m_dirtyCheckpoints;
+    bool m_checkpointsLoaded;
+    bool m_needCompact;
+    QFile m_checkpointLog;
+    quint32 m_logRecords;
+    quint32 m_compactAfter;
+    QTimer *m_commitTimer;
+
     QString m_storageName;
     QString m_storageDirectory;
 };
@@ -1,8 +1,16 @@
 SOURCES+= \
+   $$PWD/modbusdecodeplan.cpp \
    $$PWD/modbusmaster.cpp \
    $$PWD/modbusparsing.cpp \
+   $$PWD/modbuspollschedule.cpp \
+   $$PWD/modbusreadplanner.cpp \
+   $$PWD/modbusrequestwindow.cpp \
    $$PWD/modbusslave.cpp
 HEADERS+= \
+   $$PWD/modbusdecodeplan.h \
    $$PWD/modbusmaster.h \
    $$PWD/modbusparsing.h \
+   $$PWD/modbuspollschedule.h \
+   $$PWD/modbusreadplanner.h \
+   $$PWD/modbusrequestwindow.h \
    $$PWD/modbusslave.h
@@ -0,0 +1,115 @@
+#include "modbusdecodeplan.h"
+#include "settings/modbussettings.h"
+#include "utils/wordoperations.h"
+#include <QVarLengthArray>
+#include <algorithm>
+
+// Slave compiles plans for whatever ranges clients write, cache is dropped when this is exceeded
+#define MAX_CACHED_PLANS 1024
+// Largest register read (protocol limit), bigger replies (bit tables) are swapped on heap
+#define SWAP_BUFFER_WORDS 125
+
+using namespace Modbus;
+using namespace ByteUtils;
+
+static bool isBitTable(QModbusDataUnit::RegisterType table)
+{
+    return table == QModbusDataUnit::Coils || table == QModbusDataUnit::DiscreteInputs;
+}
+
+static int sizeWords(DecodeField::Kind kind)
+{
+    return kind == DecodeField::UShort ? 1 : 2;
+}
+
+void RegisterDecoder::add(const Settings::RegisterInfo &reg, JsonKeys::Id key)
+{
+    const static Settings::PackingMode thisPack{Order::BigEndian, getEndianess()};
+    const Settings::PackingMode &mode = reg.endianess;
+    DecodeField field;
+    field.offset = quint16(reg.index.value);
+    switch (isBitTable(reg.table) ? QMetaType::UShort : reg.type.value) {
+    case QMetaType::UShort: field.kind = DecodeField::UShort; break;
+    case QMetaType::UInt: field.kind = DecodeField::UInt; break;
+    case QMetaType::Float: field.kind = DecodeField::Float; break;
+    default: throw std::runtime_error("Unsupported Modbus Value Type!");
+    }
+    field.swapBytes = mode.bytes != thisPack.bytes;
+    field.swapWords = mode.words != thisPack.words;
+    field.key = key;
+    m_registers[reg.table].insert(reg.index, field);
+    m_plans.clear();
+}
+
+const DecodePlan &RegisterDecoder::planFor(QModbusDataUnit::RegisterType table, int start, int count)
+{
+    const auto id = quint64(table) << 32 | quint64(quint16(start)) << 16 | quint16(count);
+    auto cached = m_plans.constFind(id);
+    if (cached != m_plans.cend()) {
+        return *cached;
+    }
+    if (m_plans.size() >= MAX_CACHED_PLANS) {
+        m_plans.clear();
+    }
+    return *m_plans.insert(id, compile(table, start, count));
+}
+
+DecodePlan RegisterDecoder::compile(QModbusDataUnit::RegisterType table, int start, int count) const
+{
+    DecodePlan result;
+    const auto registers = m_registers.constFind(table);
+    if (registers == m_registers.cend()) {
+        return result;
+    }
+    // Register overlapped by previous multi-word value is skipped (same as sequential parsing)
+    int nextFree = start;
+    for (auto reg = registers->lowerBound(start); reg != registers->cend() && reg.key() < start + count; ++reg) {
+        if (reg.key() < nextFree) {
+            continue;
+        }
+        const auto size = sizeWords(reg->kind);
+        if (reg.key() + size > start + count) {
+            break;
+        }
+        auto field = *reg;
+        field.offset = quint16(reg.key() - start);
+        result.fields.append(field);
+        result.swapsBytes |= field.swapBytes;
+        nextFree = reg.key() + size;
+    }
+    result.words = nextFree - start;
+    std::sort(result.fields.begin(), result.fields.end(), [](const DecodeField &lhs, const DecodeField &rhs){
+        return lhs.key < rhs.key;
+    });
+    result.fields.squeeze();
+    return result;
+}
+
+void RegisterDecoder::decode(const DecodePlan &plan, const quint16 *words, FlatJson &out)
+{
+    // One vectorized pass over reply instead of swapping field by field
+    QVarLengthArray<quint16, SWAP_BUFFER_WORDS> swapped;
+    if (plan.swapsBytes) {
+        swapped.resize(plan.words);
+        flipBytesInWords(words, swapped.data(), plan.words);
+    }
+    out.reserve(out.size() + plan.fields.size());
+    for (const auto &field : plan.fields) {
+        const auto src = field.swapBytes ? swapped.constData() : words;
+        if (field.kind == DecodeField::UShort) {
+            out.append(field.key, QVariant(src[field.offset]));
+            continue;
+        }
+        const quint16 pair[2] = {src[field.offset + field.swapWords], src[field.offset + !field.swapWords]};
+        if (field.kind == DecodeField::UInt) {
+            out.append(field.key, QVariant(bit_cast<quint32>(pair)));
+        } else {
+            out.append(field.key, QVariant(bit_cast<float>(pair)));
+        }
+    }
+}
+
+int RegisterDecoder::plansCount() const
+{
+    return m_plans.size();
+}
@@ -0,0 +1,62 @@
+#ifndef MODBUS_DECODEPLAN_H
+#define MODBUS_DECODEPLAN_H
+
+#include "jsondict/flatjson.h"
+#include <QModbusDataUnit>
+
+namespace Settings {
+struct RegisterInfo;
+}
+
+namespace Modbus {
+
+//! Register inside of a reply, with type and endianess resolved once
+struct DecodeField {
+    enum Kind : quint8 {
+        UShort = 0,
+        UInt,
+        Float
+    };
+    //! Words from start of reply
+    quint16 offset;
+    Kind kind;
+    bool swapBytes;
+    bool swapWords;
+    JsonKeys::Id key;
+};
+
+//! Registers of one (table, start, count) reply
+struct DecodePlan {
+    //! Sorted by key (for FlatJson::append())
+    QVector<DecodeField> fields;
+    //! Words from start of reply, that fields cover
+    int words{0};
+    //! Any field swaps bytes --> reply is byte swapped once as a whole
+    bool swapsBytes{false};
+};
+
+//! Replaces per word lookups of register name --> settings --> type with flat plans,
+//! compiled per reply layout and reused
+class RegisterDecoder
+{
+public:
+    //! Bit tables are always decoded as one word
+    void add(const Settings::RegisterInfo &reg, JsonKeys::Id key);
+    //! Compiled on first use. Registers not fitting into count are skipped
+    const DecodePlan &planFor(QModbusDataUnit::RegisterType table, int start, int count);
+    //! Plan must be compiled for this count of words
+    static void decode(const DecodePlan &plan, const quint16 *words, FlatJson &out);
+    int plansCount() const;
+private:
+    DecodePlan compile(QModbusDataUnit::RegisterType table, int start, int count) const;
+
+    //! Field offset here is absolute register index
+    QHash<QModbusDataUnit::RegisterType, QMap<int, DecodeField>> m_registers;
+    QHash<quint64, DecodePlan> m_plans;
+};
+
+}
+
+Q_DECLARE_TYPEINFO(Modbus::DecodeField, Q_PRIMITIVE_TYPE);
+
+#endif // MODBUS_DECODEPLAN_H
@@ -9,7 +9,12 @@
 #include "consumers/rediscacheconsumer.h"
 #include "producers/rediscacheproducer.h"
 #include "jsondict/jsondict.h"
+#include "jsondict/flatjson.h"
 #include "modbusparsing.h"
+#include "modbusreadplanner.h"
+#include "modbuspollschedule.h"
+#include "modbusrequestwindow.h"
+#include "modbusdecodeplan.h"
 #include <QModbusReply>
 #include "sync/syncjson.h"
 #include <QModbusClient>
@@ -17,8 +22,10 @@
 #include <QModbusTcpClient>
 #include <QModbusReply>
 #include <QQueue>
+#include <QPointer>
 #include <QTimer>
 #include <QObject>
+#include <QElapsedTimer>
 
 #define MAX_RECONNECTS 5
 
@@ -33,10 +40,17 @@ struct RegisterMetaInfo {
 struct Master::Private{
     Settings::ModbusMaster settings;
     QHash<QModbusDataUnit::RegisterType, QHash<int, QString>> reverseRegisters;
+    RegisterDecoder decoder;
+    FlatJson lastRead;
     QMap<QString, RegisterMetaInfo> regsMetaInfo;
     QQueue<QModbusDataUnit> readQueue;
     QQueue<QModbusDataUnit> writeQueue;
     QList<QModbusDataUnit> queries;
+    PollSchedule schedule;
+    //! Mask of due groups --> merged read plan
+    QHash<quint64, QList<QModbusDataUnit>> plans;
+    ReadPlanOptions planOptions;
+    QElapsedTimer pollClock;
     Sync::Json state;
     QTimer *reconnectTimer;
     QTimer *readTimer;
@@ -45,6 +59,7 @@ struct Master::Private{
     Redis::CacheProducer *stateWriter{nullptr};
     Redis::CacheConsumer *stateReader{nullptr};
     int reconnectAttempts{0};
+    RequestWindow window;
 };
 
 Master::Master(const Settings::ModbusMaster &settings, QThread *thread) :
@@ -57,14 +72,16 @@ Master::Master(const Settings::ModbusMaster &settings, QThread *thread) :
     d->reconnectTimer->setInterval(settings.reconnect_timeout_ms);
     d->reconnectTimer->callOnTimeout(this, &Master::connectDevice);
     d->reconnectTimer->setSingleShot(true);
-    d->readTimer->setInterval(settings.poll_rate);
-    d->readTimer->callOnTimeout(this, &Master::doRead);
+    d->readTimer->setSingleShot(true);
+    d->readTimer->setTimerType(Qt::PreciseTimer);
+    d->readTimer->callOnTimeout(this, &Master::pollDue);
     connect(this, &Master::connected, [this]{
         d->connected=true;
-        doRead();
+        startPolling();
     });
     connect(this, &Master::disconnected, [this]{
         d->connected=false;
+        d->readTimer->stop();
     });
     for (auto [name, reg]: keyVal(d->settings.m_registers)) {
         if (d->reverseRegisters[reg.table].contains(reg.index)) {
@@ -76,14 +93,28 @@ Master::Master(const Settings::ModbusMaster &settings, QThread *thread) :
                                         "; Register: " + QString::number(reg.index.value).toStdString() + ")");
         }
         d->reverseRegisters[reg.table][reg.index] = name;
+        d->decoder.add(reg, JsonKeys::intern(name));
     }
     for (auto [key, reg]: keyVal(d->settings.m_registers)) {
         d->regsMetaInfo[key] = RegisterMetaInfo{key};
         if (reg.readable) {
-            d->queries.append(QModbusDataUnit{reg.table, reg.index, 1});
+            const bool isBit = reg.table == QModbusDataUnit::Coils || reg.table == QModbusDataUnit::DiscreteInputs;
+            const auto size = isBit ? 1 : QMetaType(reg.type).sizeOf() / 2;
+            const auto unit = QModbusDataUnit{reg.table, reg.index, quint16(size)};
+            const auto interval = reg.poll_rate ? reg.poll_rate.value : settings.poll_rate.value;
+            d->schedule.add(unit, interval);
+            d->queries.append(unit);
         }
     }
-    d->queries = Modbus::mergeDataUnits(d->queries);
+    if (d->schedule.groups().size() > PollSchedule::MaxGroups) {
+        throw std::runtime_error(printSelf().toStdString() + ": Too many different register poll rates, max: " + std::to_string(PollSchedule::MaxGroups));
+    }
+    d->planOptions = ReadPlanOptions::fromSettings(d->settings);
+    d->queries = Modbus::planReads(d->queries, d->planOptions);
+    for (const auto &unit : qAsConst(d->queries)) {
+        d->decoder.planFor(unit.registerType(), unit.startAddress(), int(unit.valueCount()));
+    }
+    workerInfo(this) << "Read plan: requests per full poll:" << d->queries.size() << "; Poll groups:" << d->schedule.groups().size();
 }
 
 void Master::initClient()
@@ -92,6 +123,8 @@ void Master::initClient()
         d->device = new QModbusTcpClient(this);
         d->device->setConnectionParameter(QModbusDevice::NetworkAddressParameter, d->settings.m_device.tcp->host.value);
         d->device->setConnectionParameter(QModbusDevice::NetworkPortParameter, d->settings.m_device.tcp->port.value);
+        // Replies carry transaction id, QModbusTcpClient matches them to requests
+        d->window = RequestWindow(int(d->settings.max_inflight));
     } else {
         d->device = new QModbusRtuSerialClient(this);
         d->device->setConnectionParameter(QModbusDevice::SerialBaudRateParameter, d->settings.m_device.rtu->baud);
@@ -113,28 +146,32 @@ void Master::onRun()
         if (!d->stateReader) {
             throw std::runtime_error(printSelf().toStdString() + ": Could not fetch RedisCacheConsumer: " + d->settings.state_reader->toStdString());
         }
-        d->stateReader->waitConnected(this);
+        dependOn(d->stateReader);
     }
     if (d->settings.state_writer.wasUpdated()) {
         d->stateWriter = broker()->getWorker<Redis::CacheProducer>(d->settings.state_writer);
         if (!d->stateWriter) {
             throw std::runtime_error(printSelf().toStdString() + ": Could not fetch RedisCacheProducer: " + d->settings.state_writer->toStdString());
         }
-        d->stateWriter->waitConnected(this);
+        dependOn(d->stateWriter);
     }
+    Worker::onRun();
+}
+
+void Master::onDependenciesReady()
+{
     initClient();
     attachToChannel();
     connectDevice();
     fetchState();
-    if (config().poll_rate) {
-        d->readTimer->start();
-    }
-    Worker::onRun();
+    Worker::onDependenciesReady();
 }
 
 Master::~Master()
 {
-    d->device->disconnectDevice();
+    if (d->device) {
+        d->device->disconnectDevice();
+    }
     delete d;
 }
 
@@ -146,7 +183,12 @@ bool Master::isConnected() const
 void Master::attachToChannel()
 {
     auto channel = d->settings.m_device.channel.data();
-    channel->registerUser(this);
+    // Polls ask with interval of their groups, everything else (writes, rest of batch) is due within fastest one
+    quint32 period = d->settings.poll_rate.value;
+    if (d->schedule.fastest()) {
+        period = qMin(period, d->schedule.fastest());
+    }
+    channel->registerUser(this, Sync::Channel::NormalPriority, period);
     channel->callOnTrigger(this, &Master::executeNext);
     channel->signalJobDone(this, &Master::queryDone);
     channel->signalJobDone(this, &Master::allQueriesDone);
@@ -176,6 +218,7 @@ void Master::fetchState()
         command.setCallback(this, [this](const Redis::Cache::ReadObject::WantedReply *reply){
             d->state.updateTarget(reply->json());
             d->state.updateCurrent(reply->json());
+            d->lastRead.clear();
         });
         command.receivers() = {d->stateReader};
         emit sendMsg(command);
@@ -237,7 +280,7 @@ void Master::connectDevice()
         d->reconnectTimer->start();
     } else {
         if (!d->writeQueue.isEmpty() || !d->readQueue.isEmpty()) {
-            emit askTrigger();
+            emit askTrigger(0);
         }
     }
 }
@@ -248,12 +291,44 @@ void Master::executeNext()
         emit allQueriesDone();
         return;
     }
-    if (!d->writeQueue.isEmpty()) {
-        executeWrite(d->writeQueue.dequeue());
-    } else if (!d->readQueue.isEmpty()) {
-        executeRead(d->readQueue.dequeue());
-    } else {
+    if (d->writeQueue.isEmpty() && d->readQueue.isEmpty()) {
         emit allQueriesDone();
+        return;
+    }
+    // Requests queued later wait for next trigger, so this master can not hold shared channel forever
+    d->window.startTrigger(d->writeQueue.size() + d->readQueue.size());
+    fillWindow();
+    if (!d->window.inflight()) {
+        emit queryDone();
+    }
+}
+
+void Master::fillWindow()
+{
+    while (d->window.take()) {
+        bool sent = false;
+        if (!d->writeQueue.isEmpty()) {
+            sent = executeWrite(d->writeQueue.dequeue());
+        } else if (!d->readQueue.isEmpty()) {
+            sent = executeRead(d->readQueue.dequeue());
+        } else {
+            break;
+        }
+        if (!sent) {
+            break;
+        }
+    }
+}
+
+void Master::onRequestDone()
+{
+    d->window.done();
+    // RTU: one request per trigger, so channel can give the bus to others in between
+    if (d->window.maxInflight() > 1 && d->connected) {
+        fillWindow();
+    }
+    if (!d->window.inflight()) {
+        emit queryDone();
     }
 }
 
@@ -287,10 +362,13 @@ void Master::onStateChanged(QModbusDevice::State state)
 
 void Master::onReadReady()
 {
-    auto rawReply = qobject_cast<QModbusReply *>(sender());
-    if (!rawReply) {
-        return;
+    if (auto reply = qobject_cast<QModbusReply *>(sender())) {
+        handleRead(reply);
     }
+}
+
+void Master::handleRead(QModbusReply *rawReply)
+{
     QScopedPointer<QModbusReply, QScopedPointerDeleteLater> reply{rawReply};
     if (reply->error() != QModbusDevice::NoError) {
         workerError(this, .noquote()) << ": Error Reading:\n" << reply->errorString();
@@ -298,34 +376,26 @@ void Master::onReadReady()
         return;
     }
     d->reconnectAttempts = 0;
-    auto words = reply->result().values();
-    auto table = reply->result().registerType();
-    JsonDict resultJson;
-    for (int i = 0; i < words.size();) {
-        auto index = reply->result().startAddress() + i;
-        if (!d->reverseRegisters[table].contains(index)) {
-            ++i;
-            continue;
-        }
-        const auto &registersName = d->reverseRegisters[table][index];
-        const auto &regData = config().m_registers[registersName];
-        auto sizeWords = QMetaType(regData.type).sizeOf()/2;
-        if (i + sizeWords > words.size()) {
-            break;
-        }
-        auto result = parseModbusType(words.data() + i, regData, sizeWords);
-        i += sizeWords;
-        resultJson.insert(registersName.split(':'), result);
-    }
-    updateCurrent(resultJson);
+    const auto unit = reply->result();
+    const auto words = unit.values();
+    const auto &plan = d->decoder.planFor(unit.registerType(), unit.startAddress(), int(words.size()));
+    FlatJson resultJson;
+    RegisterDecoder::decode(plan, words.constData(), resultJson);
+    // Nested json is built only for changed registers (state already holds the rest,
+    // lastRead is cleared whenever state is replaced). Writes are verified on every read
+    auto delta = d->lastRead.update(resultJson);
+    updateCurrent(delta.isEmpty() ? JsonDict{} : delta.toJson());
 }
 
 void Master::onWriteReady()
 {
-    auto rawReply = qobject_cast<QModbusReply*>(sender());
-    if (!rawReply) {
-        return;
+    if (auto reply = qobject_cast<QModbusReply*>(sender())) {
+        handleWrite(reply);
     }
+}
+
+void Master::handleWrite(QModbusReply *rawReply)
+{
     QScopedPointer<QModbusReply, QScopedPointerDeleteLater> reply{rawReply};
     auto unit = reply->result();
     auto err = reply->error();
@@ -338,14 +408,47 @@ void Master::onWriteReady()
     }
 }
 
-void Master::doRead()
+void Master::startPolling()
+{
+    // First poll of every group right away (merged into full plan), phased ones after it
+    d->pollClock.start();
+    d->schedule.start(0);
+    pollDue();
+}
+
+void Master::schedulePoll()
+{
+    const auto next = d->schedule.nextDue();
+    if (next >= 0) {
+        d->readTimer->start(int(qMax<qint64>(0, next - d->pollClock.elapsed())));
+    }
+}
+
+void Master::pollDue()
 {
     if (!d->connected) {
         return;
     }
-    for (auto &query: d->queries) {
-        enqeueRead(query);
+    const auto due = d->schedule.takeDue(d->pollClock.elapsed());
+    if (due.groups) {
+        for (const auto &query : planFor(due.groups)) {
+            enqeueRead(query, due.deadline);
+        }
     }
+    schedulePoll();
+}
+
+const QList<QModbusDataUnit> &Master::planFor(quint64 groupsMask)
+{
+    auto cached = d->plans.constFind(groupsMask);
+    if (cached != d->plans.cend()) {
+        return *cached;
+    }
+    auto &plan = *d->plans.insert(groupsMask, planReads(d->schedule.unitsOf(groupsMask), d->planOptions));
+    for (const auto &unit : qAsConst(plan)) {
+        d->decoder.planFor(unit.registerType(), unit.startAddress(), int(unit.valueCount()));
+    }
+    return plan;
 }
 
 void Master::updateCurrent(const JsonDict &json)
@@ -382,7 +485,7 @@ void Master::updateCurrent(const JsonDict &json)
     }
 }
 
-void Master::enqeueRead(const QModbusDataUnit &unit)
+void Master::enqeueRead(const QModbusDataUnit &unit, quint32 deadlineMs)
 {
     for (auto &query: d->readQueue) {
         if (query.registerType() == unit.registerType() &&
@@ -393,55 +496,59 @@ void Master::enqeueRead(const QModbusDataUnit &unit)
         }
     }
     d->readQueue.enqueue(unit);
-    emit askTrigger();
+    emit askTrigger(deadlineMs);
 }
 
 void Master::enqeueWrite(const QModbusDataUnit &state)
 {
     d->writeQueue.enqueue(state);
-    emit askTrigger();
+    emit askTrigger(0);
 }
 
-void Master::executeRead(const QModbusDataUnit &unit)
+bool Master::executeRead(const QModbusDataUnit &unit)
 {
     if (auto reply = d->device->sendReadRequest(unit, d->settings.slave_id)) {
-        connect(reply, &QModbusReply::destroyed, this, [this](QObject *obj){
-            Q_UNUSED(obj)
-            emit queryDone();
-        });
+        d->window.sent();
+        connect(reply, &QModbusReply::destroyed, this, &Master::onRequestDone);
         if (!reply->isFinished()) {
             QObject::connect(reply, &QModbusReply::finished, this, &Master::onReadReady);
         } else {
-            delete reply;
+            // Handled as if finished came, but not at once: window is being filled right now
+            QMetaObject::invokeMethod(this, [this, reply = QPointer<QModbusReply>(reply)]{
+                if (reply) handleRead(reply);
+            }, Qt::QueuedConnection);
         }
+        return true;
     } else {
-        emit queryDone();
         if (d->connected) {
             workerError(this) << "Read Error: " << d->device->errorString() << "; Reconnecting...";
             reconnect();
         }
+        return false;
     }
 }
 
-void Master::executeWrite(const QModbusDataUnit &state)
+bool Master::executeWrite(const QModbusDataUnit &state)
 {
     workerInfo(this, .noquote()) << "Writing...:\n" << printUnit(state);
     if (auto reply = d->device->sendWriteRequest(state, d->settings.slave_id)) {
-        connect(reply, &QModbusReply::destroyed, this, [this](QObject *obj){
-            Q_UNUSED(obj)
-            emit queryDone();
-        });
+        d->window.sent();
+        connect(reply, &QModbusReply::destroyed, this, &Master::onRequestDone);
         if (!reply->isFinished()) {
             QObject::connect(reply, &QModbusReply::finished, this, &Master::onWriteReady);
         } else {
-            delete reply;
+            // E.g. broadcast write: handled as if finished came, but not at once (window is being filled right now)
+            QMetaObject::invokeMethod(this, [this, reply = QPointer<QModbusReply>(reply)]{
+                if (reply) handleWrite(reply);
+            }, Qt::QueuedConnection);
         }
+        return true;
     } else {
-        emit queryDone();
         if (d->connected) {
             workerInfo(this) << "Write Error: " << d->device->errorString() << "; Reconnecting...";
             reconnect();
         }
+        return false;
     }
 }
 
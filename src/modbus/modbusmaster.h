@@ -5,6 +5,7 @@
 #include <QModbusDataUnit>
 #include <QModbusDevice>
 
+class QModbusReply;
 namespace Settings {
 struct ModbusMaster;
 }
@@ -17,11 +18,13 @@ class Master : public Radapter::Worker
 public:
     Master(const Settings::ModbusMaster &settings, QThread *thread);
     void onRun() override;
+    void onDependenciesReady() override;
     ~Master() override;
     bool isConnected() const;
     const Settings::ModbusMaster &config() const;
 signals:
-    void askTrigger();
+    //! 0 --> within fastest poll interval (registered period)
+    void askTrigger(quint32 deadlineMs);
     void queryDone();
     void allQueriesDone();
     void connected();
@@ -32,22 +35,34 @@ public slots:
 private slots:
     void onReadReady();
     void onWriteReady();
-    void doRead();
+    void pollDue();
     void onErrorOccurred(QModbusDevice::Error error);
     void onStateChanged(QModbusDevice::State state);
     void reconnect();
 private:
+    //! Reply is deleted later (finished or not: connection loss)
+    void handleRead(QModbusReply *reply);
+    void handleWrite(QModbusReply *reply);
     void updateCurrent(const JsonDict &json);
-    void enqeueRead(const QModbusDataUnit &unit);
+    //! \param deadlineMs of channel request, usually interval of poll group
+    void enqeueRead(const QModbusDataUnit &unit, quint32 deadlineMs);
     void enqeueWrite(const QModbusDataUnit &unit);
     void executeNext();
     void initClient();
-    void executeRead(const QModbusDataUnit &unit);
-    void executeWrite(const QModbusDataUnit &state);
+    //! Sends queued requests until in-flight window is full
+    void fillWindow();
+    void onRequestDone();
+    //! \return false if request could not be sent
+    bool executeRead(const QModbusDataUnit &unit);
+    bool executeWrite(const QModbusDataUnit &state);
     void saveState(const JsonDict &state);
     void fetchState();
     void write(const JsonDict &data);
     void attachToChannel();
+    //! On connect: polls everything, then keeps polling groups at their intervals
+    void startPolling();
+    void schedulePoll();
+    const QList<QModbusDataUnit> &planFor(quint64 groupsMask);
 
     Private *d;
 };
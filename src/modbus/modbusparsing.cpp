@@ -1,70 +1,65 @@
 #include "modbusparsing.h"
-#include "templates/algorithms.hpp"
+#include <algorithm>
 #include "utils/wordoperations.h"
 
 using namespace ByteUtils;
 
-bool mergeDataUnit(QList<QModbusDataUnit> &target, const QModbusDataUnit &unit) {
-    for (auto &item : target) {
-        if (item.startAddress() + item.valueCount() == static_cast<quint32>(unit.startAddress()) &&
-                item.registerType() == unit.registerType()) {
-            item.setValues(item.values() + unit.values());
-            return true;
-        }
-    }
-    return false;
-};
+// Write Multiple Registers / Coils (0x10 / 0x0F) limits
+#define MAX_WRITE_REGISTERS 123
+#define MAX_WRITE_COILS 1968
 
-void sortAndMergeDataUnits(QList<QModbusDataUnit> &target) {
-    Radapter::sort(target, &QModbusDataUnit::startAddress);
-    auto copy = target;
-    QList<int> toRemove{};
-    for (auto [count, unit] : Radapter::enumerate(copy)) {
-        if (mergeDataUnit(target, unit)) {
-            toRemove.append(count);
-        }
+// Sorted once, then each unit is either appended to previous one (strictly adjacent) or starts new one
+static void sortAndMergeDataUnits(QList<QModbusDataUnit> &units, QList<QModbusDataUnit> &result) {
+    if (units.isEmpty()) {
+        return;
     }
-    for (auto [count, index] : Radapter::enumerate(toRemove)) {
-        target.removeAt(index - count);
+    // Stable: repeated writes to same address keep their order
+    std::stable_sort(units.begin(), units.end(), [](const QModbusDataUnit &left, const QModbusDataUnit &right){
+        return left.startAddress() < right.startAddress();
+    });
+    const auto table = units.constFirst().registerType();
+    const auto maxCount = table == QModbusDataUnit::Coils || table == QModbusDataUnit::DiscreteInputs
+                              ? MAX_WRITE_COILS : MAX_WRITE_REGISTERS;
+    auto current = units.constFirst();
+    auto values = current.values();
+    for (int i = 1; i < units.size(); ++i) {
+        const auto &unit = units[i];
+        if (current.startAddress() + values.size() == unit.startAddress() &&
+            values.size() + unit.values().size() <= maxCount) {
+            values += unit.values();
+            continue;
+        }
+        current.setValues(values);
+        result.append(current);
+        current = unit;
+        values = unit.values();
     }
-};
+    current.setValues(values);
+    result.append(current);
+}
+
 QList<QModbusDataUnit> Modbus::mergeDataUnits(const QList<QModbusDataUnit> &src)
 {
-    QList<QModbusDataUnit> holdingResult;
-    QList<QModbusDataUnit> diResult;
-    QList<QModbusDataUnit> inputResult;
-    QList<QModbusDataUnit> coilsResult;
+    QList<QModbusDataUnit> holding;
+    QList<QModbusDataUnit> di;
+    QList<QModbusDataUnit> input;
+    QList<QModbusDataUnit> coils;
     for (auto &unit : src) {
         switch (unit.registerType()) {
-        case QModbusDataUnit::HoldingRegisters:
-            if (!mergeDataUnit(holdingResult, unit)) {
-                holdingResult.append(unit);
-            }
-            continue;
-        case QModbusDataUnit::DiscreteInputs:
-            if (!mergeDataUnit(diResult, unit)) {
-                diResult.append(unit);
-            }
-            continue;
-        case QModbusDataUnit::Coils:
-            if (!mergeDataUnit(coilsResult, unit)) {
-                coilsResult.append(unit);
-            }
-            continue;
-        case QModbusDataUnit::InputRegisters:
-            if (!mergeDataUnit(inputResult, unit)) {
-                inputResult.append(unit);
-            }
-            continue;
-        default:
-            continue;
+        case QModbusDataUnit::HoldingRegisters: holding.append(unit); continue;
+        case QModbusDataUnit::DiscreteInputs: di.append(unit); continue;
+        case QModbusDataUnit::Coils: coils.append(unit); continue;
+        case QModbusDataUnit::InputRegisters: input.append(unit); continue;
+        default: continue;
         }
     }
-    sortAndMergeDataUnits(holdingResult);
-    sortAndMergeDataUnits(diResult);
-    sortAndMergeDataUnits(inputResult);
-    sortAndMergeDataUnits(coilsResult);
-    return holdingResult += diResult += inputResult += coilsResult;
+    QList<QModbusDataUnit> result;
+    result.reserve(src.size());
+    sortAndMergeDataUnits(holding, result);
+    sortAndMergeDataUnits(di, result);
+    sortAndMergeDataUnits(input, result);
+    sortAndMergeDataUnits(coils, result);
+    return result;
 }
 
 QModbusDataUnit Modbus::parseValueToDataUnit(const QVariant &src, const Settings::RegisterInfo &regInfo)
@@ -0,0 +1,89 @@
+#include "modbuspollschedule.h"
+#include <cmath>
+
+#define GOLDEN_RATIO_FRACTION 0.6180339887
+
+using namespace Modbus;
+
+void PollSchedule::add(const QModbusDataUnit &unit, quint32 interval)
+{
+    for (auto &group : m_groups) {
+        if (group.interval == interval) {
+            group.units.append(unit);
+            return;
+        }
+    }
+    m_groups.append(PollGroup{interval, {unit}});
+}
+
+const QVector<PollGroup> &PollSchedule::groups() const
+{
+    return m_groups;
+}
+
+quint32 PollSchedule::fastest() const
+{
+    quint32 result = 0;
+    for (const auto &group : m_groups) {
+        if (group.interval && (!result || group.interval < result)) {
+            result = group.interval;
+        }
+    }
+    return result;
+}
+
+void PollSchedule::start(qint64 now)
+{
+    // Golden ratio fractions spread phases evenly, so groups with different intervals rarely hit the bus at once
+    for (int i = 0; i < m_groups.size(); ++i) {
+        auto &group = m_groups[i];
+        group.nextDue = now;
+        group.phase = qint64(group.interval * std::fmod(i * GOLDEN_RATIO_FRACTION, 1.0));
+        if (!group.phase) {
+            group.phase = group.interval;
+        }
+        group.polled = false;
+    }
+}
+
+qint64 PollSchedule::nextDue() const
+{
+    qint64 next = -1;
+    for (const auto &group : m_groups) {
+        if (group.interval && (next < 0 || group.nextDue < next)) {
+            next = group.nextDue;
+        }
+    }
+    return next;
+}
+
+PollSchedule::Due PollSchedule::takeDue(qint64 now)
+{
+    Due result;
+    for (int i = 0; i < m_groups.size(); ++i) {
+        auto &group = m_groups[i];
+        if (!group.interval || group.nextDue > now + MergeWindowMs) {
+            continue;
+        }
+        result.groups |= quint64(1) << i;
+        result.deadline = result.deadline ? qMin(result.deadline, group.interval) : group.interval;
+        group.nextDue += group.polled ? group.interval : group.phase;
+        group.polled = true;
+        if (group.nextDue <= now) {
+            // Bus could not keep up
+            group.nextDue = now + group.interval;
+        }
+    }
+    return result;
+}
+
+QList<QModbusDataUnit> PollSchedule::unitsOf(quint64 groupsMask) const
+{
+    QList<QModbusDataUnit> result;
+    for (int i = 0; i < m_groups.size(); ++i) {
+        if (groupsMask & (quint64(1) << i)) {
+            result += m_groups[i].units;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef MODBUS_POLLSCHEDULE_H
+#define MODBUS_POLLSCHEDULE_H
+
+#include "private/global.h"
+#include <QModbusDataUnit>
+#include <QVector>
+
+namespace Modbus {
+
+//! Registers with same poll interval
+struct PollGroup {
+    quint32 interval;
+    QList<QModbusDataUnit> units;
+    qint64 nextDue{0};
+    //! Delay of second poll after first one: groups with different intervals are spread apart by it
+    qint64 phase{0};
+    //! Was polled since start(): next poll is due after interval, not after phase
+    bool polled{false};
+};
+
+//! Multi-rate polling on monotonic clock (ms). Groups are indexed by order of their first register
+class RADAPTER_API PollSchedule
+{
+public:
+    //! Groups are passed as bit masks
+    static constexpr int MaxGroups = 64;
+    //! Groups due within this window are read together
+    static constexpr int MergeWindowMs = 10;
+
+    //! Unit joins group of its interval (created on first use). Interval 0 is never polled.
+    //! More than MaxGroups groups can not be polled, caller checks groups().size()
+    void add(const QModbusDataUnit &unit, quint32 interval);
+    const QVector<PollGroup> &groups() const;
+    //! Shortest interval, 0 if none
+    quint32 fastest() const;
+    //! Every group is due at once, then it is polled after its phase (golden ratio fraction of interval),
+    //! then once per interval
+    void start(qint64 now);
+    //! Time of earliest due group, -1 if none
+    qint64 nextDue() const;
+    struct Due {
+        //! Bit per group index
+        quint64 groups{0};
+        //! Shortest interval of due groups: their reads must be done before next poll
+        quint32 deadline{0};
+    };
+    //! Takes groups due within MergeWindowMs and schedules their next polls. Missed polls are skipped, not caught up
+    Due takeDue(qint64 now);
+    //! Units of groups in mask, in order of groups
+    QList<QModbusDataUnit> unitsOf(quint64 groupsMask) const;
+private:
+    QVector<PollGroup> m_groups;
+};
+
+}
+
+#endif // MODBUS_POLLSCHEDULE_H
@@ -0,0 +1,92 @@
+#include "modbusreadplanner.h"
+#include "settings/modbussettings.h"
+#include <algorithm>
+
+#define BITS_PER_REGISTER 16
+
+using namespace Modbus;
+
+// [start, end)
+using Span = QPair<int, int>;
+
+static bool isBitTable(QModbusDataUnit::RegisterType table)
+{
+    return table == QModbusDataUnit::Coils || table == QModbusDataUnit::DiscreteInputs;
+}
+
+static bool touchesForbidden(const QVector<QPair<int, int>> &forbidden, int from, int to)
+{
+    for (const auto &range : forbidden) {
+        if (range.first < to && range.second >= from) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void planTable(QModbusDataUnit::RegisterType table, QVector<Span> &spans, const ReadPlanOptions &options, QList<QModbusDataUnit> &result)
+{
+    if (spans.isEmpty()) {
+        return;
+    }
+    std::sort(spans.begin(), spans.end());
+    const auto bits = isBitTable(table);
+    const auto maxCount = bits ? qMin(ReadPlanOptions::MaxBits, options.maxRegisters * BITS_PER_REGISTER)
+                               : qMin(ReadPlanOptions::MaxRegisters, options.maxRegisters);
+    const auto maxGap = bits ? options.maxGap * BITS_PER_REGISTER : options.maxGap;
+    const auto forbidden = options.forbidden.value(table);
+    auto start = spans.constFirst().first;
+    auto end = spans.constFirst().second;
+    auto flush = [&]{
+        result.append(QModbusDataUnit{table, start, quint16(end - start)});
+    };
+    // Taking every next span into current request while it fits is optimal:
+    // no other split can end a request further, than greedy one does
+    for (int i = 1; i < spans.size(); ++i) {
+        const auto &next = spans[i];
+        const auto joinedEnd = qMax(end, next.second);
+        const auto fits = next.first - end <= maxGap &&
+                          joinedEnd - start <= maxCount &&
+                          !touchesForbidden(forbidden, end, next.first);
+        if (fits) {
+            end = joinedEnd;
+        } else {
+            flush();
+            start = next.first;
+            end = next.second;
+        }
+    }
+    flush();
+}
+
+QList<QModbusDataUnit> Modbus::planReads(const QList<QModbusDataUnit> &wanted, const ReadPlanOptions &options)
+{
+    static const QModbusDataUnit::RegisterType tables[] = {
+        QModbusDataUnit::HoldingRegisters,
+        QModbusDataUnit::DiscreteInputs,
+        QModbusDataUnit::InputRegisters,
+        QModbusDataUnit::Coils
+    };
+    QHash<QModbusDataUnit::RegisterType, QVector<Span>> spans;
+    for (const auto &unit : wanted) {
+        if (unit.valueCount()) {
+            spans[unit.registerType()].append({unit.startAddress(), unit.startAddress() + int(unit.valueCount())});
+        }
+    }
+    QList<QModbusDataUnit> result;
+    for (auto table : tables) {
+        planTable(table, spans[table], options, result);
+    }
+    return result;
+}
+
+ReadPlanOptions ReadPlanOptions::fromSettings(const Settings::ModbusMaster &settings)
+{
+    ReadPlanOptions result;
+    result.maxGap = settings.max_read_gap;
+    result.maxRegisters = qMax<int>(1, settings.max_read_size);
+    for (const auto &range : settings.forbidden_ranges) {
+        result.forbidden[range.table.value].append({range.from.value, range.to.value});
+    }
+    return result;
+}
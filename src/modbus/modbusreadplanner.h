@@ -0,0 +1,33 @@
+#ifndef MODBUS_READPLANNER_H
+#define MODBUS_READPLANNER_H
+
+#include "private/global.h"
+#include <QModbusDataUnit>
+
+namespace Settings {
+struct ModbusMaster;
+}
+
+namespace Modbus {
+
+struct ReadPlanOptions {
+    //! Protocol limits of one read request (function codes 0x01-0x04)
+    static constexpr int MaxRegisters = 125;
+    static constexpr int MaxBits = 2000;
+    //! Unmapped addresses between two wanted units, that are read anyway to save a request. Bit tables: x16
+    int maxGap{0};
+    //! Registers per request. Bit tables: x16, capped at MaxBits
+    int maxRegisters{MaxRegisters};
+    //! Inclusive [first, last] address ranges, that are never read
+    QHash<QModbusDataUnit::RegisterType, QVector<QPair<int, int>>> forbidden;
+
+    static ReadPlanOptions fromSettings(const Settings::ModbusMaster &settings);
+};
+
+//! Minimal set of read requests, that covers all wanted units (greedy per table, O(n log n)).
+//! Wanted unit is never split between requests. Gaps up to maxGap are bridged, unless they touch forbidden range
+QList<QModbusDataUnit> planReads(const QList<QModbusDataUnit> &wanted, const ReadPlanOptions &options = {});
+
+}
+
+#endif // MODBUS_READPLANNER_H
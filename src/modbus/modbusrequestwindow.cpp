@@ -0,0 +1,45 @@
+#include "modbusrequestwindow.h"
+
+using namespace Modbus;
+
+RequestWindow::RequestWindow(int maxInflight) :
+    m_maxInflight(qMax(1, maxInflight))
+{
+}
+
+int RequestWindow::maxInflight() const
+{
+    return m_maxInflight;
+}
+
+int RequestWindow::inflight() const
+{
+    return m_inflight;
+}
+
+void RequestWindow::startTrigger(int queued)
+{
+    m_budget = queued;
+}
+
+bool RequestWindow::take()
+{
+    if (m_inflight >= m_maxInflight || m_budget <= 0) {
+        return false;
+    }
+    --m_budget;
+    return true;
+}
+
+void RequestWindow::sent()
+{
+    ++m_inflight;
+}
+
+bool RequestWindow::done()
+{
+    if (m_inflight > 0) {
+        --m_inflight;
+    }
+    return !m_inflight;
+}
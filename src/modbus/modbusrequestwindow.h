@@ -0,0 +1,31 @@
+#ifndef MODBUS_REQUESTWINDOW_H
+#define MODBUS_REQUESTWINDOW_H
+
+#include "private/global.h"
+
+namespace Modbus {
+
+//! Requests in flight during channel triggers. Channel is held until all of them are replied
+class RADAPTER_API RequestWindow
+{
+public:
+    explicit RequestWindow(int maxInflight = 1);
+    int maxInflight() const;
+    int inflight() const;
+    //! Budget is what is queued when channel triggers: requests queued later wait for next trigger,
+    //! so one master can not hold shared channel forever
+    void startTrigger(int queued);
+    //! Spends budget on one more request. \return false if window is full or budget is spent
+    bool take();
+    void sent();
+    //! Sent request is replied. \return true if nothing is in flight any more (channel can be released)
+    bool done();
+private:
+    int m_maxInflight;
+    int m_inflight{0};
+    int m_budget{0};
+};
+
+}
+
+#endif // MODBUS_REQUESTWINDOW_H
@@ -7,6 +7,8 @@
 #include <QTimer>
 #include <QThread>
 #include "modbusparsing.h"
+#include "modbusdecodeplan.h"
+#include "jsondict/flatjson.h"
 
 using namespace Modbus;
 using namespace Radapter;
@@ -15,6 +17,7 @@ struct Slave::Private {
     Settings::ModbusSlave settings;
     QTimer *reconnectTimer = nullptr;
     QHash<QModbusDataUnit::RegisterType, QHash<int /*index*/, QString>> reverseRegisters;
+    RegisterDecoder decoder;
     QModbusServer *modbusDevice = nullptr;
     JsonDict state;
     std::atomic<bool> connected{false};
@@ -60,6 +63,7 @@ Slave::Slave(const Settings::ModbusSlave &settings, QThread *thread) :
                                         "; Register: " + QString::number(regIter->index).toStdString() + ")");
         }
         d->reverseRegisters[regIter->table][regIter->index] = regIter.key();
+        d->decoder.add(*regIter, JsonKeys::intern(regIter.key()));
     }
     workerDebug(this) << "Inserting Coils: Start: 0; Count: " << settings.counts.coils;
     regMap.insert(QModbusDataUnit::Coils, {QModbusDataUnit::Coils, 0, settings.counts.coils});
@@ -99,36 +103,15 @@ void Slave::disconnectDevice()
 void Slave::handleNewWords(QVector<quint16> &words, QModbusDataUnit::RegisterType table, int address, int size)
 {
     JsonDict diff;
-    auto wordsData = words.data();
-    for (int i = 0; i < size;) {
-        if (!d->reverseRegisters[table].contains(address + i)) {
-            ++i;
-            continue;
-        }
-        const auto &regString = d->reverseRegisters[table][address + i];
-        const auto &regInfo = d->settings.m_registers[regString];
-        auto sizeWords = QMetaType(regInfo.type).sizeOf()/2;
-        if (i + sizeWords > size) {
-            workerWarn(this) << "Insufficient size of value: " << sizeWords;
-            continue;
-        }
-        auto result = parseModbusType(wordsData + i, regInfo, sizeWords);
-        i += sizeWords;
-        if (result.isValid()) {
-            auto key = regString.split(":");
-            QVariant newValue;
-            if (regInfo.table == QModbusDataUnit::Coils
-                || regInfo.table == QModbusDataUnit::DiscreteInputs) {
-                newValue = result.toUInt() ? true : false;
-            } else {
-                newValue = result;
-            }
-            if (d->state[key] != newValue) {
-                diff[key] = newValue;
-                d->state[key] = newValue;
-            }
-        } else {
-            workerWarn(this) << "Modbus Slave error: Current adress: " << address + i;
+    FlatJson decoded;
+    RegisterDecoder::decode(d->decoder.planFor(table, address, size), words.constData(), decoded);
+    const bool isBit = table == QModbusDataUnit::Coils || table == QModbusDataUnit::DiscreteInputs;
+    for (const auto &entry : decoded) {
+        const auto &key = entry.path();
+        const auto newValue = isBit ? QVariant(entry.value.toUInt() ? true : false) : entry.value;
+        if (d->state[key] != newValue) {
+            diff[key] = newValue;
+            d->state[key] = newValue;
         }
     }
     if (!diff.isEmpty()) {
@@ -186,19 +169,18 @@ void Slave::onStateChanged(QModbusDevice::State state)
 void Slave::onMsg(const Radapter::WorkerMsg &msg)
 {
     QList<QModbusDataUnit> results;
-    for (auto& iter : msg) {
-        auto fullKeyJoined = iter.key().join(":");
-        if (d->settings.m_registers.contains(fullKeyJoined)) {
-            d->state[fullKeyJoined] = iter.value();
-            auto regInfo = d->settings.m_registers.value(fullKeyJoined);
-            auto value = iter.value();
-            if (Q_LIKELY(value.canConvert(QMetaType(regInfo.type)))) {
-                results.append(parseValueToDataUnit(value, regInfo));
-            } else {
-                reWarn() << "Incorrect value type for slave: " << printSelf() << "; Received: " << value << "; Key:" << fullKeyJoined;
-            }
+    msg.json().visit([&](QStringView key, const QVariant &value) {
+        auto regInfo = d->settings.m_registers.constFind(key.toString());
+        if (regInfo == d->settings.m_registers.cend()) {
+            return;
         }
-    }
+        d->state[regInfo.key()] = value;
+        if (Q_LIKELY(value.canConvert(QMetaType(regInfo->type)))) {
+            results.append(parseValueToDataUnit(value, *regInfo));
+        } else {
+            reWarn() << "Incorrect value type for slave: " << printSelf() << "; Received: " << value << "; Key:" << key;
+        }
+    });
     for (auto &item: mergeDataUnits(results)) {
         d->modbusDevice->setData(item);
     }
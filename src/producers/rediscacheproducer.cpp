@@ -1,8 +1,10 @@
 #include "rediscacheproducer.h"
 #include "formatting/redis/rediscachequeries.h"
+#include "formatting/redis/redishashdelta.h"
 #include "async_context/rediscachecontext.h"
 #include "commands/rediscommands.h"
 #include "settings/redissettings.h"
+#include <QTimer>
 
 using namespace Redis;
 using namespace Cache;
@@ -10,9 +12,22 @@ using namespace Radapter;
 
 CacheProducer::CacheProducer(const Settings::RedisCacheProducer &config, QThread *thread) :
     Connector(config, thread),
-    m_objectKey(config.object_hash_key)
+    m_objectKey(config.object_hash_key),
+    m_deltaWrites(config.delta_writes),
+    m_publishChanges(config.publish_changes)
 {
+    if (m_deltaWrites && config.coalesce_ms) {
+        m_coalesceTimer = new QTimer(this);
+        m_coalesceTimer->setSingleShot(true);
+        m_coalesceTimer->setInterval(config.coalesce_ms);
+        m_coalesceTimer->callOnTimeout(this, &CacheProducer::flushDeltas);
+    }
+    if (config.spill.wasUpdated()) {
+        enableSpill(config.spill.value);
+    }
     connect(this, &CacheProducer::disconnected, this, &CacheProducer::onDisconnect);
+    connect(this, &Connector::backpressure, this, &CacheProducer::onBackpressure);
+    connect(this, &Connector::spillReplayed, this, &CacheProducer::publishSpilledChanges);
 }
 
 void CacheProducer::onMsg(const Radapter::WorkerMsg &msg)
@@ -37,10 +52,29 @@ void CacheProducer::onCommand(const Radapter::WorkerMsg &msg)
 
 void CacheProducer::onDisconnect()
 {
+    // Not sent yet: they go to spill, to be written once redis is back
+    if (isSpillEnabled()) {
+        auto pending = std::exchange(m_pending, {});
+        for (auto iter = pending.begin(); iter != pending.end(); ++iter) {
+            sendDelta(iter.key(), iter.value(), true);
+        }
+        m_manager.clearDone();
+    }
+    // Redis could have been restarted/flushed --> next writes are full
+    m_shadow.clear();
+    m_pending.clear();
     m_manager.forEach(&CacheContext::fail, "Disconnected");
     m_manager.clearAll();
 }
 
+void CacheProducer::onBackpressure(bool active)
+{
+    m_paused = active;
+    if (!active) {
+        flushDeltas();
+    }
+}
+
 CacheContext &CacheProducer::getCtx(Handle handle)
 {
     return m_manager.get(handle);
@@ -56,7 +90,7 @@ void CacheProducer::handleCommand(const Radapter::Command *command, Handle handl
     if (hashCmd) {
         writeObject(hashCmd->hash(), hashCmd->flatMap(), handle);
     } else if (objectCmd) {
-        writeObject(objectCmd->hashKey(), objectCmd->object(), handle);
+        writeObject(objectCmd->hashKey(), objectCmd->object(), handle, true);
     } else if (keysCmd) {
         writeKeys(keysCmd->keys(), handle);
     } else if (setCmd) {
@@ -86,16 +120,19 @@ void CacheProducer::msetCallback(redisReply *reply, Handle handle)
     }
 }
 
-void CacheProducer::writeObject(const QString &objectKey, const JsonDict &json, Handle handle)
+void CacheProducer::writeObject(const QString &objectKey, const JsonDict &json, Handle handle, bool replace)
 {
-    QString keys;
-    auto flat = json.flatten();
-    for (auto iter{flat.begin()}; iter != flat.end(); ++iter) {
-        keys.append(QStringLiteral(" %1 %2").arg(iter.key(), iter.value().toString()));
+    if (m_deltaWrites) {
+        writeDelta(objectKey, json, handle, replace);
+        return;
     }
-    auto command = QStringLiteral("HMSET %1 %2").arg(objectKey, keys);
-    if (runAsyncCommand(&CacheProducer::objectWriteCallback, command, handle) != REDIS_OK) {
-        getCtx(handle).fail("Object write error");
+    auto command = toHashSet(objectKey, json);
+    if (isSpilling() || runAsyncCommand(&CacheProducer::objectWriteCallback, command, handle) != REDIS_OK) {
+        if (spill(command) == REDIS_OK) {
+            getCtx(handle).reply(ReplyOk());
+        } else {
+            getCtx(handle).fail("Object write error");
+        }
     }
 }
 
@@ -110,9 +147,129 @@ void CacheProducer::objectWriteCallback(redisReply *reply, Handle handle)
 }
 
 
+void CacheProducer::writeDelta(const QString &key, const JsonDict &json, Handle handle, bool replace)
+{
+    auto &pending = m_pending[key];
+    if (replace) {
+        pending.target = FlatJson(json);
+        pending.replace = true;
+    } else {
+        pending.target.update(FlatJson(json));
+    }
+    pending.handles.append(handle);
+    if (!m_coalesceTimer) {
+        flushDeltas();
+    } else if (!m_coalesceTimer->isActive()) {
+        m_coalesceTimer->start();
+    }
+}
+
+void CacheProducer::flushDeltas()
+{
+    // While window is full, deltas keep coalescing in m_pending
+    if (m_paused) {
+        return;
+    }
+    auto pending = std::exchange(m_pending, {});
+    for (auto iter = pending.begin(); iter != pending.end(); ++iter) {
+        if (m_paused) {
+            m_pending.insert(iter.key(), std::move(iter.value()));
+        } else {
+            sendDelta(iter.key(), iter.value());
+        }
+    }
+}
+
+void CacheProducer::sendDelta(const QString &key, DeltaPending &pending, bool full)
+{
+    auto &shadow = m_shadow[key];
+    HashDelta delta(pending.target, shadow, pending.replace);
+    if (full) {
+        // State in redis is unknown: every field is written (removed ones are still deleted)
+        delta.changed = pending.target;
+    }
+    auto write = new DeltaWrite{key, std::move(pending.handles)};
+    if (m_publishChanges) {
+        write->changes = delta.fieldNames().join('\n');
+    }
+    const auto commands = delta.commands(key);
+    // HSET and HDEL take window slots together, so window can not fill up between them
+    int sent = 0;
+    if (!commands.isEmpty() && !isSpilling() && isConnected()) {
+        for (const auto &command : commands) {
+            pipelineCommand(&CacheProducer::deltaCallback, command, write);
+        }
+        flushPipeline(false, &sent);
+        write->commandsLeft += sent;
+    }
+    for (auto i = sent; i < commands.size(); ++i) {
+        if (spill(commands[i]) == REDIS_OK) {
+            write->spilled = true;
+        } else {
+            write->failed = true;
+        }
+    }
+    // Shadow is moved forward at once, so next writes diff against what is being written
+    if (pending.replace) {
+        shadow = std::move(pending.target);
+    } else {
+        shadow.update(delta.changed);
+    }
+    if (!write->commandsLeft) {
+        deltaCallback(nullptr, write);
+    }
+}
+
+void CacheProducer::deltaCallback(redisReply *reply, DeltaWrite *write)
+{
+    if (write->commandsLeft) {
+        write->commandsLeft--;
+        if (!reply || reply->type == ReplyError) {
+            workerError(this) << "Delta write to" << write->key << "failed:" << parseReply(reply);
+            write->failed = true;
+        }
+    }
+    if (write->commandsLeft) {
+        return;
+    }
+    if (write->failed) {
+        // Unknown state in redis --> next write to this hash is full
+        m_shadow.remove(write->key);
+    }
+    // Sent after the write is replied, so readers never fetch fields before they are written.
+    // Spilled writes are not in redis yet: they are announced after spill is replayed
+    if (!write->changes.isEmpty()) {
+        if (write->spilled) {
+            auto &names = m_spilledChanges[write->key];
+            for (const auto &name : write->changes.split('\n')) {
+                names.insert(name);
+            }
+        } else {
+            runAsyncCommand(CommandArgs{"PUBLISH"} << changesChannel(write->key) << write->changes);
+        }
+    }
+    for (auto handle : qAsConst(write->handles)) {
+        if (write->failed) {
+            getCtx(handle).fail("Delta write fail");
+        } else {
+            getCtx(handle).reply(ReplyOk());
+        }
+    }
+    delete write;
+}
+
+void CacheProducer::publishSpilledChanges()
+{
+    const auto spilled = std::exchange(m_spilledChanges, {});
+    for (auto iter = spilled.cbegin(); iter != spilled.cend(); ++iter) {
+        const QStringList names(iter->cbegin(), iter->cend());
+        runAsyncCommand(CommandArgs{"PUBLISH"} << changesChannel(iter.key()) << names.join('\n'));
+    }
+}
+
 void CacheProducer::writeSet(const QString &set, const QStringList &keys, Handle handle)
 {
-    auto sadd = QStringLiteral("SADD %1 %2").arg(set, keys.join(" "));
+    auto sadd = toUpdateSet(set, keys);
     if (runAsyncCommand(&CacheProducer::writeSetCallback, sadd, handle) != REDIS_OK) {
         getCtx(handle).fail("Set update error");
     }
@@ -130,7 +287,7 @@ void CacheProducer::writeSetCallback(redisReply *reply, Handle handle)
 
 void CacheProducer::del(const QString &target, Handle handle)
 {
-    auto delCmd = QStringLiteral("DEL %1").arg(target);
+    auto delCmd = CommandArgs{"DEL"}.appendKey(target);
     if (runAsyncCommand(&CacheProducer::delCallback, delCmd, handle) != REDIS_OK) {
         getCtx(handle).fail("Delete error");
     }
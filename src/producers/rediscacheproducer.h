@@ -3,6 +3,8 @@
 
 #include "connectors/redisconnector.h"
 #include "async_context/rediscachecontext.h"
+#include "jsondict/flatjson.h"
+#include <QSet>
 
 namespace Settings {
 struct RedisCacheProducer;
@@ -22,6 +24,10 @@ public slots:
     void onCommand(const Radapter::WorkerMsg &msg) override;
 private slots:
     void onDisconnect();
+    void flushDeltas();
+    //! Window full --> delta writes are held (and coalesced) until it drains
+    void onBackpressure(bool active);
+    void publishSpilledChanges();
 protected:
     CacheContext &getCtx(Handle handle);
 private:
@@ -30,9 +36,30 @@ private:
     void writeKeys(const QVariantMap &keys, Handle handle);
     void msetCallback(redisReply *replyPtr, Handle handle);
 
-    void writeObject(const QString &indexKey, const JsonDict &json, Handle handle);
+    void writeObject(const QString &indexKey, const JsonDict &json, Handle handle, bool replace = false);
     void objectWriteCallback(redisReply *reply, Handle handle);
 
+    struct DeltaPending {
+        FlatJson target;
+        //! Fields missing in target are deleted (WriteObject), otherwise merged (plain msgs, WriteHash)
+        bool replace{false};
+        QList<Handle> handles;
+    };
+    struct DeltaWrite {
+        QString key;
+        QList<Handle> handles;
+        int commandsLeft{0};
+        bool failed{false};
+        //! Some of commands went to spill: changes are published after replay
+        bool spilled{false};
+        //! publish_changes: written field names, '\n'-separated
+        QString changes;
+    };
+    void writeDelta(const QString &key, const JsonDict &json, Handle handle, bool replace);
+    //! \param full write all fields of target, not only the ones that differ from shadow
+    void sendDelta(const QString &key, DeltaPending &pending, bool full = false);
+    void deltaCallback(redisReply *reply, DeltaWrite *write);
+
     void writeSet(const QString& set, const QStringList &keys, Handle handle);
     void writeSetCallback(redisReply *reply, Handle handle);
 
@@ -41,6 +68,15 @@ private:
 
 
     QString m_objectKey;
+    bool m_deltaWrites;
+    bool m_publishChanges;
+    bool m_paused{false};
+    QTimer *m_coalesceTimer{nullptr};
+    //! Last written (or being written) state of hashes
+    QHash<QString, FlatJson> m_shadow;
+    QHash<QString, DeltaPending> m_pending;
+    //! publish_changes: fields of spilled writes, per hash. Published, when spill is replayed
+    QHash<QString, QSet<QString>> m_spilledChanges;
     friend CacheContext;
     Radapter::ContextManager<CacheContext> m_manager;
 };
@@ -9,21 +9,43 @@
 
 #define TRIM_TIMEOUT_MS     60000
 #define ADDS_COUNT_TO_TRIM  1000u
+// Buffered while in-flight window is full, then spilled (or failed)
+#define MAX_PAUSED_MSGS     10000
 
 using namespace Redis;
 
+struct Redis::StreamBatch {
+    QList<Radapter::WorkerMsg> msgs;
+};
+
 StreamProducer::StreamProducer(const Settings::RedisStreamProducer &config, QThread *thread)
     : Connector(config, thread),
       m_trimTimer(nullptr),
+      m_batchTimer(nullptr),
       m_addCounter{},
       m_streamKey(config.stream_key),
-      m_streamSize(config.stream_size)
+      m_streamSize(config.stream_size),
+      m_maxBatch(qMax(1u, config.max_batch.value))
 {
     m_trimTimer = new QTimer(this);
     m_trimTimer->setInterval(TRIM_TIMEOUT_MS);
     m_trimTimer->setSingleShot(false);
     m_trimTimer->callOnTimeout(this, &StreamProducer::tryTrim);
-    m_trimTimer->start();
+    if (isBatching()) {
+        // trim is sent inside of every batch
+        m_batchTimer = new QTimer(this);
+        m_batchTimer->setSingleShot(true);
+        m_batchTimer->setTimerType(Qt::PreciseTimer);
+        m_batchTimer->setInterval((config.max_delay_us + 999) / 1000);
+        m_batchTimer->callOnTimeout(this, &StreamProducer::flushBatch);
+        m_batch.reserve(m_maxBatch);
+    } else {
+        m_trimTimer->start();
+    }
+    if (config.spill.wasUpdated()) {
+        enableSpill(config.spill.value);
+    }
+    connect(this, &Connector::backpressure, this, &StreamProducer::onBackpressure);
 }
 
 StreamProducer::~StreamProducer()
@@ -44,21 +66,155 @@ quint32 StreamProducer::streamSize() const
     return m_streamSize;
 }
 
+bool StreamProducer::isBatching() const
+{
+    return m_maxBatch > 1;
+}
+
 void StreamProducer::onMsg(const Radapter::WorkerMsg &msg)
 {
     if (msg.isEmpty()) {
         return;
     }
-    auto command = addToStream(m_streamKey, msg, streamSize());
-    if (!command.isEmpty()) {
-        if (runAsyncCommand(&StreamProducer::writeCallback, command) != REDIS_OK) {
-            auto reply = prepareReply(msg, new Radapter::ReplyFail);
-            emit sendMsg(reply);
+    if (isBatching()) {
+        m_batch.append(msg);
+        if (m_paused) {
+            checkPausedLimit();
+        } else if (quint32(m_batch.size()) >= m_maxBatch) {
+            flushBatch();
+        } else if (!m_batchTimer->isActive()) {
+            m_batchTimer->start();
+        }
+        return;
+    }
+    // Spilled messages are older than buffered, so spill goes first
+    if (m_paused && !isSpilling()) {
+        m_batch.append(msg);
+        checkPausedLimit();
+        return;
+    }
+    addToStream(m_command, m_streamKey, msg, streamSize());
+    if (!m_command.isEmpty()) {
+        if (isSpilling() || runAsyncCommand(&StreamProducer::writeCallback, m_command) != REDIS_OK) {
+            if (spill(m_command) != REDIS_OK) {
+                auto reply = prepareReply(msg, new Radapter::ReplyFail);
+                emit sendMsg(reply);
+            }
         }
         m_addCounter++;
     }
 }
 
+void StreamProducer::flushBatch()
+{
+    m_batchTimer->stop();
+    if (m_batch.isEmpty()) {
+        return;
+    }
+    if (isSpilling() || !isConnected()) {
+        spillOrFail(m_batch);
+        m_batch.clear();
+        return;
+    }
+    if (m_paused) {
+        // Sent once window is drained
+        return;
+    }
+    auto batch = new StreamBatch;
+    batch->msgs.reserve(m_batch.size());
+    pipelineCommand(CommandArgs{"MULTI"});
+    for (auto &msg : m_batch) {
+        addToStream(m_command, m_streamKey, msg, 0u);
+        if (!m_command.isEmpty()) {
+            pipelineCommand(m_command);
+            batch->msgs.append(std::move(msg));
+        }
+    }
+    m_batch.clear();
+    if (streamSize()) {
+        pipelineCommand(trimStream(m_streamKey, streamSize()));
+    }
+    pipelineCommand(&StreamProducer::batchCallback, CommandArgs{"EXEC"}, batch);
+    const auto queued = pipelinedCount();
+    int sent = 0;
+    if (flushPipeline(false, &sent) != REDIS_OK) {
+        workerError(this) << "Could not send batch of:" << batch->msgs.size();
+        // EXEC is last: if it was sent, batchCallback owns the batch. Otherwise sent part was discarded
+        if (sent < queued) {
+            spillOrFail(batch->msgs);
+            delete batch;
+        }
+    }
+}
+
+void StreamProducer::onBackpressure(bool active)
+{
+    m_paused = active;
+    if (active) {
+        return;
+    }
+    if (isBatching()) {
+        flushBatch();
+        return;
+    }
+    // Goes through onMsg(), so if window fills up again, rest is buffered again in same order
+    const auto paused = std::exchange(m_batch, {});
+    for (const auto &msg : paused) {
+        onMsg(msg);
+    }
+}
+
+void StreamProducer::checkPausedLimit()
+{
+    if (m_batch.size() < MAX_PAUSED_MSGS) {
+        return;
+    }
+    workerWarn(this) << "In-flight window is full for too long, spilling" << m_batch.size() << "messages";
+    spillOrFail(m_batch);
+    m_batch.clear();
+}
+
+void StreamProducer::batchCallback(redisReply *reply, StreamBatch *batch)
+{
+    if (!reply) {
+        // Disconnected before EXEC reply, batch could be written or not
+        spillOrFail(batch->msgs);
+    } else if (reply->type != ReplyArray) {
+        workerError(this) << "Batch of" << batch->msgs.size() << "failed:" << parseReply(reply);
+        failMsgs(batch->msgs);
+    } else {
+        QList<Radapter::WorkerMsg> failed;
+        for (int i = 0; i < batch->msgs.size() && size_t(i) < reply->elements; ++i) {
+            if (reply->element[i]->type == ReplyError) {
+                workerError(this) << "XADD failed:" << reply->element[i]->str;
+                failed.append(batch->msgs[i]);
+            }
+        }
+        failMsgs(failed);
+    }
+    delete batch;
+}
+
+void StreamProducer::failMsgs(const QList<Radapter::WorkerMsg> &msgs)
+{
+    for (const auto &msg : msgs) {
+        emit sendMsg(prepareReply(msg, new Radapter::ReplyFail));
+    }
+}
+
+void StreamProducer::spillOrFail(const QList<Radapter::WorkerMsg> &msgs)
+{
+    QList<Radapter::WorkerMsg> failed;
+    for (const auto &msg : msgs) {
+        // Batch trim is not spilled, every XADD carries MAXLEN instead
+        addToStream(m_command, m_streamKey, msg, streamSize());
+        if (!m_command.isEmpty() && spill(m_command) != REDIS_OK) {
+            failed.append(msg);
+        }
+    }
+    failMsgs(failed);
+}
+
 void StreamProducer::tryTrim()
 {
     if (m_addCounter >= ADDS_COUNT_TO_TRIM) {
@@ -8,6 +8,7 @@ struct RedisStreamProducer;
 }
 namespace Redis {
 class RADAPTER_API StreamProducer;
+struct StreamBatch;
 }
 
 class Redis::StreamProducer : public Connector
@@ -19,21 +20,36 @@ public:
 
     QString streamKey() const;
     quint32 streamSize() const;
+    bool isBatching() const;
 
 public slots:
     void onMsg(const Radapter::WorkerMsg &msg) override;
 
 private slots:
     void tryTrim();
+    void flushBatch();
+    //! Window full --> messages are buffered (in m_batch) instead of being rejected
+    void onBackpressure(bool active);
 
 private:
     void writeCallback(redisReply *replyPtr);
     void trimCallback(redisReply *replyPtr);
+    void batchCallback(redisReply *replyPtr, StreamBatch *batch);
+    void failMsgs(const QList<Radapter::WorkerMsg> &msgs);
+    //! Spill is not enabled or full --> ReplyFail
+    void spillOrFail(const QList<Radapter::WorkerMsg> &msgs);
+    //! Too many buffered while paused --> they are spilled
+    void checkPausedLimit();
 
     QTimer* m_trimTimer;
+    QTimer* m_batchTimer;
     quint16 m_addCounter;
     QString m_streamKey;
     quint32 m_streamSize;
+    quint32 m_maxBatch;
+    bool m_paused{false};
+    CommandArgs m_command;
+    QList<Radapter::WorkerMsg> m_batch;
 };
 
 #endif // REDISSTREAMPRODUCER_H
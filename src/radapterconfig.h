@@ -60,6 +60,7 @@ struct Stream : public Serializable {
     Q_GADGET
     IS_SERIALIZABLE
     FIELD(OptionalSequence<RedisStreamConsumer>, consumers)
+    FIELD(OptionalSequence<RedisStreamGroupConsumer>, group_consumers)
     FIELD(OptionalSequence<RedisStreamProducer>, producers)
 };
 struct Cache : public Serializable {
@@ -128,6 +129,7 @@ struct AppConfig : public Serializable {
     FIELD(OptionalSequence<QString>, pipelines)
     COMMENT(pipelines, "Example: 'worker.name > *interceptor > worker.2.name'")
     FIELD(HasDefault<RadapterApi>, api)
+    FIELD(HasDefault<LocalStorageInfo>, local_storage)
     void postUpdate() override;
 };
 }
@@ -56,6 +56,8 @@ namespace Settings {
         FIELD(HasDefault<bool>, readable, true)
         FIELD(Optional<QString>, mode)
         COMMENT(mode, "Allowed: r / w / rw (read, write, read+write)")
+        FIELD(HasDefault<quint32>, poll_rate, 0)
+        COMMENT(poll_rate, "Poll interval of this register (ms), registers with same interval are polled as one group. 0 --> poll_rate of master")
         FIELD(OptionalValidator, validator)
         void postUpdate() override;
     };
@@ -89,13 +91,30 @@ namespace Settings {
         void init();
     };
 
+    struct RADAPTER_API AddressRange : Serializable {
+        Q_GADGET
+        IS_SERIALIZABLE
+        FIELD(VALIDATED(Required<QModbusDataUnit::RegisterType>, Validator::RegisterTable), table)
+        FIELD(Required<quint16>, from)
+        FIELD(Required<quint16>, to)
+        COMMENT(to, "Inclusive")
+    };
+
     struct RADAPTER_API ModbusMaster : ModbusWorker {
         Q_GADGET
         IS_SERIALIZABLE
         FIELD(HasDefault<quint32>, poll_rate, 500)
-        COMMENT(poll_rate, "Poll rate is the time between two full updates")
+        COMMENT(poll_rate, "Poll rate is the time between two full updates (default for registers without own poll_rate)")
         FIELD(HasDefault<quint32>, response_time, 150)
         FIELD(HasDefault<quint32>, retries, 3)
+        FIELD(HasDefault<quint16>, max_read_gap, 0)
+        COMMENT(max_read_gap, "Unmapped registers between two mapped ones, that are read anyway to save a request (coils/di: x16)")
+        FIELD(HasDefault<quint16>, max_read_size, 125)
+        COMMENT(max_read_size, "Max registers per read request. Lower it for devices, that reject long reads (coils/di: x16, up to 2000)")
+        FIELD(OptionalSequence<AddressRange>, forbidden_ranges)
+        COMMENT(forbidden_ranges, "Addresses, that are never read (not even to bridge a gap)")
+        FIELD(HasDefault<quint16>, max_inflight, 1)
+        COMMENT(max_inflight, "Modbus TCP: requests sent without waiting for replies (matched by transaction id). RTU: always 1")
 
         FIELD(Optional<QString>, state_writer)
         FIELD(Optional<QString>, state_reader)
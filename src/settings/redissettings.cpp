@@ -24,6 +24,25 @@ Q_GLOBAL_STATIC(QStringMap<RedisServer>, cacheMap)
 
 void RedisConnector::postUpdate() {
     server = cacheMap->value(server_name);
+    shards.clear();
+    for (const auto &name : shard_servers) {
+        if (!cacheMap->contains(name)) {
+            throw std::runtime_error("Redis shard server not found: " + name.toStdString());
+        }
+        shards.append(cacheMap->value(name));
+    }
+}
+
+void RedisCacheConsumer::postUpdate() {
+    RedisConnector::postUpdate();
+    if (client_tracking) {
+        // Invalidations come only to connection, which did the read: everything goes through one
+        if (cluster || !shards.isEmpty()) {
+            throw std::runtime_error("client_tracking is not supported with cluster or shard_servers: " + worker->name.value.toStdString());
+        }
+        protocol = 3;
+        pool_size = 1;
+    }
 }
 
 void RedisServer::postUpdate() {
@@ -9,6 +9,8 @@ namespace Settings {
         Q_GADGET
         IS_SETTING
         FIELD(Required<QString>, name)
+        FIELD(HasDefault<QString>, unix_socket)
+        COMMENT(unix_socket, "Path to redis unix socket (same host only). Not empty --> used instead of host:port")
 
         void postUpdate() override;
     };
@@ -24,8 +26,19 @@ namespace Settings {
         FIELD(HasDefault<quint16>, max_command_errors, 3)
         FIELD(HasDefault<quint16>, tcp_timeout, 1000)
         FIELD(HasDefault<quint16>, command_timeout, 150)
+        FIELD(HasDefault<quint16>, protocol, 2)
+        COMMENT(protocol, "RESP version. 3 --> HELLO 3 on connect (native maps, push messages)")
+        FIELD(HasDefault<quint16>, pool_size, 1)
+        COMMENT(pool_size, "Connections per server. Commands are spread by key, order per key is kept")
+        FIELD(OptionalSequence<QString>, shard_servers)
+        COMMENT(shard_servers, "Extra servers: keys are split between them and server_name by consistent hash")
+        FIELD(HasDefault<bool>, cluster, false)
+        COMMENT(cluster, "Redis Cluster: server_name/shard_servers are seed nodes, keys are routed by CLUSTER SLOTS")
+        FIELD(HasDefault<quint32>, max_in_flight, 0u)
+        COMMENT(max_in_flight, "Max commands waiting for reply. When reached, new commands fail fast (backpressure). 0 --> unlimited")
 
         RedisServer server;
+        QList<RedisServer> shards;
         void postUpdate() override;
     };
 
@@ -33,6 +46,11 @@ namespace Settings {
         Q_GADGET
         IS_SETTING
         FIELD(RequiredSequence<QString>, keyEvents)
+        COMMENT(keyEvents, "Channel patterns, e.g. __keyevent@0__:set, __keyspace@0__:sensors:*")
+        FIELD(HasDefault<quint32>, coalesce_ms, 0u)
+        COMMENT(coalesce_ms, "Events within this window are sent as one message, one entry per key. 0 --> sent when event loop is idle")
+        FIELD(HasDefault<quint32>, max_batch, 1000u)
+        COMMENT(max_batch, "Max keys per message, full batch is sent at once")
     };
 
     struct RADAPTER_API RedisStreamBase : RedisConnector {
@@ -54,16 +72,42 @@ namespace Settings {
         Q_GADGET
         IS_SETTING
         FIELD(VALIDATED(HasDefault<StartMode>, RedisStreamConsumer), start_from, StartPersistentId)
+        FIELD(OptionalSequence<QString>, extra_streams)
+        COMMENT(extra_streams, "More streams, read by the same XREAD on one connection (not in group mode, not sharded)")
+        FIELD(HasDefault<bool>, send_batches, false)
+        COMMENT(send_batches, "Entries of one read are sent as one message {<stream>: [entries]}, otherwise one message per entry")
     };
     struct RADAPTER_API RedisStreamGroupConsumer : RedisStreamConsumer {
         Q_GADGET
         IS_SETTING
         FIELD(Required<QString>, consumer_group_name)
+        COMMENT(consumer_group_name, "Entries are acked once handed to broker: delivery is at-most-once (lost, if process dies before receivers handle them)")
+        FIELD(HasDefault<QString>, consumer_name)
+        COMMENT(consumer_name, "Name of consumer inside of group. Empty --> worker name")
         FIELD(HasDefault<bool>, start_from_last_unread, true)
+        COMMENT(start_from_last_unread, "Created group starts from new entries ($), otherwise from first (0)")
+        FIELD(HasDefault<quint32>, claim_min_idle_ms, 60000u)
+        COMMENT(claim_min_idle_ms, "Pending entries of dead consumers idle for this long are claimed on startup")
     };
+    struct RADAPTER_API RedisSpill : Serializable {
+        Q_GADGET
+        IS_SERIALIZABLE
+        FIELD(Required<QString>, file)
+        COMMENT(file, "Writes redis can not take (disconnected, max_in_flight reached) go here. Relative --> inside of local storage dir")
+        FIELD(HasDefault<quint32>, max_mb, 64u)
+        COMMENT(max_mb, "When file is full, new writes fail")
+        FIELD(HasDefault<quint32>, replay_rate, 5000u)
+        COMMENT(replay_rate, "Spilled commands sent per second after reconnect")
+    };
+
     struct RADAPTER_API RedisStreamProducer : RedisStreamBase {
         Q_GADGET
         IS_SETTING
+        FIELD(HasDefault<quint32>, max_batch, 1u)
+        COMMENT(max_batch, "Messages per one MULTI/EXEC write (XADDs + MAXLEN trim). 1 --> no batching")
+        FIELD(HasDefault<quint32>, max_delay_us, 0u)
+        COMMENT(max_delay_us, "Max time for a message to wait for batch to fill. 0 --> flush when event loop is idle")
+        FIELD(Optional<RedisSpill>, spill)
     };
 
     struct RADAPTER_API RedisCacheConsumer : RedisConnector {
@@ -72,12 +116,25 @@ namespace Settings {
         FIELD(Optional<QString>, object_hash_key)
         FIELD(HasDefault<bool>, use_polling, true)
         FIELD(HasDefault<quint32>, update_rate, 600)
+        FIELD(HasDefault<bool>, client_tracking, false)
+        COMMENT(client_tracking, "Serve repeated ReadObject/ReadKey from local cache until redis invalidates them (forces protocol: 3, pool_size: 1; not with cluster/shard_servers)")
+        FIELD(HasDefault<bool>, incremental, false)
+        COMMENT(incremental, "Without polling: only fields named in '<object_hash_key>:changes' are read (HMGET) and sent, deleted fields are sent as null. Needs producer with publish_changes")
+
+        void postUpdate() override;
     };
 
     struct RADAPTER_API RedisCacheProducer : RedisConnector {
         Q_GADGET
         IS_SETTING
         FIELD(Optional<QString>, object_hash_key)
+        FIELD(HasDefault<bool>, delta_writes, false)
+        COMMENT(delta_writes, "Objects are written as HSET of changed fields only (+ HDEL of fields missing in WriteObject)")
+        FIELD(HasDefault<quint32>, coalesce_ms, 0u)
+        COMMENT(coalesce_ms, "Delta writes: writes to same hash within this window are merged into one. 0 --> write at once")
+        FIELD(HasDefault<bool>, publish_changes, false)
+        COMMENT(publish_changes, "Delta writes: names of written fields are published to '<hash>:changes' (for incremental consumers)")
+        FIELD(Optional<RedisSpill>, spill)
     };
 }
 
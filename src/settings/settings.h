@@ -95,6 +95,15 @@ struct RADAPTER_API LocalizationInfo : Serializable {
     FIELD(RequiredTimeZone, time_zone)
 };
 
+struct RADAPTER_API LocalStorageInfo : Serializable {
+    Q_GADGET
+    IS_SERIALIZABLE
+    FIELD(HasDefault<quint32>, commit_interval_ms, 1000u)
+    COMMENT(commit_interval_ms, "Checkpoints are appended to log and fsync-ed once per interval. 0 --> on every change")
+    FIELD(HasDefault<quint32>, compact_after, 10000u)
+    COMMENT(compact_after, "Checkpoint log is rewritten with latest values after this many appended records")
+};
+
 struct RADAPTER_API WebsocketServer : Serializable {
     Q_GADGET
     IS_SERIALIZABLE
@@ -1,48 +1,78 @@
 #include "channel.h"
 #include "radapterlogging.h"
-#include "templates/algorithms.hpp"
 #include <stdexcept>
 #include <QSet>
 #include <QMutex>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QVariant>
+
+#define DEFAULT_PERIOD_MS 1000
+// Utilization is reported for last full window + current one
+#define UTILIZATION_WINDOW_MS 10000
+#define NS_IN_MS 1000000
 
 using namespace Radapter::Sync;
 
-static quint64 getTimeMS()
+// Upper bounds of queueing delay histogram buckets, last bucket is everything above
+static constexpr quint32 delayBucketsMs[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+static constexpr int delayBucketsCount = sizeof(delayBucketsMs) / sizeof(delayBucketsMs[0]) + 1;
+
+static qint64 withPriority(qint64 periodNs, Channel::Priority priority)
 {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    switch (priority) {
+    case Channel::NormalPriority: return periodNs;
+    case Channel::LowPriority: return periodNs * 2;
+    case Channel::HighPriority: return periodNs / 2;
+    default: throw std::invalid_argument("Invalid priority for channel user!");
+    }
 }
 
-struct Channel::Private {
-    struct UserState {
-        QObject *user;
-        Priority priority;
-        bool waitingForTrigger;
+struct Channel::UserState {
+    QObject *user;
+    Priority priority;
+    //! Time from ask to deadline, for asks without own deadline
+    qint64 periodNs;
+    bool waiting{false};
+    qint64 askedAt{0};
+    qint64 deadline{0};
+    //! Deadline, pulled in every time user was passed over (aging)
+    qint64 agedDeadline{0};
+};
 
-        bool isWaiting() const {
-            return waitingForTrigger;
-        }
-        Priority whatPrio() const {
-            return priority;
-        }
-    };
+struct Channel::Private {
     QHash<QObject*, UserState> userStates;
     std::atomic<QObject*> busy{nullptr};
-    QObject *lastBusy{nullptr};
     QTimer *debug;
     QTimer *frameTimer;
-    QMutex mutex;
-    quint32 frameGap;
-    quint64 lastFrame;
+    QElapsedTimer clock;
+    qint64 frameGapNs;
+    qint64 agingStepNs;
+    qint64 lastFrameEnd;
+    qint64 activatedAt{0};
+
+    //! Guards stats, they are read from other threads
+    mutable QMutex mutex;
+    quint64 delayHistogram[delayBucketsCount]{};
+    quint64 totalJobs{0};
+    quint64 missedDeadlines{0};
+    qint64 maxDelayNs{0};
+    qint64 windowStart{0};
+    qint64 windowBusyNs{0};
+    qint64 prevWindowNs{0};
+    qint64 prevWindowBusyNs{0};
 };
 
 Channel::Channel(QThread *thread, quint32 frameGap) :
     d(new Private)
 {
-    d->frameGap = frameGap;
-    d->lastFrame = getTimeMS();
+    d->clock.start();
+    d->frameGapNs = qint64(frameGap) * NS_IN_MS;
+    d->agingStepNs = qMax<qint64>(d->frameGapNs, NS_IN_MS);
+    d->lastFrameEnd = -d->frameGapNs;
     d->frameTimer = new QTimer(this);
     d->frameTimer->setSingleShot(true);
+    d->frameTimer->setTimerType(Qt::PreciseTimer);
     d->frameTimer->callOnTimeout(this, &Channel::chooseNext);
     d->debug = new QTimer(this);
     d->debug->setInterval(1000);
@@ -62,20 +92,21 @@ QObject *Channel::whoIsBusy() const
     return const_cast<QObject*>(d->busy.load());
 }
 
-void Channel::registerUser(QObject *user, Priority priority)
+void Channel::registerUser(QObject *user, Priority priority, quint32 periodMs)
 {
-    QMutexLocker lock(&d->mutex);
-    if (priority != NormalPriority &&
-            priority != LowPriority &&
-            priority != HighPriority) {
-        throw std::invalid_argument("Invalid priority for channel user!");
-    }
-    d->userStates[user] = {user, priority, false,};
+    const auto periodNs = withPriority(qint64(periodMs ? periodMs : DEFAULT_PERIOD_MS) * NS_IN_MS, priority);
+    // userStates are only touched in channel's thread, which could already be serving other users.
+    // Queued before any askTrigger() of this user, so it is never seen unregistered
+    QMetaObject::invokeMethod(this, [this, user, priority, periodNs]{
+        d->userStates[user] = UserState{user, priority, periodNs};
+    }, Qt::AutoConnection);
     connect(user, &QObject::destroyed, this, [this](QObject *obj){
+        d->userStates.remove(obj);
         if (d->busy == obj) {
             d->busy = nullptr;
+            d->lastFrameEnd = d->clock.nsecsElapsed();
+            chooseNext();
         }
-        d->userStates.remove(obj);
     });
 }
 
@@ -86,46 +117,129 @@ bool Channel::isBusy() const
 
 void Channel::onJobDone()
 {
+    // Late signal of user, that already lost the bus (destroyed or was never triggered)
+    if (!d->busy || sender() != d->busy) {
+        return;
+    }
     d->debug->stop();
-    d->lastBusy = d->busy.load();
+    const auto now = d->clock.nsecsElapsed();
     d->busy = nullptr;
+    d->lastFrameEnd = now;
+    {
+        QMutexLocker lock(&d->mutex);
+        d->windowBusyNs += now - d->activatedAt;
+        if (now - d->windowStart >= qint64(UTILIZATION_WINDOW_MS) * NS_IN_MS) {
+            d->prevWindowNs = now - d->windowStart;
+            d->prevWindowBusyNs = d->windowBusyNs;
+            d->windowStart = now;
+            d->windowBusyNs = 0;
+        }
+    }
     chooseNext();
 }
 
 void Channel::askTrigger()
 {
-    auto checked = sender();
-    d->userStates[checked].waitingForTrigger = true;
+    request(sender(), 0);
+}
+
+void Channel::askTriggerWithin(quint32 deadlineMs)
+{
+    request(sender(), qint64(deadlineMs) * NS_IN_MS);
+}
+
+void Channel::request(QObject *user, qint64 periodNs)
+{
+    auto state = d->userStates.find(user);
+    if (state == d->userStates.end()) {
+        reWarn() << this << "Trigger asked by unregistered user:" << user;
+        return;
+    }
+    const auto now = d->clock.nsecsElapsed();
+    const auto deadline = now + (periodNs ? withPriority(periodNs, state->priority) : state->periodNs);
+    if (!state->waiting) {
+        state->waiting = true;
+        state->askedAt = now;
+        state->deadline = deadline;
+        state->agedDeadline = deadline;
+    } else if (deadline < state->deadline) {
+        // Repeated asks keep earliest deadline (aging already gained is kept too)
+        state->agedDeadline -= state->deadline - deadline;
+        state->deadline = deadline;
+    }
     chooseNext();
 }
 
 void Channel::chooseNext()
 {
     if (isBusy()) return;
-    auto passed = getTimeMS() - d->lastFrame;
-    qint64 toWait = d->frameGap - passed;
+    const auto toWait = d->frameGapNs - (d->clock.nsecsElapsed() - d->lastFrameEnd);
     if (toWait > 0) {
-        d->frameTimer->start(toWait);
+        d->frameTimer->start(int((toWait + NS_IN_MS - 1) / NS_IN_MS));
         return;
     }
-    auto allWaiting = filter(d->userStates, &Private::UserState::isWaiting);
-    auto size = allWaiting.size();
-    if (size > 1) {
-        auto filterIgnored = as_function([this](const Private::UserState &state){
-            return state.user != d->lastBusy;
-        });
-        auto max = max_element(filter(allWaiting, filterIgnored), &Private::UserState::whatPrio);
-        activate(max.result->user);
-    } else if (size) {
-        activate(allWaiting.begin()->user);
+    UserState *next = nullptr;
+    for (auto &state : d->userStates) {
+        if (!state.waiting) continue;
+        if (!next || state.agedDeadline < next->agedDeadline ||
+            (state.agedDeadline == next->agedDeadline && state.askedAt < next->askedAt)) {
+            next = &state;
+        }
     }
-    d->lastFrame = getTimeMS();
+    if (!next) return;
+    for (auto &state : d->userStates) {
+        if (state.waiting && &state != next) {
+            state.agedDeadline -= d->agingStepNs;
+        }
+    }
+    activate(*next);
 }
 
-void Channel::activate(QObject *who)
+void Channel::activate(UserState &state)
 {
+    const auto now = d->clock.nsecsElapsed();
+    const auto delay = now - state.askedAt;
+    {
+        QMutexLocker lock(&d->mutex);
+        int bucket = 0;
+        while (bucket < delayBucketsCount - 1 && delay > qint64(delayBucketsMs[bucket]) * NS_IN_MS) {
+            ++bucket;
+        }
+        ++d->delayHistogram[bucket];
+        ++d->totalJobs;
+        if (now > state.deadline) {
+            ++d->missedDeadlines;
+        }
+        d->maxDelayNs = qMax(d->maxDelayNs, delay);
+        d->activatedAt = now;
+    }
     d->debug->start();
-    d->userStates[who].waitingForTrigger = false;
-    d->busy = who;
-    emit trigger(who, QPrivateSignal{});
+    state.waiting = false;
+    d->busy = state.user;
+    emit trigger(state.user, QPrivateSignal{});
+}
+
+QVariantMap Channel::stats() const
+{
+    QMutexLocker lock(&d->mutex);
+    const auto now = d->clock.nsecsElapsed();
+    auto busyNs = d->prevWindowBusyNs + d->windowBusyNs;
+    if (d->busy) {
+        busyNs += now - d->activatedAt;
+    }
+    const auto windowNs = d->prevWindowNs + now - d->windowStart;
+    QVariantList bounds, counts;
+    for (auto bound : delayBucketsMs) {
+        bounds.append(bound);
+    }
+    for (auto count : d->delayHistogram) {
+        counts.append(count);
+    }
+    return {
+        {"utilization", windowNs ? double(busyNs) / double(windowNs) : 0.},
+        {"total_jobs", d->totalJobs},
+        {"missed_deadlines", d->missedDeadlines},
+        {"max_queue_delay_ms", double(d->maxDelayNs) / NS_IN_MS},
+        {"queue_delay_ms", QVariantMap{{"bounds", bounds}, {"counts", counts}}},
+    };
 }
@@ -17,10 +17,14 @@ public:
     };
     Channel(QThread *thread, quint32 frameGap);
     ~Channel();
-    //! \warning not threadsafe
-    void registerUser(QObject *user, Priority priority = NormalPriority);
+    //! Users are served earliest deadline first. Deadline of request is time of ask + deadlineMs of it
+    //! (see askTriggerOn()) or periodMs of user (0 --> 1000 ms). High priority halves both, low doubles them
+    //! Can be called from thread of user: registration is applied in channel's thread
+    void registerUser(QObject *user, Priority priority = NormalPriority, quint32 periodMs = 0);
     //! \note Everything else is (with connections)
     QObject *whoIsBusy() const;
+    //! Utilization of bus, queueing delay histogram, missed deadlines
+    QVariantMap stats() const;
     template<typename User, typename...Args>
     QMetaObject::Connection callOnTrigger(User *user, void (User::*slot)(Args...args)) {
         return connect(this,
@@ -36,19 +40,28 @@ public:
     QMetaObject::Connection signalJobDone(User *user, void (User::*signal)(Args...args)) {
         return connect(user, signal, this, &Channel::onJobDone, Qt::QueuedConnection);
     }
+    //! Signal without args asks with periodMs of user, signal(quint32 deadlineMs) --> with own deadline
     template<typename User, typename...Args>
     QMetaObject::Connection askTriggerOn(User *user, void (User::*signal)(Args...args)) {
-        return connect(user, signal, this, &Channel::askTrigger, Qt::QueuedConnection);
+        if constexpr (sizeof...(Args) == 0) {
+            return connect(user, signal, this, &Channel::askTrigger, Qt::QueuedConnection);
+        } else {
+            return connect(user, signal, this, &Channel::askTriggerWithin, Qt::QueuedConnection);
+        }
     }
 signals:
     void trigger(QObject *user, QPrivateSignal);
 private slots:
     void onJobDone();
     void askTrigger();
+    void askTriggerWithin(quint32 deadlineMs);
 private:
+    struct UserState;
+    //! \param periodNs 0 --> period of user
+    void request(QObject *user, qint64 periodNs);
     bool isBusy() const;
     void chooseNext();
-    void activate(QObject *who);
+    void activate(UserState &state);
 
     Private *d;
 };
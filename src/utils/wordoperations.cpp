@@ -1,12 +1,13 @@
 #include "wordoperations.h"
 #include "templates/algorithms.hpp"
 
-void flipBytesInWords(quint16 *words, int sizeWords) {
+void ByteUtils::flipBytesInWords(quint16 *words, int sizeWords) {
+    flipBytesInWords(words, words, sizeWords);
+}
+
+void ByteUtils::flipBytesInWords(const quint16 *src, quint16 *dest, int sizeWords) {
     for (int i = 0; i < sizeWords; i++) {
-        quint8 bytes[2];
-        std::memcpy(bytes, words + i, 2);
-        std::swap(bytes[0], bytes[1]);
-        std::memcpy(words + i, bytes, 2);
+        dest[i] = quint16((src[i] << 8) | (src[i] >> 8));
     }
 }
 
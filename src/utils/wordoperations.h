@@ -23,6 +23,11 @@ bit_cast(const From* src) {
     return result;
 }
 
+//! Shift form is vectorized by compiler (byte shuffle per SIMD lane)
+void flipBytesInWords(quint16 *words, int sizeWords);
+//! Same, into other buffer (source is kept)
+void flipBytesInWords(const quint16 *src, quint16 *dest, int sizeWords);
+
 void applyEndianess(quint16 *words, int sizeWords, const Settings::PackingMode endianessWas, const Settings::PackingMode targetEndianess);
 
 QVector<quint16> toWords(const void* src, int sizeWords, Order from = Order::BigEndian, Order to = Order::BigEndian);
@@ -69,6 +69,7 @@ void Client::onRun()
         doStop();
     }
     doRun();
+    Worker::onRun();
 }
 
 bool Client::isRunning() const
@@ -0,0 +1,106 @@
+#include "gtest_brokerfanout.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QThread>
+#include <iostream>
+
+#define WORKERS     8
+#define MSGS        1000
+#define TIMEOUT_MS  10000
+
+using namespace Radapter;
+
+CountingWorker::CountingWorker(const QString &name) :
+    Worker({name}, new QThread)
+{
+}
+
+bool CountingWorker::event(QEvent *event)
+{
+    if (event->type() == QEvent::MetaCall) {
+        ++events;
+    }
+    return Worker::event(event);
+}
+
+void CountingWorker::onMsg(const WorkerMsg &)
+{
+    ++msgs;
+}
+
+void CountingWorker::onBroadcast(const WorkerMsg &)
+{
+    ++msgs;
+}
+
+void BrokerFanout::SetUp()
+{
+    static int run = 0;
+    const auto prefix = QStringLiteral("fanout.%1.").arg(run++);
+    sender = new CountingWorker(prefix + "sender");
+    Broker::instance()->registerWorker(sender);
+    sender->run();
+    for (int i = 0; i < WORKERS; ++i) {
+        auto worker = new CountingWorker(prefix + QString::number(i));
+        Broker::instance()->registerWorker(worker);
+        worker->run();
+        workers.append(worker);
+    }
+    // Startup calls (onRun and such) are not counted
+    QThread::msleep(100);
+    QCoreApplication::processEvents();
+    for (auto worker : qAsConst(workers)) {
+        worker->events = 0;
+        worker->msgs = 0;
+    }
+}
+
+double BrokerFanout::send(const QList<WorkerMsg> &msgs, CountingWorker *waitFor)
+{
+    for (const auto &msg : msgs) {
+        emit sender->sendMsg(msg);
+    }
+    auto deadline = QDeadlineTimer(TIMEOUT_MS);
+    while (waitFor->msgs < msgs.size() && !deadline.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    EXPECT_EQ(waitFor->msgs.load(), msgs.size());
+    // Let late events of other workers arrive
+    QThread::msleep(100);
+    int events = 0;
+    for (auto worker : qAsConst(workers)) {
+        events += worker->events;
+    }
+    return double(events) / msgs.size();
+}
+
+// Baseline: before routing, addressed msgs went out as broadcastToAll --> one queued call per registered worker
+TEST_F(BrokerFanout, EventsPerMsgBroadcastVsRouted)
+{
+    QList<WorkerMsg> broadcasts;
+    for (int i = 0; i < MSGS; ++i) {
+        WorkerMsg msg(sender);
+        msg.setFlag(WorkerMsg::MsgBroadcast);
+        broadcasts.append(msg);
+    }
+    const auto before = send(broadcasts, workers.first());
+    for (auto worker : qAsConst(workers)) {
+        worker->events = 0;
+        worker->msgs = 0;
+    }
+    QList<WorkerMsg> routed;
+    for (int i = 0; i < MSGS; ++i) {
+        routed.append(WorkerMsg(sender, QSet<Worker*>{workers.first()}));
+    }
+    const auto after = send(routed, workers.first());
+    // Nobody but receiver is woken up, receiver at most once per msg
+    for (int i = 1; i < workers.size(); ++i) {
+        EXPECT_EQ(workers[i]->events.load(), 0);
+    }
+    EXPECT_LE(after, 1.0);
+    EXPECT_LT(after, before);
+    std::cout << "Events per msg (" << WORKERS << " workers): broadcast: " << before
+              << "; routed to inbox: " << after << std::endl;
+    RecordProperty("events_per_msg_before", QString::number(before).toStdString());
+    RecordProperty("events_per_msg_after", QString::number(after).toStdString());
+}
@@ -0,0 +1,33 @@
+#ifndef GTEST_BROKERFANOUT_H
+#define GTEST_BROKERFANOUT_H
+
+#include <gtest/gtest.h>
+#include "broker/broker.h"
+#include "broker/workers/worker.h"
+
+//! Counts queued calls (events) it gets and msgs it handles
+class CountingWorker : public Radapter::Worker
+{
+    Q_OBJECT
+public:
+    CountingWorker(const QString &name);
+    bool event(QEvent *event) override;
+    std::atomic<int> events{0};
+    std::atomic<int> msgs{0};
+protected:
+    void onMsg(const Radapter::WorkerMsg &msg) override;
+    void onBroadcast(const Radapter::WorkerMsg &msg) override;
+};
+
+class BrokerFanout : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    //! \return events per msg, received by all workers
+    double send(const QList<Radapter::WorkerMsg> &msgs, CountingWorker *waitFor);
+
+    CountingWorker *sender{nullptr};
+    QList<CountingWorker*> workers;
+};
+
+#endif // GTEST_BROKERFANOUT_H
@@ -0,0 +1,2 @@
+RSK_TEST_NAME = channeledf
+include(../gtests.pri)
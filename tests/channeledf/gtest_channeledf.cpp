@@ -0,0 +1,130 @@
+#include "gtest_channeledf.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QThread>
+
+#define TIMEOUT_MS 5000
+
+using namespace Radapter::Sync;
+
+EdfUser::EdfUser(const QString &name, QStringList *order) :
+    m_name(name),
+    m_order(order)
+{
+}
+
+void EdfUser::onTrigger()
+{
+    m_order->append(m_name);
+    if (!hold) {
+        emit done();
+    }
+}
+
+void ChannelEdf::SetUp()
+{
+    channel = new Channel(QThread::currentThread(), 0);
+    blocker = addUser("blocker", 1);
+    blocker->hold = true;
+}
+
+void ChannelEdf::TearDown()
+{
+    qDeleteAll(users);
+    users.clear();
+    delete channel;
+}
+
+EdfUser *ChannelEdf::addUser(const QString &name, quint32 periodMs, Channel::Priority priority)
+{
+    auto user = new EdfUser(name, &order);
+    channel->registerUser(user, priority, periodMs);
+    channel->callOnTrigger(user, &EdfUser::onTrigger);
+    channel->signalJobDone(user, &EdfUser::done);
+    channel->askTriggerOn(user, &EdfUser::ask);
+    channel->askTriggerOn(user, &EdfUser::askWithin);
+    users.append(user);
+    return user;
+}
+
+void ChannelEdf::holdChannel()
+{
+    emit blocker->ask();
+    auto deadline = QDeadlineTimer(TIMEOUT_MS);
+    while (order.isEmpty() && !deadline.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    ASSERT_EQ(order, QStringList{"blocker"});
+    order.clear();
+}
+
+void ChannelEdf::releaseAndWait(int count)
+{
+    // Asks are queued: let channel see all of them, before it is released
+    QCoreApplication::processEvents();
+    emit blocker->done();
+    auto deadline = QDeadlineTimer(TIMEOUT_MS);
+    while (order.size() < count && !deadline.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+}
+
+TEST_F(ChannelEdf, EarliestPeriodFirst)
+{
+    auto slow = addUser("slow", 1000);
+    auto fast = addUser("fast", 10);
+    auto medium = addUser("medium", 50);
+    holdChannel();
+    emit slow->ask();
+    emit fast->ask();
+    emit medium->ask();
+    releaseAndWait(3);
+    EXPECT_EQ(order, (QStringList{"fast", "medium", "slow"}));
+}
+
+TEST_F(ChannelEdf, RequestDeadlineOverridesPeriod)
+{
+    auto slow = addUser("slow", 1000);
+    auto fast = addUser("fast", 10);
+    holdChannel();
+    emit fast->ask();
+    emit slow->askWithin(5);
+    releaseAndWait(2);
+    EXPECT_EQ(order, (QStringList{"slow", "fast"}));
+}
+
+TEST_F(ChannelEdf, ZeroDeadlineUsesPeriod)
+{
+    auto slow = addUser("slow", 1000);
+    auto fast = addUser("fast", 10);
+    holdChannel();
+    emit slow->askWithin(0);
+    emit fast->askWithin(0);
+    releaseAndWait(2);
+    EXPECT_EQ(order, (QStringList{"fast", "slow"}));
+}
+
+TEST_F(ChannelEdf, RepeatedAskKeepsEarliestDeadline)
+{
+    auto first = addUser("first", 1000);
+    auto second = addUser("second", 1000);
+    holdChannel();
+    emit first->askWithin(5);
+    emit second->askWithin(20);
+    // Later, looser deadline must not push first back
+    emit first->askWithin(500);
+    releaseAndWait(2);
+    EXPECT_EQ(order, (QStringList{"first", "second"}));
+}
+
+TEST_F(ChannelEdf, PriorityScalesDeadline)
+{
+    auto low = addUser("low", 100, Channel::LowPriority);
+    auto high = addUser("high", 300, Channel::HighPriority);
+    holdChannel();
+    // 100 * 2 = 200 ms vs 300 / 2 = 150 ms
+    emit low->ask();
+    emit high->ask();
+    releaseAndWait(2);
+    EXPECT_EQ(order, (QStringList{"high", "low"}));
+}
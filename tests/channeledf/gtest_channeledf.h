@@ -0,0 +1,42 @@
+#ifndef GTEST_CHANNELEDF_H
+#define GTEST_CHANNELEDF_H
+
+#include <gtest/gtest.h>
+#include "sync/channel.h"
+
+//! Records order of triggers, holds channel until released if asked to
+class EdfUser : public QObject
+{
+    Q_OBJECT
+public:
+    EdfUser(const QString &name, QStringList *order);
+    void onTrigger();
+    bool hold{false};
+signals:
+    void ask();
+    void askWithin(quint32 deadlineMs);
+    void done();
+private:
+    QString m_name;
+    QStringList *m_order;
+};
+
+class ChannelEdf : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    EdfUser *addUser(const QString &name, quint32 periodMs,
+                     Radapter::Sync::Channel::Priority priority = Radapter::Sync::Channel::NormalPriority);
+    //! Blocker takes channel, so that following asks queue up
+    void holdChannel();
+    //! Releases blocker and waits for count triggers (blocker's one included)
+    void releaseAndWait(int count);
+
+    Radapter::Sync::Channel *channel{nullptr};
+    EdfUser *blocker{nullptr};
+    QList<EdfUser*> users;
+    QStringList order;
+};
+
+#endif // GTEST_CHANNELEDF_H
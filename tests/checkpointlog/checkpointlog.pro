@@ -0,0 +1,2 @@
+RSK_TEST_NAME = checkpointlog
+include(../gtests.pri)
@@ -0,0 +1,87 @@
+#include "gtest_checkpointlog.h"
+
+#define LOG_NAME "checkpoints.log"
+
+void CheckpointLog::SetUp()
+{
+    storage = LocalStorage::instance();
+    // Commit on every change, no compaction by size
+    storage->setCommitPolicy(0, 0);
+}
+
+QByteArray CheckpointLog::record(const QString &stream, const QString &id)
+{
+    auto result = (stream + "/last_id").toUtf8().toPercentEncoding() + '\t' + id.toUtf8();
+    return result + '\t' + QByteArray::number(qChecksum(result), 16) + '\n';
+}
+
+void CheckpointLog::writeLog(const QTemporaryDir &dir, const QByteArray &content)
+{
+    QFile file(dir.filePath(LOG_NAME));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(content);
+}
+
+QByteArray CheckpointLog::readLog(const QTemporaryDir &dir)
+{
+    QFile file(dir.filePath(LOG_NAME));
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray{};
+}
+
+TEST_F(CheckpointLog, TornTailIsDropped)
+{
+    QTemporaryDir dir;
+    auto torn = record("c", "3-0");
+    writeLog(dir, record("a", "1-0") + record("b", "2-0") + record("a", "1-5") + torn.first(torn.size() - 4));
+    ASSERT_TRUE(storage->setStorageDirectory(dir.path()));
+    EXPECT_EQ(storage->getLastStreamId("a"), "1-5");
+    EXPECT_EQ(storage->getLastStreamId("b"), "2-0");
+    EXPECT_TRUE(storage->getLastStreamId("c").isEmpty());
+}
+
+TEST_F(CheckpointLog, BadCrcStopsReading)
+{
+    QTemporaryDir dir;
+    auto corrupted = record("b", "2-0");
+    corrupted[0] = 'x';
+    writeLog(dir, record("a", "1-0") + corrupted + record("c", "3-0"));
+    ASSERT_TRUE(storage->setStorageDirectory(dir.path()));
+    EXPECT_EQ(storage->getLastStreamId("a"), "1-0");
+    // Everything after first bad record is not trusted
+    EXPECT_TRUE(storage->getLastStreamId("b").isEmpty());
+    EXPECT_TRUE(storage->getLastStreamId("c").isEmpty());
+}
+
+TEST_F(CheckpointLog, CommitCompactsRecoveredLog)
+{
+    QTemporaryDir dir;
+    writeLog(dir, record("a", "1-0") + record("a", "1-1") + record("b", "2-0") + QByteArray("garbage"));
+    ASSERT_TRUE(storage->setStorageDirectory(dir.path()));
+    storage->setLastStreamId("c", "3-0");
+    const auto log = readLog(dir);
+    EXPECT_FALSE(log.contains("garbage"));
+    EXPECT_TRUE(log.endsWith('\n'));
+    EXPECT_EQ(log.count('\n'), 3);
+    EXPECT_TRUE(log.contains(record("a", "1-1")));
+    EXPECT_TRUE(log.contains(record("b", "2-0")));
+    EXPECT_TRUE(log.contains(record("c", "3-0")));
+}
+
+TEST_F(CheckpointLog, DirectoryChangeKeepsCheckpointsOfNewLog)
+{
+    QTemporaryDir first, second;
+    writeLog(first, record("a", "1-0"));
+    writeLog(second, record("b", "2-0") + record("c", "3-0"));
+    ASSERT_TRUE(storage->setStorageDirectory(first.path()));
+    EXPECT_EQ(storage->getLastStreamId("a"), "1-0");
+    ASSERT_TRUE(storage->setStorageDirectory(second.path()));
+    storage->commit();
+    storage->setLastStreamId("b", "2-1");
+    const auto log = readLog(second);
+    EXPECT_TRUE(log.contains(record("b", "2-1")));
+    EXPECT_TRUE(log.contains(record("c", "3-0")));
+    EXPECT_FALSE(log.contains(record("a", "1-0")));
+    EXPECT_EQ(storage->getLastStreamId("c"), "3-0");
+    // Old directory is left as is
+    EXPECT_EQ(readLog(first), record("a", "1-0"));
+}
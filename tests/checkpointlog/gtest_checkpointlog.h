@@ -0,0 +1,20 @@
+#ifndef GTEST_CHECKPOINTLOG_H
+#define GTEST_CHECKPOINTLOG_H
+
+#include <gtest/gtest.h>
+#include <QTemporaryDir>
+#include "localstorage.h"
+
+class CheckpointLog : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    //! Record in format of LocalStorage checkpoint log
+    static QByteArray record(const QString &stream, const QString &id);
+    static void writeLog(const QTemporaryDir &dir, const QByteArray &content);
+    static QByteArray readLog(const QTemporaryDir &dir);
+
+    LocalStorage *storage{nullptr};
+};
+
+#endif // GTEST_CHECKPOINTLOG_H
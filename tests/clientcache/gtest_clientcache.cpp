@@ -0,0 +1,125 @@
+#include "gtest_clientcache.h"
+#include "settings/redissettings.h"
+#include <QThread>
+
+using namespace Redis;
+
+RespReply::RespReply(const QByteArray &resp)
+{
+    auto reader = redisReaderCreate();
+    redisReaderFeed(reader, resp.constData(), size_t(resp.size()));
+    void *reply = nullptr;
+    EXPECT_EQ(redisReaderGetReply(reader, &reply), REDIS_OK);
+    EXPECT_NE(reply, nullptr) << "Incomplete RESP: " << resp.constData();
+    m_reply = static_cast<redisReply*>(reply);
+    redisReaderFree(reader);
+}
+
+RespReply::~RespReply()
+{
+    freeReplyObject(m_reply);
+}
+
+redisReply *RespReply::get() const
+{
+    return m_reply;
+}
+
+static Settings::RedisConnector parserConfig()
+{
+    Settings::RedisConnector config;
+    config.worker.value = Settings::Worker(QStringLiteral("clientcache.parser"));
+    config.server.name.value = QStringLiteral("unused");
+    config.server.host.value = QStringLiteral("127.0.0.1");
+    config.server.port.value = 6379;
+    return config;
+}
+
+ParsingConnector::ParsingConnector() :
+    Connector(parserConfig(), new QThread)
+{
+}
+
+static ClientCache filledCache()
+{
+    ClientCache cache;
+    cache.setObject("obj:a", JsonDict(QVariantMap{{"x", 1}}));
+    cache.setValue("key:b", "2");
+    cache.setValue("key:c", "3");
+    return cache;
+}
+
+TEST(ClientCache, InvalidatesListedKeys)
+{
+    auto cache = filledCache();
+    RespReply push(">2\r\n$10\r\ninvalidate\r\n*2\r\n$5\r\nobj:a\r\n$5\r\nkey:b\r\n");
+    ASSERT_EQ(push.get()->type, REDIS_REPLY_PUSH);
+    EXPECT_TRUE(cache.invalidate(push.get()));
+    EXPECT_EQ(cache.object("obj:a"), nullptr);
+    EXPECT_EQ(cache.value("key:b"), nullptr);
+    ASSERT_NE(cache.value("key:c"), nullptr);
+    EXPECT_EQ(*cache.value("key:c"), "3");
+}
+
+// FLUSHALL/FLUSHDB --> invalidate with null instead of keys
+TEST(ClientCache, NullInvalidationDropsAll)
+{
+    auto cache = filledCache();
+    RespReply push(">2\r\n$10\r\ninvalidate\r\n_\r\n");
+    EXPECT_TRUE(cache.invalidate(push.get()));
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ClientCache, OtherPushesAreNotHandled)
+{
+    auto cache = filledCache();
+    RespReply push(">3\r\n$7\r\nmessage\r\n$2\r\nch\r\n$5\r\nobj:a\r\n");
+    EXPECT_FALSE(cache.invalidate(push.get()));
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_FALSE(cache.invalidate(nullptr));
+}
+
+TEST(ClientCache, CachedValuesAreServed)
+{
+    auto cache = filledCache();
+    ASSERT_NE(cache.object("obj:a"), nullptr);
+    EXPECT_EQ(cache.object("obj:a")->value("x"), QVariant(1));
+    EXPECT_EQ(cache.object("obj:missing"), nullptr);
+}
+
+TEST(Resp3Parsing, MapIsParsedAsHash)
+{
+    ParsingConnector parser;
+    RespReply map("%2\r\n$1\r\na\r\n:1\r\n$3\r\nb:c\r\n$1\r\nx\r\n");
+    ASSERT_EQ(map.get()->type, REDIS_REPLY_MAP);
+    EXPECT_EQ(parser.parseReply(map.get()), (QVariantMap{{"a", 1LL}, {"b:c", "x"}}));
+    EXPECT_EQ(parser.parseHashReply(map.get()), (QVariantMap{{"a", 1LL}, {"b:c", "x"}}));
+    const auto nested = parser.parseHashReplyNested(map.get());
+    EXPECT_EQ(nested.value("a"), QVariant(1LL));
+    EXPECT_EQ(nested.value("b:c"), QVariant("x"));
+}
+
+// RESP2 HGETALL gives flat array, RESP3 gives map: both decode to same dict
+TEST(Resp3Parsing, MapSameAsResp2Array)
+{
+    ParsingConnector parser;
+    RespReply map("%2\r\n$3\r\nf:1\r\n$1\r\nx\r\n$3\r\nf:2\r\n$1\r\ny\r\n");
+    RespReply array("*4\r\n$3\r\nf:1\r\n$1\r\nx\r\n$3\r\nf:2\r\n$1\r\ny\r\n");
+    EXPECT_EQ(parser.parseHashReplyNested(map.get()), parser.parseHashReplyNested(array.get()));
+    EXPECT_EQ(parser.parseHashReply(map.get()), parser.parseHashReply(array.get()));
+}
+
+TEST(Resp3Parsing, ScalarTypes)
+{
+    ParsingConnector parser;
+    RespReply dbl(",1.5\r\n");
+    EXPECT_EQ(parser.parseReply(dbl.get()), QVariant(1.5));
+    RespReply yes("#t\r\n");
+    EXPECT_EQ(parser.parseReply(yes.get()), QVariant(true));
+    RespReply null("_\r\n");
+    EXPECT_FALSE(parser.parseReply(null.get()).isValid());
+    RespReply set("~2\r\n+x\r\n+y\r\n");
+    EXPECT_EQ(parser.parseReply(set.get()), (QVariantList{"x", "y"}));
+    RespReply push(">2\r\n$10\r\ninvalidate\r\n*1\r\n$1\r\nk\r\n");
+    EXPECT_EQ(parser.parseReply(push.get()), (QVariantList{"invalidate", QVariantList{"k"}}));
+}
@@ -0,0 +1,29 @@
+#ifndef GTEST_CLIENTCACHE_H
+#define GTEST_CLIENTCACHE_H
+
+#include <gtest/gtest.h>
+#include "connectors/redisconnector.h"
+#include "consumers/redisclientcache.h"
+
+//! Reply, decoded by hiredis reader from raw RESP (same as it comes from socket)
+class RespReply
+{
+public:
+    explicit RespReply(const QByteArray &resp);
+    ~RespReply();
+    redisReply *get() const;
+private:
+    redisReply *m_reply{nullptr};
+};
+
+//! Never connected, only exposes reply parsing
+class ParsingConnector : public Redis::Connector
+{
+public:
+    ParsingConnector();
+    using Connector::parseReply;
+    using Connector::parseHashReply;
+    using Connector::parseHashReplyNested;
+};
+
+#endif // GTEST_CLIENTCACHE_H
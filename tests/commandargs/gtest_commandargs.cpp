@@ -0,0 +1,69 @@
+#include "gtest_commandargs.h"
+
+using namespace Redis;
+
+static QByteArray encoded(const CommandArgs &args)
+{
+    return args.encoded().toByteArray();
+}
+
+TEST(CommandArgs, EncodesBulkStrings)
+{
+    CommandArgs args{"SET", "key", "value"};
+    EXPECT_EQ(args.count(), 3);
+    EXPECT_EQ(encoded(args), QByteArray("*3\r\n$3\r\nSET\r\n$3\r\nkey\r\n$5\r\nvalue\r\n"));
+}
+
+TEST(CommandArgs, KeepsSpacesAndBinaryData)
+{
+    CommandArgs args{"HGETALL"};
+    args.appendKey(QStringLiteral("key with spaces"));
+    args.append(QByteArray("a\0b\r\n", 5));
+    EXPECT_EQ(encoded(args), QByteArray("*3\r\n$7\r\nHGETALL\r\n$15\r\nkey with spaces\r\n$5\r\na\0b\r\n\r\n", 50));
+    EXPECT_EQ(args.routingKey(), QByteArrayView("key with spaces"));
+}
+
+TEST(CommandArgs, EncodesUtf8AndIntegers)
+{
+    CommandArgs args;
+    args << QStringLiteral("ключ") << -42 << quint64(7) << QVariant(3.5);
+    EXPECT_EQ(encoded(args), QByteArray("*4\r\n$8\r\n") + QStringLiteral("ключ").toUtf8()
+                             + "\r\n$3\r\n-42\r\n$1\r\n7\r\n$3\r\n3.5\r\n");
+}
+
+TEST(CommandArgs, FirstMarkedKeyRoutes)
+{
+    CommandArgs args{"MGET"};
+    args.appendKey(QStringLiteral("first")).appendKey(QStringLiteral("second"));
+    EXPECT_EQ(args.routingKey(), QByteArrayView("first"));
+    CommandArgs noKey{"PING"};
+    EXPECT_TRUE(noKey.routingKey().isEmpty());
+}
+
+TEST(CommandArgs, HeaderGrowsWithCount)
+{
+    CommandArgs args;
+    for (int i = 0; i < 1000; ++i) {
+        args << "x";
+    }
+    EXPECT_TRUE(encoded(args).startsWith("*1000\r\n$1\r\nx\r\n"));
+}
+
+TEST(CommandArgs, ClearKeepsBufferReusable)
+{
+    CommandArgs args{"XADD", "stream", "*", "field", "value"};
+    args.appendKey(QStringLiteral("key"));
+    args.clear();
+    EXPECT_TRUE(args.isEmpty());
+    EXPECT_TRUE(args.routingKey().isEmpty());
+    args << "PING";
+    EXPECT_EQ(encoded(args), QByteArray("*1\r\n$4\r\nPING\r\n"));
+}
+
+TEST(CommandArgs, FromStringSplitsLegacyCommands)
+{
+    auto args = CommandArgs::fromString(QStringLiteral("HSET  hash field value"));
+    EXPECT_EQ(args.count(), 4);
+    EXPECT_EQ(args.routingKey(), QByteArrayView("hash"));
+    EXPECT_EQ(args.print(), QStringLiteral("HSET hash field value"));
+}
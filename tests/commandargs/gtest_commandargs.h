@@ -0,0 +1,7 @@
+#ifndef GTEST_COMMANDARGS_H
+#define GTEST_COMMANDARGS_H
+
+#include <gtest/gtest.h>
+#include "formatting/redis/rediscommandargs.h"
+
+#endif // GTEST_COMMANDARGS_H
@@ -0,0 +1,89 @@
+#include "gtest_flatjson.h"
+
+static JsonKeys::Id key(const char *joined)
+{
+    return JsonKeys::intern(QString::fromLatin1(joined));
+}
+
+TEST(FlatJson, InternIsStable)
+{
+    EXPECT_EQ(key("flat:a"), key("flat:a"));
+    EXPECT_EQ(JsonKeys::intern(QStringLiteral("flat.a"), '.'), key("flat:a"));
+    EXPECT_EQ(JsonKeys::path(key("flat:a")), QStringList({"flat", "a"}));
+    EXPECT_NE(key("flat:a"), key("flat:b"));
+}
+
+TEST(FlatJson, InsertKeepsEntriesSorted)
+{
+    FlatJson json;
+    json.insert(key("sort:c"), 3);
+    json.insert(key("sort:a"), 1);
+    json.insert(key("sort:b"), 2);
+    json.insert(key("sort:a"), 10);
+    ASSERT_EQ(json.size(), 3);
+    for (auto entry = json.begin() + 1; entry != json.end(); ++entry) {
+        EXPECT_LT((entry - 1)->key, entry->key);
+    }
+    EXPECT_EQ(json.value(key("sort:a")).toInt(), 10);
+    EXPECT_TRUE(json.remove(key("sort:b")));
+    EXPECT_FALSE(json.remove(key("sort:b")));
+    EXPECT_FALSE(json.contains(key("sort:b")));
+}
+
+TEST(FlatJson, DiffReportsMissingAndChanged)
+{
+    FlatJson ours, theirs;
+    ours.insert(key("diff:same"), 1);
+    ours.insert(key("diff:changed"), 2);
+    ours.insert(key("diff:missing"), 3);
+    theirs.insert(key("diff:same"), 1);
+    theirs.insert(key("diff:changed"), 20);
+    theirs.insert(key("diff:extra"), 4);
+    auto diff = ours.diff(theirs);
+    EXPECT_EQ(diff.size(), 2);
+    EXPECT_EQ(diff.value(key("diff:changed")).toInt(), 2);
+    EXPECT_EQ(diff.value(key("diff:missing")).toInt(), 3);
+    EXPECT_FALSE(diff.contains(key("diff:extra")));
+    EXPECT_TRUE(ours.diff(ours).isEmpty());
+}
+
+TEST(FlatJson, UpdateReturnsOnlyChanges)
+{
+    FlatJson last;
+    FlatJson read;
+    read.insert(key("upd:a"), 1);
+    read.insert(key("upd:b"), 2);
+    auto first = last.update(read);
+    EXPECT_EQ(first.size(), 2);
+    EXPECT_TRUE(last.update(read).isEmpty());
+    read.insert(key("upd:b"), 5);
+    auto second = last.update(read);
+    ASSERT_EQ(second.size(), 1);
+    EXPECT_EQ(second.value(key("upd:b")).toInt(), 5);
+    EXPECT_EQ(last.value(key("upd:a")).toInt(), 1);
+    EXPECT_EQ(last.value(key("upd:b")).toInt(), 5);
+}
+
+TEST(FlatJson, UpdateKeepsEntriesAbsentFromSource)
+{
+    FlatJson last;
+    last.insert(key("part:a"), 1);
+    last.insert(key("part:b"), 2);
+    FlatJson partial;
+    partial.insert(key("part:b"), 3);
+    auto delta = last.update(partial);
+    EXPECT_EQ(delta.size(), 1);
+    EXPECT_EQ(last.size(), 2);
+    EXPECT_EQ(last.value(key("part:a")).toInt(), 1);
+}
+
+TEST(FlatJson, NestedRoundTrip)
+{
+    JsonDict nested(QVariantMap{
+        {"round", QVariantMap{{"a", 1}, {"b", QVariantMap{{"c", "text"}}}}}
+    });
+    FlatJson flat(nested);
+    EXPECT_EQ(flat.size(), 2);
+    EXPECT_EQ(flat.value(key("round:b:c")).toString(), QStringLiteral("text"));
+    EXPECT_EQ(flat.toJson(), nested);
+}
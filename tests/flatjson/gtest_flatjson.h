@@ -0,0 +1,7 @@
+#ifndef GTEST_FLATJSON_H
+#define GTEST_FLATJSON_H
+
+#include <gtest/gtest.h>
+#include "jsondict/flatjson.h"
+
+#endif // GTEST_FLATJSON_H
@@ -0,0 +1,10 @@
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+
+// Event loop is needed by tests of timers/queued connections
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,16 +1,25 @@
 ## При включении в проджект файл тестов укажите переменную RSK_TEST_NAME
-ADAPTER_LIB_DIR = $$PWD
-ADAPTER_SRC_DIR = $$PWD/src
-include(qtmodules.pri)
+ADAPTER_LIB_DIR = $$PWD/..
+ADAPTER_SRC_DIR = $$PWD/../src
+QT += core \
+    serialbus \
+    serialport \
+    sql \
+    websockets \
+    network \
+    httpserver \
+    concurrent
+QT -= gui
 include(gtest_dependency.pri)
 CONFIG += link_prl
 CONFIG -= app_bundle gui 
 QT += testlib
 TEMPLATE = app
-DEFINES += RADAPTER_API=Q_DECL_IMPORT
-CONFIG += console c++11
+DEFINES += RADAPTER_API= YAML_CPP_API=
+CONFIG += console c++17
 CONFIG += thread
 SOURCES += \
+    $$PWD/gtestmain.cpp \
     gtest_$${RSK_TEST_NAME}.cpp
 HEADERS += \
     gtest_$${RSK_TEST_NAME}.h
@@ -20,11 +29,12 @@ MOC_DIR = build
 RCC_DIR = build
 UI_DIR= build
 ##################### Подключение основной библиотеки проекта и библиотеки для тестов
-LIBS += -L$$ADAPTER_LIB_DIR -lrsk-testlib
+LIBS += -L$$ADAPTER_LIB_DIR
 CONFIG(debug, debug|release){
     LIBS += -lradapter-sdkd
 }
 CONFIG(release, debug|release){
     LIBS += -lradapter-sdk
 }
-INCLUDEPATH += $$ADAPTER_SRC_DIR $$PWD/rsk-testlib
\ No newline at end of file
+include($$ADAPTER_LIB_DIR/headers.pri)
+INCLUDEPATH += $$PWD
\ No newline at end of file
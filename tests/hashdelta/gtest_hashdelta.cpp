@@ -0,0 +1,177 @@
+#include "gtest_hashdelta.h"
+
+using namespace Redis;
+
+RespReply::RespReply(const QByteArray &resp)
+{
+    auto reader = redisReaderCreate();
+    redisReaderFeed(reader, resp.constData(), size_t(resp.size()));
+    void *reply = nullptr;
+    EXPECT_EQ(redisReaderGetReply(reader, &reply), REDIS_OK);
+    EXPECT_NE(reply, nullptr) << "Incomplete RESP: " << resp.constData();
+    m_reply = static_cast<redisReply*>(reply);
+    redisReaderFree(reader);
+}
+
+RespReply::~RespReply()
+{
+    freeReplyObject(m_reply);
+}
+
+const redisReply *RespReply::get() const
+{
+    return m_reply;
+}
+
+static JsonKeys::Id key(const char *joined)
+{
+    return JsonKeys::intern(QString::fromLatin1(joined));
+}
+
+static QByteArray encoded(const CommandArgs &args)
+{
+    return args.encoded().toByteArray();
+}
+
+TEST(HashDelta, FirstWriteIsFull)
+{
+    FlatJson target;
+    target.insert(key("full:a"), 1);
+    target.insert(key("full:b"), 2);
+    HashDelta delta(target, {}, true);
+    EXPECT_EQ(delta.changed.size(), 2);
+    EXPECT_TRUE(delta.removed.isEmpty());
+    auto commands = delta.commands("hash");
+    ASSERT_EQ(commands.size(), 1);
+    EXPECT_EQ(encoded(commands[0]), encoded(CommandArgs{"HSET", "hash", "full:a", "1", "full:b", "2"}));
+    EXPECT_EQ(commands[0].routingKey(), QByteArrayView("hash"));
+}
+
+TEST(HashDelta, OnlyChangedFieldsAreWritten)
+{
+    FlatJson shadow;
+    shadow.insert(key("chg:same"), 1);
+    shadow.insert(key("chg:changed"), 2);
+    auto target = shadow;
+    target.insert(key("chg:changed"), 20);
+    target.insert(key("chg:added"), 3);
+    HashDelta delta(target, shadow, false);
+    EXPECT_EQ(delta.changed.size(), 2);
+    EXPECT_FALSE(delta.changed.contains(key("chg:same")));
+    EXPECT_EQ(delta.fieldNames(), (QStringList{"chg:changed", "chg:added"}));
+    auto commands = delta.commands("hash");
+    ASSERT_EQ(commands.size(), 1);
+    EXPECT_EQ(encoded(commands[0]), encoded(CommandArgs{"HSET", "hash", "chg:changed", "20", "chg:added", "3"}));
+}
+
+TEST(HashDelta, SameStateWritesNothing)
+{
+    FlatJson shadow;
+    shadow.insert(key("same:a"), 1);
+    HashDelta merged(shadow, shadow, false);
+    HashDelta replaced(shadow, shadow, true);
+    EXPECT_TRUE(merged.isEmpty());
+    EXPECT_TRUE(replaced.isEmpty());
+    EXPECT_TRUE(merged.commands("hash").isEmpty());
+    EXPECT_TRUE(replaced.fieldNames().isEmpty());
+}
+
+TEST(HashDelta, ReplaceDeletesRemovedFields)
+{
+    FlatJson shadow;
+    shadow.insert(key("rm:kept"), 1);
+    shadow.insert(key("rm:gone"), 2);
+    shadow.insert(key("rm:also"), 3);
+    FlatJson target;
+    target.insert(key("rm:kept"), 10);
+    HashDelta delta(target, shadow, true);
+    EXPECT_EQ(delta.removed, (QList<JsonKeys::Id>{key("rm:gone"), key("rm:also")}));
+    EXPECT_EQ(delta.fieldNames(), (QStringList{"rm:kept", "rm:gone", "rm:also"}));
+    auto commands = delta.commands("hash");
+    ASSERT_EQ(commands.size(), 2);
+    EXPECT_EQ(encoded(commands[0]), encoded(CommandArgs{"HSET", "hash", "rm:kept", "10"}));
+    EXPECT_EQ(encoded(commands[1]), encoded(CommandArgs{"HDEL", "hash", "rm:gone", "rm:also"}));
+    EXPECT_EQ(commands[1].routingKey(), QByteArrayView("hash"));
+}
+
+TEST(HashDelta, OnlyRemovalsSendHdelAlone)
+{
+    FlatJson shadow;
+    shadow.insert(key("del:kept"), 1);
+    shadow.insert(key("del:gone"), 2);
+    FlatJson target;
+    target.insert(key("del:kept"), 1);
+    auto commands = HashDelta(target, shadow, true).commands("hash");
+    ASSERT_EQ(commands.size(), 1);
+    EXPECT_EQ(encoded(commands[0]), encoded(CommandArgs{"HDEL", "hash", "del:gone"}));
+}
+
+TEST(HashDelta, MergeNeverDeletes)
+{
+    FlatJson shadow;
+    shadow.insert(key("merge:a"), 1);
+    shadow.insert(key("merge:b"), 2);
+    FlatJson partial;
+    partial.insert(key("merge:b"), 3);
+    HashDelta delta(partial, shadow, false);
+    EXPECT_TRUE(delta.removed.isEmpty());
+    auto commands = delta.commands("hash");
+    ASSERT_EQ(commands.size(), 1);
+    EXPECT_EQ(encoded(commands[0]), encoded(CommandArgs{"HSET", "hash", "merge:b", "3"}));
+}
+
+// Same steps as CacheProducer: shadow moves forward with every delta
+TEST(HashDelta, ShadowFollowsWrites)
+{
+    FlatJson shadow;
+    FlatJson first;
+    first.insert(key("seq:a"), 1);
+    first.insert(key("seq:b"), 2);
+    HashDelta full(first, shadow, true);
+    EXPECT_EQ(full.changed.size(), 2);
+    shadow = first;
+
+    FlatJson update;
+    update.insert(key("seq:b"), 5);
+    HashDelta merged(update, shadow, false);
+    EXPECT_EQ(merged.fieldNames(), QStringList{"seq:b"});
+    shadow.update(merged.changed);
+
+    FlatJson replace;
+    replace.insert(key("seq:b"), 5);
+    HashDelta replaced(replace, shadow, true);
+    EXPECT_TRUE(replaced.changed.isEmpty());
+    EXPECT_EQ(replaced.removed, QList<JsonKeys::Id>{key("seq:a")});
+}
+
+TEST(ChangedFieldsReply, NestsFieldsByColon)
+{
+    RespReply reply("*2\r\n$2\r\n20\r\n$4\r\nauto\r\n");
+    ChangedFieldsReply changed({"plc:temp", "plc:mode"}, reply.get());
+    ASSERT_TRUE(changed.isValid());
+    EXPECT_EQ(changed.delta.value("plc:temp").toString(), "20");
+    EXPECT_EQ(changed.delta.value("plc:mode").toString(), "auto");
+    EXPECT_TRUE(changed.delta.value("plc").canConvert<QVariantMap>());
+}
+
+TEST(ChangedFieldsReply, DeletedFieldsAreNull)
+{
+    RespReply reply("*3\r\n$1\r\n1\r\n$-1\r\n_\r\n");
+    ChangedFieldsReply changed({"kept", "deleted", "deletedResp3"}, reply.get());
+    ASSERT_TRUE(changed.isValid());
+    EXPECT_EQ(changed.delta.value("kept").toString(), "1");
+    ASSERT_TRUE(changed.delta.contains("deleted"));
+    EXPECT_TRUE(changed.delta.value("deleted").isNull());
+    EXPECT_EQ(changed.delta.value("deleted").typeId(), QMetaType::Nullptr);
+    ASSERT_TRUE(changed.delta.contains("deletedResp3"));
+    EXPECT_EQ(changed.delta.value("deletedResp3").typeId(), QMetaType::Nullptr);
+}
+
+TEST(ChangedFieldsReply, MismatchIsInvalid)
+{
+    RespReply tooShort("*1\r\n$1\r\n1\r\n");
+    EXPECT_FALSE(ChangedFieldsReply({"a", "b"}, tooShort.get()).isValid());
+    RespReply error("-WRONGTYPE Operation against a key holding the wrong kind of value\r\n");
+    EXPECT_FALSE(ChangedFieldsReply({"a"}, error.get()).isValid());
+    EXPECT_FALSE(ChangedFieldsReply({"a"}, nullptr).isValid());
+}
@@ -0,0 +1,19 @@
+#ifndef GTEST_HASHDELTA_H
+#define GTEST_HASHDELTA_H
+
+#include <gtest/gtest.h>
+#include "formatting/redis/redishashdelta.h"
+#include "lib/hiredis/hiredis.h"
+
+//! Reply, decoded by hiredis reader from raw RESP (same as it comes from socket)
+class RespReply
+{
+public:
+    explicit RespReply(const QByteArray &resp);
+    ~RespReply();
+    const redisReply *get() const;
+private:
+    redisReply *m_reply{nullptr};
+};
+
+#endif // GTEST_HASHDELTA_H
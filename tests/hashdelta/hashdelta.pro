@@ -0,0 +1,2 @@
+RSK_TEST_NAME = hashdelta
+include(../gtests.pri)
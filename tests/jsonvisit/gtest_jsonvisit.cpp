@@ -0,0 +1,98 @@
+#include "gtest_jsonvisit.h"
+#include <QElapsedTimer>
+#include <iostream>
+
+#define DEVICES   50
+#define REGISTERS 90
+#define ALARMS    10
+#define ROUNDS    200
+
+// Shaped like Modbus/cache payloads: device --> registers, with a list of alarm flags
+// 50 * (90 + 10) = 5000 leaves
+static JsonDict payload()
+{
+    QVariantMap devices;
+    for (int device = 0; device < DEVICES; ++device) {
+        QVariantMap registers;
+        for (int reg = 0; reg < REGISTERS; ++reg) {
+            registers.insert(QStringLiteral("register_%1").arg(reg), reg % 3 ? QVariant(reg * 0.25) : QVariant(reg));
+        }
+        QVariantList alarms;
+        for (int alarm = 0; alarm < ALARMS; ++alarm) {
+            alarms.append(bool(alarm % 2));
+        }
+        registers.insert(QStringLiteral("alarms"), alarms);
+        devices.insert(QStringLiteral("device_%1").arg(device), registers);
+    }
+    return JsonDict(QVariantMap{{"plant", devices}});
+}
+
+TEST(JsonVisit, MatchesIterators)
+{
+    const auto json = payload();
+    QStringList visited;
+    QVariantList values;
+    json.visit([&](QStringView key, const QVariant &value){
+        visited.append(key.toString());
+        values.append(value);
+    });
+    QStringList iterated;
+    QVariantList iteratedValues;
+    for (auto &iter : json) {
+        iterated.append(iter.key().join(':'));
+        iteratedValues.append(iter.value());
+    }
+    EXPECT_EQ(visited.size(), DEVICES * (REGISTERS + ALARMS));
+    EXPECT_EQ(visited, iterated);
+    EXPECT_EQ(values, iteratedValues);
+    EXPECT_EQ(json.deepCount(), visited.size());
+    EXPECT_EQ(json.keys(), iterated);
+}
+
+TEST(JsonVisit, StopsWhenVisitorReturnsFalse)
+{
+    const auto json = payload();
+    int seen = 0;
+    EXPECT_FALSE(json.visit([&](QStringView, const QVariant &){
+        return ++seen < 10;
+    }));
+    EXPECT_EQ(seen, 10);
+    EXPECT_TRUE(JsonDict{}.visit([](QStringView, const QVariant &){return false;}));
+}
+
+TEST(JsonVisit, CustomSeparatorAndListIndexes)
+{
+    JsonDict json(QVariantMap{{"a", QVariantMap{{"b", QVariantList{1, 2}}}}});
+    QStringList keys;
+    json.visit([&](QStringView key, const QVariant &){keys.append(key.toString());}, '.');
+    EXPECT_EQ(keys, QStringList({"a.b.[0]", "a.b.[1]"}));
+}
+
+TEST(JsonVisit, VisitVsIterator5kLeaves)
+{
+    const auto json = payload();
+    quint64 checksum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (auto &iter : json) {
+            checksum += quint64(iter.key().size()) + quint64(iter.value().toInt());
+        }
+    }
+    const auto iteratorUs = timer.nsecsElapsed() / 1000;
+    quint64 visitChecksum = 0;
+    timer.restart();
+    for (int round = 0; round < ROUNDS; ++round) {
+        json.visit([&](QStringView key, const QVariant &value){
+            visitChecksum += quint64(key.count(':') + 1) + quint64(value.toInt());
+        });
+    }
+    const auto visitUs = timer.nsecsElapsed() / 1000;
+    EXPECT_EQ(checksum, visitChecksum);
+
+    std::cout << "5k leaves x" << ROUNDS << ": iterator: " << iteratorUs << " us; "
+              << "visit: " << visitUs << " us; "
+              << "speedup: x" << double(iteratorUs) / double(qMax<qint64>(visitUs, 1)) << std::endl;
+    RecordProperty("iterator_us", int(iteratorUs));
+    RecordProperty("visit_us", int(visitUs));
+}
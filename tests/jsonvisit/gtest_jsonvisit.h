@@ -0,0 +1,7 @@
+#ifndef GTEST_JSONVISIT_H
+#define GTEST_JSONVISIT_H
+
+#include <gtest/gtest.h>
+#include "jsondict/jsondict.h"
+
+#endif // GTEST_JSONVISIT_H
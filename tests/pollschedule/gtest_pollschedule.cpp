@@ -0,0 +1,142 @@
+#include "gtest_pollschedule.h"
+
+using namespace Modbus;
+
+static QModbusDataUnit unit(int start, int count = 1)
+{
+    return QModbusDataUnit{QModbusDataUnit::HoldingRegisters, start, quint16(count)};
+}
+
+static quint64 bit(int group)
+{
+    return quint64(1) << group;
+}
+
+TEST(PollSchedule, GroupsByInterval)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 100);
+    schedule.add(unit(10), 1000);
+    schedule.add(unit(1), 100);
+    schedule.add(unit(20), 0);
+    ASSERT_EQ(schedule.groups().size(), 3);
+    EXPECT_EQ(schedule.groups()[0].interval, 100u);
+    EXPECT_EQ(schedule.groups()[0].units.size(), 2);
+    EXPECT_EQ(schedule.groups()[1].interval, 1000u);
+    EXPECT_EQ(schedule.groups()[2].interval, 0u);
+    EXPECT_EQ(schedule.fastest(), 100u);
+}
+
+TEST(PollSchedule, FirstPollIsImmediate)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 100);
+    schedule.add(unit(10), 1000);
+    schedule.add(unit(20), 5000);
+    schedule.start(0);
+    EXPECT_EQ(schedule.nextDue(), 0);
+    auto due = schedule.takeDue(0);
+    EXPECT_EQ(due.groups, bit(0) | bit(1) | bit(2));
+    EXPECT_EQ(due.deadline, 100u);
+}
+
+TEST(PollSchedule, PhasesAreWithinOneInterval)
+{
+    PollSchedule schedule;
+    for (int i = 0; i < 8; ++i) {
+        schedule.add(unit(i * 10), 1000);
+        schedule.add(unit(i * 10 + 1), 1000 + quint32(i + 1) * 100);
+    }
+    schedule.start(0);
+    schedule.takeDue(0);
+    for (const auto &group : schedule.groups()) {
+        EXPECT_GT(group.nextDue, 0);
+        EXPECT_LE(group.nextDue, qint64(group.interval));
+    }
+}
+
+TEST(PollSchedule, PhasesSpreadGroupsApart)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 1000);
+    schedule.add(unit(10), 1000);
+    schedule.add(unit(20), 1000);
+    schedule.start(0);
+    schedule.takeDue(0);
+    const auto &groups = schedule.groups();
+    EXPECT_EQ(groups[0].nextDue, 1000);
+    EXPECT_EQ(groups[1].nextDue, 618);
+    EXPECT_EQ(groups[2].nextDue, 236);
+    // After phase every group keeps its interval
+    auto due = schedule.takeDue(236);
+    EXPECT_EQ(due.groups, bit(2));
+    EXPECT_EQ(schedule.groups()[2].nextDue, 1236);
+}
+
+TEST(PollSchedule, MergesGroupsDueWithinWindow)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 100);
+    schedule.add(unit(10), 200);
+    schedule.start(0);
+    schedule.takeDue(0);
+    // Group 0 next at 100, group 1 at 123 (0.618 * 200)
+    EXPECT_EQ(schedule.takeDue(100).groups, bit(0));
+    EXPECT_EQ(schedule.takeDue(123 - PollSchedule::MergeWindowMs).groups, bit(1));
+    EXPECT_EQ(schedule.takeDue(200).groups, bit(0));
+}
+
+TEST(PollSchedule, MissedPollsAreSkipped)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 100);
+    schedule.start(0);
+    schedule.takeDue(0);
+    auto due = schedule.takeDue(1050);
+    EXPECT_EQ(due.groups, bit(0));
+    EXPECT_EQ(schedule.nextDue(), 1150);
+    EXPECT_FALSE(schedule.takeDue(1100).groups);
+}
+
+TEST(PollSchedule, ZeroIntervalIsNeverPolled)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 0);
+    schedule.start(0);
+    EXPECT_EQ(schedule.nextDue(), -1);
+    EXPECT_FALSE(schedule.takeDue(0).groups);
+    EXPECT_EQ(schedule.fastest(), 0u);
+}
+
+TEST(PollSchedule, RestartPollsEverythingAgain)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0), 100);
+    schedule.add(unit(10), 1000);
+    schedule.start(0);
+    schedule.takeDue(0);
+    schedule.takeDue(100);
+    schedule.start(5000);
+    EXPECT_EQ(schedule.takeDue(5000).groups, bit(0) | bit(1));
+    EXPECT_EQ(schedule.groups()[1].nextDue, 5618);
+}
+
+TEST(PollSchedule, DueGroupsAreMergedIntoOnePlan)
+{
+    PollSchedule schedule;
+    schedule.add(unit(0, 2), 100);
+    schedule.add(unit(2, 2), 1000);
+    schedule.add(unit(50, 2), 100);
+    EXPECT_EQ(schedule.unitsOf(bit(0)).size(), 2);
+    EXPECT_EQ(schedule.unitsOf(bit(1)).size(), 1);
+    EXPECT_TRUE(schedule.unitsOf(0).isEmpty());
+
+    auto fast = planReads(schedule.unitsOf(bit(0)));
+    ASSERT_EQ(fast.size(), 2);
+    // Adjacent units of both groups are read by one request
+    auto both = planReads(schedule.unitsOf(bit(0) | bit(1)));
+    ASSERT_EQ(both.size(), 2);
+    EXPECT_EQ(both[0].startAddress(), 0);
+    EXPECT_EQ(both[0].valueCount(), 4u);
+    EXPECT_EQ(both[1].startAddress(), 50);
+}
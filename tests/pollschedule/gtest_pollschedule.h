@@ -0,0 +1,8 @@
+#ifndef GTEST_POLLSCHEDULE_H
+#define GTEST_POLLSCHEDULE_H
+
+#include <gtest/gtest.h>
+#include "modbus/modbuspollschedule.h"
+#include "modbus/modbusreadplanner.h"
+
+#endif // GTEST_POLLSCHEDULE_H
@@ -0,0 +1,2 @@
+RSK_TEST_NAME = pollschedule
+include(../gtests.pri)
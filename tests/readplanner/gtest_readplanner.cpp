@@ -0,0 +1,159 @@
+#include "gtest_readplanner.h"
+#include <QRandomGenerator>
+#include <iostream>
+
+#define MAP_REGISTERS 3000
+
+using namespace Modbus;
+
+static QModbusDataUnit unit(int start, int count, QModbusDataUnit::RegisterType table = QModbusDataUnit::HoldingRegisters)
+{
+    return QModbusDataUnit{table, start, quint16(count)};
+}
+
+static bool covers(const QList<QModbusDataUnit> &plan, const QModbusDataUnit &wanted)
+{
+    for (const auto &read : plan) {
+        if (read.registerType() == wanted.registerType() &&
+            read.startAddress() <= wanted.startAddress() &&
+            read.startAddress() + int(read.valueCount()) >= wanted.startAddress() + int(wanted.valueCount())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST(ReadPlanner, MergesAdjacentAndOverlapping)
+{
+    auto plan = planReads({unit(10, 2), unit(0, 10), unit(11, 4)});
+    ASSERT_EQ(plan.size(), 1);
+    EXPECT_EQ(plan[0].startAddress(), 0);
+    EXPECT_EQ(plan[0].valueCount(), 15);
+}
+
+TEST(ReadPlanner, BridgesGapsUpToMaxGap)
+{
+    const QList<QModbusDataUnit> wanted{unit(0, 2), unit(5, 2), unit(20, 1)};
+    EXPECT_EQ(planReads(wanted).size(), 3);
+    ReadPlanOptions options;
+    options.maxGap = 3;
+    auto plan = planReads(wanted, options);
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0].startAddress(), 0);
+    EXPECT_EQ(plan[0].valueCount(), 7);
+    EXPECT_EQ(plan[1].startAddress(), 20);
+    options.maxGap = 13;
+    EXPECT_EQ(planReads(wanted, options).size(), 1);
+}
+
+TEST(ReadPlanner, SplitsAtProtocolLimit)
+{
+    QList<QModbusDataUnit> wanted;
+    for (int i = 0; i < 300; i += 2) {
+        wanted.append(unit(i, 2));
+    }
+    auto plan = planReads(wanted);
+    ASSERT_EQ(plan.size(), 3);
+    for (const auto &read : plan) {
+        EXPECT_LE(read.valueCount(), ReadPlanOptions::MaxRegisters);
+    }
+    // Two word values are never split between requests
+    EXPECT_EQ(plan[0].valueCount(), 124);
+    for (const auto &part : wanted) {
+        EXPECT_TRUE(covers(plan, part));
+    }
+}
+
+TEST(ReadPlanner, RespectsConfiguredMaxSize)
+{
+    ReadPlanOptions options;
+    options.maxRegisters = 10;
+    options.maxGap = 100;
+    auto plan = planReads({unit(0, 4), unit(4, 4), unit(8, 4), unit(12, 4)}, options);
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0].valueCount(), 8);
+    EXPECT_EQ(plan[1].startAddress(), 8);
+}
+
+TEST(ReadPlanner, BitTablesUseBitLimits)
+{
+    QList<QModbusDataUnit> wanted;
+    for (int i = 0; i < 2500; ++i) {
+        wanted.append(unit(i, 1, QModbusDataUnit::Coils));
+    }
+    auto plan = planReads(wanted);
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0].valueCount(), ReadPlanOptions::MaxBits);
+    // Gap is counted in registers: x16 for bits
+    ReadPlanOptions options;
+    options.maxGap = 1;
+    EXPECT_EQ(planReads({unit(0, 1, QModbusDataUnit::DiscreteInputs), unit(17, 1, QModbusDataUnit::DiscreteInputs)}, options).size(), 1);
+    EXPECT_EQ(planReads({unit(0, 1, QModbusDataUnit::DiscreteInputs), unit(18, 1, QModbusDataUnit::DiscreteInputs)}, options).size(), 2);
+}
+
+TEST(ReadPlanner, NeverBridgesForbiddenRanges)
+{
+    ReadPlanOptions options;
+    options.maxGap = 50;
+    options.forbidden[QModbusDataUnit::HoldingRegisters] = {{10, 12}};
+    auto plan = planReads({unit(0, 5), unit(20, 5), unit(30, 5)}, options);
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0].valueCount(), 5);
+    EXPECT_EQ(plan[1].startAddress(), 20);
+    EXPECT_EQ(plan[1].valueCount(), 15);
+    // Forbidden in other table does not matter
+    EXPECT_EQ(planReads({unit(0, 5, QModbusDataUnit::InputRegisters), unit(20, 5, QModbusDataUnit::InputRegisters)}, options).size(), 1);
+}
+
+TEST(ReadPlanner, KeepsTablesApart)
+{
+    auto plan = planReads({unit(0, 2), unit(2, 2, QModbusDataUnit::InputRegisters), unit(0, 0)});
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_NE(plan[0].registerType(), plan[1].registerType());
+}
+
+// Map shaped like our devices: blocks of 1-2 word registers with small holes between blocks
+static QList<QModbusDataUnit> registerMap()
+{
+    QRandomGenerator random(42);
+    QList<QModbusDataUnit> result;
+    int address = 0;
+    int registers = 0;
+    while (registers < MAP_REGISTERS) {
+        const auto block = 4 + int(random.bounded(20));
+        for (int i = 0; i < block && registers < MAP_REGISTERS; ++i, ++registers) {
+            const auto size = random.bounded(3) ? 1 : 2;
+            result.append(unit(address, size, registers % 5 ? QModbusDataUnit::HoldingRegisters : QModbusDataUnit::InputRegisters));
+            address += size;
+        }
+        address += int(random.bounded(6));
+    }
+    return result;
+}
+
+TEST(ReadPlanner, RequestsPerPoll3kRegisters)
+{
+    const auto wanted = registerMap();
+    const auto merged = mergeDataUnits(wanted);
+    int oversized = 0;
+    for (const auto &read : merged) {
+        oversized += read.valueCount() > ReadPlanOptions::MaxRegisters;
+    }
+    ReadPlanOptions options;
+    const auto exact = planReads(wanted, options);
+    options.maxGap = 8;
+    const auto bridged = planReads(wanted, options);
+    for (const auto &part : wanted) {
+        ASSERT_TRUE(covers(exact, part));
+        ASSERT_TRUE(covers(bridged, part));
+    }
+    EXPECT_LE(bridged.size(), exact.size());
+
+    std::cout << MAP_REGISTERS << " registers: mergeDataUnits: " << merged.size()
+              << " requests (" << oversized << " over protocol limit); "
+              << "planReads: " << exact.size() << " requests; "
+              << "planReads (max_read_gap 8): " << bridged.size() << " requests" << std::endl;
+    RecordProperty("merged_requests", int(merged.size()));
+    RecordProperty("planned_requests", int(exact.size()));
+    RecordProperty("bridged_requests", int(bridged.size()));
+}
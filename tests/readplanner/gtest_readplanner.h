@@ -0,0 +1,8 @@
+#ifndef GTEST_READPLANNER_H
+#define GTEST_READPLANNER_H
+
+#include <gtest/gtest.h>
+#include "modbus/modbusreadplanner.h"
+#include "modbus/modbusparsing.h"
+
+#endif // GTEST_READPLANNER_H
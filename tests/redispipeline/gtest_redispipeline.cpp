@@ -0,0 +1,139 @@
+#include "gtest_redispipeline.h"
+
+using namespace Redis;
+
+QList<void*> PipelineTest::deallocated;
+
+Pipeline::Sender FakeConnection::sender()
+{
+    return [this](redisCallbackFn *, void *, QByteArrayView encoded){
+        if (failAt >= 0 && attempts++ >= failAt) {
+            return REDIS_ERR;
+        }
+        // "*1\r\n$5\r\nMULTI\r\n" --> MULTI
+        const auto lines = QByteArray(encoded.data(), encoded.size()).split('\n');
+        sent.append(QString::fromUtf8(lines.size() > 2 ? lines[2].trimmed() : QByteArray{}));
+        return REDIS_OK;
+    };
+}
+
+void PipelineTest::queueTransaction(int count)
+{
+    deallocated.clear();
+    pipeline.append(nullptr, nullptr, nullptr, nullptr, CommandArgs{"MULTI"});
+    for (int i = 0; i < count; ++i) {
+        pipeline.append(nullptr, nullptr, nullptr, nullptr, CommandArgs{"XADD", "stream", "*", "field", "value"});
+    }
+    pipeline.append(callback, &execData, nullptr, dealloc, CommandArgs{"EXEC"});
+}
+
+void PipelineTest::callback(redisAsyncContext *, void *, void *)
+{
+}
+
+void PipelineTest::dealloc(void *data)
+{
+    deallocated.append(data);
+}
+
+TEST_F(PipelineTest, WholeTransactionIsSent)
+{
+    queueTransaction(3);
+    EXPECT_EQ(pipeline.count(), 5);
+    EXPECT_EQ(pipeline.callbacks(), 1);
+    const auto result = pipeline.send(connection.sender(), true, 1);
+    EXPECT_EQ(result.status, REDIS_OK);
+    EXPECT_EQ(result.sent, 5);
+    EXPECT_FALSE(result.transactionOpen);
+    EXPECT_EQ(connection.sent, (QStringList{"MULTI", "XADD", "XADD", "XADD", "EXEC"}));
+    EXPECT_TRUE(deallocated.isEmpty());
+    EXPECT_TRUE(pipeline.isEmpty());
+}
+
+// MULTI and some XADDs went out, then connection refused: EXEC never follows, so DISCARD must
+TEST_F(PipelineTest, PartialFlushDiscardsTransaction)
+{
+    queueTransaction(3);
+    connection.failAt = 3;
+    auto refusing = connection.sender();
+    // DISCARD is the first command after the failed one: accept it again
+    const auto result = pipeline.send([&](redisCallbackFn *callback, void *cbData, QByteArrayView encoded){
+        if (encoded.contains(QByteArrayView("DISCARD"))) {
+            connection.sent.append("DISCARD");
+            return REDIS_OK;
+        }
+        return refusing(callback, cbData, encoded);
+    }, true, 1);
+    EXPECT_EQ(result.status, REDIS_ERR);
+    EXPECT_EQ(result.sent, 3);
+    EXPECT_FALSE(result.transactionOpen);
+    EXPECT_EQ(connection.sent, (QStringList{"MULTI", "XADD", "XADD", "DISCARD"}));
+    // EXEC was not sent: its data is freed, its callback is never called
+    EXPECT_EQ(deallocated, QList<void*>{&execData});
+}
+
+TEST_F(PipelineTest, TransactionLeftOpenIfDiscardFails)
+{
+    queueTransaction(3);
+    connection.failAt = 2;
+    const auto result = pipeline.send(connection.sender(), true, 1);
+    EXPECT_EQ(result.status, REDIS_ERR);
+    EXPECT_EQ(result.sent, 2);
+    EXPECT_TRUE(result.transactionOpen);
+    EXPECT_EQ(connection.sent, (QStringList{"MULTI", "XADD"}));
+}
+
+TEST_F(PipelineTest, NothingSentNoDiscard)
+{
+    queueTransaction(2);
+    connection.failAt = 0;
+    const auto result = pipeline.send(connection.sender(), true, 1);
+    EXPECT_EQ(result.sent, 0);
+    EXPECT_FALSE(result.transactionOpen);
+    EXPECT_TRUE(connection.sent.isEmpty());
+    // Only MULTI was attempted
+    EXPECT_EQ(connection.attempts, 1);
+}
+
+TEST_F(PipelineTest, RefusedPipelineIsDeallocated)
+{
+    queueTransaction(2);
+    const auto result = pipeline.send(connection.sender(), false, 1);
+    EXPECT_EQ(result.status, REDIS_ERR);
+    EXPECT_EQ(result.sent, 0);
+    EXPECT_TRUE(connection.sent.isEmpty());
+    EXPECT_EQ(deallocated, QList<void*>{&execData});
+    EXPECT_TRUE(pipeline.isEmpty());
+}
+
+TEST_F(PipelineTest, PlainPipelineIsNotDiscarded)
+{
+    deallocated.clear();
+    pipeline.append(nullptr, nullptr, nullptr, nullptr, CommandArgs{"HSET", "key", "a", "1"});
+    pipeline.append(callback, &execData, nullptr, dealloc, CommandArgs{"HDEL", "key", "b"});
+    connection.failAt = 1;
+    const auto result = pipeline.send(connection.sender(), true, 1);
+    EXPECT_EQ(result.sent, 1);
+    EXPECT_FALSE(result.transactionOpen);
+    EXPECT_EQ(connection.sent, QStringList{"HSET"});
+}
+
+// Cluster mode redirects transaction as a whole, plain commands one by one
+TEST_F(PipelineTest, TransactionIsDetected)
+{
+    pipeline.append(nullptr, nullptr, nullptr, nullptr, CommandArgs{"HSET", "key", "a", "1"});
+    EXPECT_FALSE(pipeline.hasTransaction());
+    pipeline.clear();
+    queueTransaction(1);
+    EXPECT_TRUE(pipeline.hasTransaction());
+    pipeline.send(connection.sender(), true, 1);
+    EXPECT_FALSE(pipeline.hasTransaction());
+}
+
+TEST_F(PipelineTest, SentCommandsAreStamped)
+{
+    qint64 stamp = 0;
+    pipeline.append(callback, &execData, &stamp, dealloc, CommandArgs{"PING"});
+    pipeline.send(connection.sender(), true, 42);
+    EXPECT_EQ(stamp, 42);
+}
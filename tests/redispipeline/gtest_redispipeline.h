@@ -0,0 +1,34 @@
+#ifndef GTEST_REDISPIPELINE_H
+#define GTEST_REDISPIPELINE_H
+
+#include <gtest/gtest.h>
+#include "connectors/redispipeline.h"
+
+//! Records commands handed to connection, refuses them from failAt on
+class FakeConnection
+{
+public:
+    Redis::Pipeline::Sender sender();
+    //! -1 --> never fails
+    int failAt{-1};
+    //! Commands (as printed) that were accepted
+    QStringList sent;
+    int attempts{0};
+};
+
+class PipelineTest : public ::testing::Test
+{
+protected:
+    //! Queues MULTI, count of XADDs and EXEC (with callback)
+    void queueTransaction(int count);
+    static void callback(redisAsyncContext *, void *, void *);
+    static void dealloc(void *data);
+
+    Redis::Pipeline pipeline;
+    FakeConnection connection;
+    //! cbData of commands, that were deallocated without being sent
+    static QList<void*> deallocated;
+    int execData{0};
+};
+
+#endif // GTEST_REDISPIPELINE_H
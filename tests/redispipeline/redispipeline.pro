@@ -0,0 +1,2 @@
+RSK_TEST_NAME = redispipeline
+include(../gtests.pri)
@@ -0,0 +1,106 @@
+#include "gtest_redispubsub.h"
+
+using namespace Redis;
+
+RespReply::RespReply(const QByteArray &resp)
+{
+    auto reader = redisReaderCreate();
+    redisReaderFeed(reader, resp.constData(), size_t(resp.size()));
+    void *reply = nullptr;
+    EXPECT_EQ(redisReaderGetReply(reader, &reply), REDIS_OK);
+    EXPECT_NE(reply, nullptr) << "Incomplete RESP: " << resp.constData();
+    m_reply = static_cast<redisReply*>(reply);
+    redisReaderFree(reader);
+}
+
+RespReply::~RespReply()
+{
+    freeReplyObject(m_reply);
+}
+
+const redisReply *RespReply::get() const
+{
+    return m_reply;
+}
+
+static QByteArray bulk(const QByteArray &value)
+{
+    return "$" + QByteArray::number(value.size()) + "\r\n" + value + "\r\n";
+}
+
+//! '*' --> RESP2 array, '>' --> RESP3 push
+static QByteArray frame(char type, const QList<QByteArray> &parts)
+{
+    QByteArray result = type + QByteArray::number(parts.size()) + "\r\n";
+    for (const auto &part : parts) {
+        result += bulk(part);
+    }
+    return result;
+}
+
+static QString payload(const PubSubMessage &message)
+{
+    return QString::fromUtf8(message.payload->str, qsizetype(message.payload->len));
+}
+
+class PubSubFrames : public ::testing::TestWithParam<char> {};
+
+TEST_P(PubSubFrames, Message)
+{
+    RespReply reply(frame(GetParam(), {"message", "news", "hello"}));
+    auto message = PubSubMessage::parse(reply.get());
+    ASSERT_TRUE(message.isValid());
+    EXPECT_TRUE(message.pattern.isEmpty());
+    EXPECT_EQ(message.channel, "news");
+    EXPECT_EQ(payload(message), "hello");
+}
+
+TEST_P(PubSubFrames, PatternMessage)
+{
+    RespReply reply(frame(GetParam(), {"pmessage", "__keyspace@0__:*", "__keyspace@0__:plc", "hset"}));
+    auto message = PubSubMessage::parse(reply.get());
+    ASSERT_TRUE(message.isValid());
+    EXPECT_EQ(message.pattern, "__keyspace@0__:*");
+    EXPECT_EQ(message.channel, "__keyspace@0__:plc");
+    EXPECT_EQ(payload(message), "hset");
+}
+
+TEST_P(PubSubFrames, ConfirmationsAreSkipped)
+{
+    RespReply subscribe(GetParam() + QByteArray("3\r\n") + bulk("psubscribe") + bulk("__keyspace@0__:*") + ":1\r\n");
+    EXPECT_FALSE(PubSubMessage::parse(subscribe.get()).isValid());
+    RespReply shortMessage(frame(GetParam(), {"pmessage", "pattern", "channel"}));
+    EXPECT_FALSE(PubSubMessage::parse(shortMessage.get()).isValid());
+}
+
+INSTANTIATE_TEST_SUITE_P(Resp, PubSubFrames, ::testing::Values('*', '>'));
+
+TEST(PubSubMessage, OtherRepliesAreInvalid)
+{
+    RespReply status("+OK\r\n");
+    EXPECT_FALSE(PubSubMessage::parse(status.get()).isValid());
+    RespReply invalidate(frame('>', {"invalidate", "key"}));
+    EXPECT_FALSE(PubSubMessage::parse(invalidate.get()).isValid());
+    EXPECT_FALSE(PubSubMessage::parse(nullptr).isValid());
+}
+
+TEST(KeyEvent, KeyspaceCarriesEvent)
+{
+    KeyEvent event("__keyspace@0__:plc:temp", "hset");
+    EXPECT_EQ(event.key, "plc:temp");
+    EXPECT_EQ(event.event, "hset");
+}
+
+TEST(KeyEvent, KeyeventCarriesKey)
+{
+    KeyEvent event("__keyevent@3__:expired", "session:1");
+    EXPECT_EQ(event.key, "session:1");
+    EXPECT_EQ(event.event, "expired");
+}
+
+TEST(KeyEvent, OtherChannelsAreKept)
+{
+    KeyEvent event("plc:changes", "temp");
+    EXPECT_EQ(event.key, "plc:changes");
+    EXPECT_EQ(event.event, "temp");
+}
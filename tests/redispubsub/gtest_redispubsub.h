@@ -0,0 +1,18 @@
+#ifndef GTEST_REDISPUBSUB_H
+#define GTEST_REDISPUBSUB_H
+
+#include <gtest/gtest.h>
+#include "connectors/redispubsub.h"
+
+//! Reply, decoded by hiredis reader from raw RESP (same as it comes from socket)
+class RespReply
+{
+public:
+    explicit RespReply(const QByteArray &resp);
+    ~RespReply();
+    const redisReply *get() const;
+private:
+    redisReply *m_reply{nullptr};
+};
+
+#endif // GTEST_REDISPUBSUB_H
@@ -0,0 +1,154 @@
+#include "gtest_redisrouting.h"
+
+#define KEYS            30000
+#define VIRTUAL_NODES   64
+
+using namespace Redis;
+
+ErrorReply::ErrorReply(const QByteArray &error) :
+    m_error(error)
+{
+    m_reply.type = REDIS_REPLY_ERROR;
+    m_reply.str = m_error.data();
+    m_reply.len = size_t(m_error.size());
+}
+
+const redisReply *ErrorReply::get() const
+{
+    return &m_reply;
+}
+
+static QByteArray key(int index)
+{
+    return "key:" + QByteArray::number(index);
+}
+
+// Values from Redis Cluster spec and CLUSTER KEYSLOT
+TEST(ClusterSlot, MatchesRedis)
+{
+    EXPECT_EQ(clusterSlot("123456789"), 0x31C3);
+    EXPECT_EQ(clusterSlot("foo"), 12182);
+    EXPECT_EQ(clusterSlot("bar"), 5061);
+    EXPECT_EQ(clusterSlot(""), 0);
+}
+
+TEST(ClusterSlot, HashTag)
+{
+    EXPECT_EQ(clusterSlot("{user1000}.following"), clusterSlot("user1000"));
+    EXPECT_EQ(clusterSlot("{user1000}.following"), clusterSlot("{user1000}.followers"));
+    // Only first {...} counts
+    EXPECT_EQ(clusterSlot("foo{bar}{zap}"), clusterSlot("bar"));
+    EXPECT_EQ(clusterSlot("foo{{bar}}zap"), clusterSlot("{bar"));
+    // Empty or unclosed tag --> whole key
+    EXPECT_EQ(clusterSlot("foo{}{bar}"), 8363);
+    EXPECT_NE(clusterSlot("foo{}{bar}"), clusterSlot("bar"));
+    EXPECT_NE(clusterSlot("foo{bar"), clusterSlot("bar"));
+}
+
+TEST(ClusterSlot, AlwaysInRange)
+{
+    for (int i = 0; i < KEYS; ++i) {
+        EXPECT_LT(clusterSlot(key(i)), 16384);
+    }
+}
+
+TEST(RoutingHash, StableFnv1a)
+{
+    // Not seeded per process: same key goes to same shard after restart
+    EXPECT_EQ(routingHash(""), 2166136261u);
+    EXPECT_EQ(routingHash("a"), 0xe40c292cu);
+    EXPECT_EQ(routingHash("foobar"), 0xbf9cf968u);
+}
+
+TEST(ClusterRedirect, ParsesMoved)
+{
+    ErrorReply reply("MOVED 3999 127.0.0.1:6381");
+    const auto redirect = ClusterRedirect::parse(reply.get());
+    ASSERT_TRUE(redirect.isValid());
+    EXPECT_FALSE(redirect.ask);
+    EXPECT_EQ(redirect.slot, 3999);
+    EXPECT_EQ(redirect.host, "127.0.0.1");
+    EXPECT_EQ(redirect.port, 6381);
+}
+
+TEST(ClusterRedirect, ParsesAsk)
+{
+    ErrorReply reply("ASK 3999 10.0.0.2:7000");
+    const auto redirect = ClusterRedirect::parse(reply.get());
+    ASSERT_TRUE(redirect.isValid());
+    EXPECT_TRUE(redirect.ask);
+    EXPECT_EQ(redirect.host, "10.0.0.2");
+    EXPECT_EQ(redirect.port, 7000);
+}
+
+TEST(ClusterRedirect, UnknownEndpointAndIpv6)
+{
+    // cluster-preferred-endpoint-type unknown-endpoint: same host as the node, that replied
+    const auto sameHost = ClusterRedirect::parse(ErrorReply("MOVED 1 :6380").get());
+    ASSERT_TRUE(sameHost.isValid());
+    EXPECT_TRUE(sameHost.host.isEmpty());
+    EXPECT_EQ(sameHost.port, 6380);
+    const auto ipv6 = ClusterRedirect::parse(ErrorReply("MOVED 2 ::1:6381").get());
+    ASSERT_TRUE(ipv6.isValid());
+    EXPECT_EQ(ipv6.host, "::1");
+    EXPECT_EQ(ipv6.port, 6381);
+}
+
+TEST(ClusterRedirect, OtherErrorsAreNotRedirects)
+{
+    EXPECT_FALSE(ClusterRedirect::parse(nullptr).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("ERR unknown command").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("EXECABORT Transaction discarded").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("CROSSSLOT Keys in request don't hash to the same slot").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("MOVED 3999").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("MOVED x 127.0.0.1:6381").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("MOVED 16384 127.0.0.1:6381").get()).isValid());
+    EXPECT_FALSE(ClusterRedirect::parse(ErrorReply("MOVED 1 127.0.0.1").get()).isValid());
+    redisReply status{};
+    status.type = REDIS_REPLY_STATUS;
+    QByteArray text("MOVED 1 127.0.0.1:6381");
+    status.str = text.data();
+    status.len = size_t(text.size());
+    EXPECT_FALSE(ClusterRedirect::parse(&status).isValid());
+}
+
+TEST(ShardRing, SingleServerIsEmpty)
+{
+    ShardRing ring({"only"}, VIRTUAL_NODES);
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_EQ(ring.shardFor(routingHash("any")), 0);
+}
+
+TEST(ShardRing, SpreadsKeys)
+{
+    const QStringList shards{"a", "b", "c"};
+    ShardRing ring(shards, VIRTUAL_NODES);
+    QVector<int> counts(shards.size(), 0);
+    for (int i = 0; i < KEYS; ++i) {
+        const auto shard = ring.shardFor(routingHash(key(i)));
+        ASSERT_GE(shard, 0);
+        ASSERT_LT(shard, shards.size());
+        ++counts[shard];
+    }
+    for (auto count : counts) {
+        EXPECT_GT(count, KEYS / shards.size() / 2);
+    }
+}
+
+// Keys of a removed shard are spread over the rest, keys of other shards stay in place
+TEST(ShardRing, RemovingShardMovesOnlyItsKeys)
+{
+    ShardRing before({"a", "b", "c"}, VIRTUAL_NODES);
+    ShardRing after({"a", "b"}, VIRTUAL_NODES);
+    int moved = 0;
+    for (int i = 0; i < KEYS; ++i) {
+        const auto hash = routingHash(key(i));
+        const auto was = before.shardFor(hash);
+        if (was != 2) {
+            EXPECT_EQ(after.shardFor(hash), was);
+        } else {
+            ++moved;
+        }
+    }
+    EXPECT_LT(moved, KEYS / 2);
+}
@@ -0,0 +1,18 @@
+#ifndef GTEST_REDISROUTING_H
+#define GTEST_REDISROUTING_H
+
+#include <gtest/gtest.h>
+#include "connectors/redisrouting.h"
+
+//! Error reply, as hiredis gives it for "-<error>\r\n"
+class ErrorReply
+{
+public:
+    explicit ErrorReply(const QByteArray &error);
+    const redisReply *get() const;
+private:
+    QByteArray m_error;
+    redisReply m_reply{};
+};
+
+#endif // GTEST_REDISROUTING_H
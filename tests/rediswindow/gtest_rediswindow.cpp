@@ -0,0 +1,84 @@
+#include "gtest_rediswindow.h"
+
+#define MAX_IN_FLIGHT 4
+
+using namespace Redis;
+
+static void fill(Window &window, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        window.start();
+    }
+}
+
+TEST(Window, UnlimitedNeverFull)
+{
+    Window window;
+    fill(window, 1000);
+    EXPECT_FALSE(window.isFull(1000));
+    EXPECT_TRUE(window.admit(1000));
+    EXPECT_FALSE(window.isBackpressured());
+    EXPECT_EQ(window.rejected(), 0u);
+}
+
+// Checks alone must not inflate rejected_commands
+TEST(Window, CheckDoesNotCount)
+{
+    Window window(MAX_IN_FLIGHT);
+    fill(window, MAX_IN_FLIGHT);
+    EXPECT_TRUE(window.isFull());
+    EXPECT_TRUE(window.isFull(3));
+    EXPECT_EQ(window.rejected(), 0u);
+}
+
+TEST(Window, AdmitCountsRefusedCommands)
+{
+    Window window(MAX_IN_FLIGHT);
+    fill(window, MAX_IN_FLIGHT - 1);
+    EXPECT_TRUE(window.admit(1));
+    EXPECT_FALSE(window.admit(2, 5));
+    EXPECT_EQ(window.rejected(), 5u);
+    window.start();
+    EXPECT_FALSE(window.admit());
+    EXPECT_EQ(window.rejected(), 6u);
+}
+
+// Batch larger than whole window is not starved forever
+TEST(Window, OversizedBatchFitsEmptyWindow)
+{
+    Window window(MAX_IN_FLIGHT);
+    EXPECT_FALSE(window.isFull(MAX_IN_FLIGHT * 3));
+    window.start();
+    EXPECT_TRUE(window.isFull(MAX_IN_FLIGHT * 3));
+}
+
+TEST(Window, BackpressureHysteresis)
+{
+    Window window(MAX_IN_FLIGHT);
+    for (int i = 0; i < MAX_IN_FLIGHT - 1; ++i) {
+        EXPECT_FALSE(window.start());
+    }
+    // Turned on once, when window fills up
+    EXPECT_TRUE(window.start());
+    EXPECT_TRUE(window.isBackpressured());
+    EXPECT_FALSE(window.start());
+    EXPECT_EQ(window.inFlight(), MAX_IN_FLIGHT + 1);
+    // Off only after draining to half
+    EXPECT_FALSE(window.finish());
+    EXPECT_FALSE(window.finish());
+    EXPECT_TRUE(window.isBackpressured());
+    EXPECT_TRUE(window.finish());
+    EXPECT_FALSE(window.isBackpressured());
+    EXPECT_EQ(window.inFlight(), MAX_IN_FLIGHT / 2);
+    EXPECT_FALSE(window.finish());
+}
+
+// Callbacks of commands, that were not counted (e.g. freed context), must not underflow window
+TEST(Window, FinishNeverGoesNegative)
+{
+    Window window(MAX_IN_FLIGHT);
+    EXPECT_FALSE(window.finish());
+    EXPECT_EQ(window.inFlight(), 0);
+    window.start();
+    EXPECT_FALSE(window.isFull());
+}
@@ -0,0 +1,7 @@
+#ifndef GTEST_REDISWINDOW_H
+#define GTEST_REDISWINDOW_H
+
+#include <gtest/gtest.h>
+#include "connectors/rediswindow.h"
+
+#endif // GTEST_REDISWINDOW_H
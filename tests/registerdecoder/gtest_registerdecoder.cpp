@@ -0,0 +1,161 @@
+#include "gtest_registerdecoder.h"
+#include <QElapsedTimer>
+#include <iostream>
+
+#define REPLY_WORDS 125
+#define ROUNDS      20000
+
+using namespace Modbus;
+using Order = QDataStream::ByteOrder;
+
+static Settings::RegisterInfo reg(int index, QMetaType::Type type, Order words, Order bytes)
+{
+    Settings::RegisterInfo result;
+    result.table.value = QModbusDataUnit::HoldingRegisters;
+    result.index.value = index;
+    result.type.value = type;
+    result.endianess.value = Settings::PackingMode(words, bytes);
+    return result;
+}
+
+static JsonKeys::Id key(const QString &name)
+{
+    return JsonKeys::intern(QStringLiteral("decoder:") + name);
+}
+
+class RegisterDecoderOrders : public ::testing::TestWithParam<std::tuple<Order, Order>> {};
+
+TEST_P(RegisterDecoderOrders, MatchesParseModbusType)
+{
+    const auto [words, bytes] = GetParam();
+    RegisterDecoder decoder;
+    const auto ushortReg = reg(0, QMetaType::UShort, words, bytes);
+    const auto uintReg = reg(1, QMetaType::UInt, words, bytes);
+    const auto floatReg = reg(3, QMetaType::Float, words, bytes);
+    decoder.add(ushortReg, key("ushort"));
+    decoder.add(uintReg, key("uint"));
+    decoder.add(floatReg, key("float"));
+    // Asymmetric bytes and words, so any missed or extra swap changes values
+    const QVector<quint16> reply{0x1234, 0x1122, 0x3344, 0x4049, 0x0fd0};
+
+    FlatJson decoded;
+    RegisterDecoder::decode(decoder.planFor(QModbusDataUnit::HoldingRegisters, 0, reply.size()), reply.constData(), decoded);
+    ASSERT_EQ(decoded.size(), 3);
+
+    auto copy = reply;
+    EXPECT_EQ(decoded.value(key("ushort")), parseModbusType(copy.data(), ushortReg, 1));
+    EXPECT_EQ(decoded.value(key("uint")), parseModbusType(copy.data() + 1, uintReg, 2));
+    EXPECT_EQ(decoded.value(key("float")), parseModbusType(copy.data() + 3, floatReg, 2));
+    // Reply itself is not touched
+    EXPECT_EQ(reply[0], 0x1234);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllOrders, RegisterDecoderOrders, ::testing::Combine(
+    ::testing::Values(Order::BigEndian, Order::LittleEndian),
+    ::testing::Values(Order::BigEndian, Order::LittleEndian)));
+
+TEST(RegisterDecoder, SkipsOverlappedAndCutOffRegisters)
+{
+    RegisterDecoder decoder;
+    decoder.add(reg(0, QMetaType::UInt, Order::BigEndian, Order::BigEndian), key("wide"));
+    // Second word of "wide"
+    decoder.add(reg(1, QMetaType::UShort, Order::BigEndian, Order::BigEndian), key("overlapped"));
+    decoder.add(reg(2, QMetaType::Float, Order::BigEndian, Order::BigEndian), key("cut"));
+    const auto &plan = decoder.planFor(QModbusDataUnit::HoldingRegisters, 0, 3);
+    ASSERT_EQ(plan.fields.size(), 1);
+    EXPECT_EQ(plan.fields[0].key, key("wide"));
+    EXPECT_EQ(plan.words, 2);
+    EXPECT_EQ(decoder.plansCount(), 1);
+    decoder.planFor(QModbusDataUnit::HoldingRegisters, 0, 3);
+    EXPECT_EQ(decoder.plansCount(), 1);
+}
+
+TEST(RegisterDecoder, OffsetsAreRelativeToReplyStart)
+{
+    RegisterDecoder decoder;
+    decoder.add(reg(100, QMetaType::UShort, Order::BigEndian, Order::BigEndian), key("at100"));
+    const quint16 reply[] = {1, 2, 3};
+    FlatJson decoded;
+    RegisterDecoder::decode(decoder.planFor(QModbusDataUnit::HoldingRegisters, 98, 3), reply, decoded);
+    EXPECT_EQ(decoded.value(key("at100")).toUInt(), 3u);
+    EXPECT_TRUE(decoder.planFor(QModbusDataUnit::InputRegisters, 98, 3).fields.isEmpty());
+}
+
+// Same as Master::onReadReady() did before decode plans: lookups per word, swaps per value
+struct OldDecoder {
+    QHash<QModbusDataUnit::RegisterType, QHash<int, QString>> reverseRegisters;
+    QHash<QModbusDataUnit::RegisterType, QHash<int, JsonKeys::Id>> reverseKeys;
+    QMap<QString, Settings::RegisterInfo> registers;
+
+    void decode(const QModbusDataUnit &unit, FlatJson &resultJson) {
+        auto words = unit.values();
+        auto table = unit.registerType();
+        resultJson.reserve(words.size());
+        for (int i = 0; i < words.size();) {
+            auto index = unit.startAddress() + i;
+            if (!reverseRegisters[table].contains(index)) {
+                ++i;
+                continue;
+            }
+            const auto &registersName = reverseRegisters[table][index];
+            const auto &regData = registers[registersName];
+            auto sizeWords = QMetaType(regData.type).sizeOf()/2;
+            if (i + sizeWords > words.size()) {
+                break;
+            }
+            auto result = parseModbusType(words.data() + i, regData, sizeWords);
+            i += sizeWords;
+            resultJson.insert(reverseKeys[table][index], std::move(result));
+        }
+    }
+};
+
+TEST(RegisterDecoder, PlanVsOldDecoder)
+{
+    RegisterDecoder decoder;
+    OldDecoder old;
+    for (int index = 0; index < REPLY_WORDS;) {
+        const auto type = index % 3 == 0 ? QMetaType::UShort : index % 3 == 1 ? QMetaType::Float : QMetaType::UInt;
+        const auto words = type == QMetaType::UShort ? 1 : 2;
+        if (index + words > REPLY_WORDS) break;
+        const auto info = reg(index, type, Order::LittleEndian, (index / 2) % 2 ? Order::LittleEndian : Order::BigEndian);
+        const auto name = QStringLiteral("bench:reg_%1").arg(index);
+        const auto id = JsonKeys::intern(name);
+        decoder.add(info, id);
+        old.reverseRegisters[info.table][index] = name;
+        old.reverseKeys[info.table][index] = id;
+        old.registers[name] = info;
+        index += words;
+    }
+    QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, 0, REPLY_WORDS);
+    for (int i = 0; i < REPLY_WORDS; ++i) {
+        unit.setValue(i, quint16(i * 2654435761u));
+    }
+    FlatJson expected, actual;
+    old.decode(unit, expected);
+    const auto words = unit.values();
+    RegisterDecoder::decode(decoder.planFor(unit.registerType(), 0, REPLY_WORDS), words.constData(), actual);
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_TRUE(actual.diff(expected).isEmpty());
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < ROUNDS; ++round) {
+        FlatJson json;
+        old.decode(unit, json);
+    }
+    const auto oldUs = timer.nsecsElapsed() / 1000;
+    timer.restart();
+    for (int round = 0; round < ROUNDS; ++round) {
+        FlatJson json;
+        const auto values = unit.values();
+        RegisterDecoder::decode(decoder.planFor(unit.registerType(), 0, REPLY_WORDS), values.constData(), json);
+    }
+    const auto planUs = timer.nsecsElapsed() / 1000;
+
+    std::cout << REPLY_WORDS << " words x" << ROUNDS << ": old decoder: " << oldUs << " us; "
+              << "decode plan: " << planUs << " us; "
+              << "speedup: x" << double(oldUs) / double(qMax<qint64>(planUs, 1)) << std::endl;
+    RecordProperty("old_us", int(oldUs));
+    RecordProperty("plan_us", int(planUs));
+}
@@ -0,0 +1,9 @@
+#ifndef GTEST_REGISTERDECODER_H
+#define GTEST_REGISTERDECODER_H
+
+#include <gtest/gtest.h>
+#include "modbus/modbusdecodeplan.h"
+#include "modbus/modbusparsing.h"
+#include "settings/modbussettings.h"
+
+#endif // GTEST_REGISTERDECODER_H
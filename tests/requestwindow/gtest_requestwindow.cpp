@@ -0,0 +1,95 @@
+#include "gtest_requestwindow.h"
+
+using namespace Modbus;
+
+//! Same as Master::fillWindow() with queues, that never run dry. \return requests sent
+static int fill(RequestWindow &window)
+{
+    int sent = 0;
+    while (window.take()) {
+        window.sent();
+        ++sent;
+    }
+    return sent;
+}
+
+TEST(RequestWindow, RtuSendsOneRequestPerTrigger)
+{
+    RequestWindow window;
+    EXPECT_EQ(window.maxInflight(), 1);
+    window.startTrigger(5);
+    EXPECT_EQ(fill(window), 1);
+    EXPECT_TRUE(window.done());
+    // Master does not refill on RTU: channel gets the bus back after every request
+    window.startTrigger(4);
+    EXPECT_EQ(fill(window), 1);
+}
+
+TEST(RequestWindow, WindowCapsInflight)
+{
+    RequestWindow window(4);
+    window.startTrigger(10);
+    EXPECT_EQ(fill(window), 4);
+    EXPECT_EQ(window.inflight(), 4);
+    EXPECT_FALSE(window.done());
+    EXPECT_EQ(fill(window), 1);
+    EXPECT_EQ(window.inflight(), 4);
+}
+
+TEST(RequestWindow, BudgetIsWhatWasQueuedAtTrigger)
+{
+    RequestWindow window(4);
+    window.startTrigger(6);
+    int sent = fill(window);
+    // Requests queued after trigger do not extend it: refills stop after 6
+    while (window.inflight()) {
+        window.done();
+        sent += fill(window);
+    }
+    EXPECT_EQ(sent, 6);
+    EXPECT_FALSE(window.take());
+}
+
+TEST(RequestWindow, ChannelIsReleasedWhenLastReplyComes)
+{
+    RequestWindow window(3);
+    window.startTrigger(2);
+    EXPECT_EQ(fill(window), 2);
+    EXPECT_FALSE(window.done());
+    EXPECT_TRUE(window.done());
+    EXPECT_EQ(window.inflight(), 0);
+}
+
+TEST(RequestWindow, RequestNotSentKeepsWindowFree)
+{
+    RequestWindow window(2);
+    window.startTrigger(3);
+    ASSERT_TRUE(window.take());
+    // Send failed (e.g. device gone): budget is spent, nothing is in flight
+    EXPECT_EQ(window.inflight(), 0);
+    EXPECT_EQ(fill(window), 2);
+    EXPECT_FALSE(window.take());
+}
+
+TEST(RequestWindow, EmptyTriggerSendsNothing)
+{
+    RequestWindow window(4);
+    window.startTrigger(0);
+    EXPECT_FALSE(window.take());
+    EXPECT_TRUE(window.done());
+}
+
+TEST(RequestWindow, ExtraRepliesDoNotUnderflow)
+{
+    RequestWindow window(2);
+    EXPECT_TRUE(window.done());
+    window.startTrigger(2);
+    EXPECT_EQ(fill(window), 2);
+    EXPECT_EQ(window.inflight(), 2);
+}
+
+TEST(RequestWindow, NonPositiveMaxIsOne)
+{
+    EXPECT_EQ(RequestWindow(0).maxInflight(), 1);
+    EXPECT_EQ(RequestWindow(-3).maxInflight(), 1);
+}
@@ -0,0 +1,7 @@
+#ifndef GTEST_REQUESTWINDOW_H
+#define GTEST_REQUESTWINDOW_H
+
+#include <gtest/gtest.h>
+#include "modbus/modbusrequestwindow.h"
+
+#endif // GTEST_REQUESTWINDOW_H
@@ -0,0 +1,2 @@
+RSK_TEST_NAME = requestwindow
+include(../gtests.pri)
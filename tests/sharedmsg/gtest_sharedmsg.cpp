@@ -0,0 +1,177 @@
+#include "gtest_sharedmsg.h"
+#include "filters/namespacefilter.h"
+#include "filters/producerfilter.h"
+#include "filters/producerfiltersettings.hpp"
+#include "interceptors/duplicatinginterceptor.h"
+#include "interceptors/namespaceunwrapper.h"
+#include "interceptors/validatinginterceptor.h"
+#include "interceptors/settings/duplicatinginterseptorsettings.h"
+#include "interceptors/settings/namespaceunwrappersettings.h"
+#include "interceptors/settings/validatinginterceptorsettings.h"
+#include "validators/common_validators.h"
+
+using namespace Radapter;
+
+Emitted::Emitted(Interceptor *interceptor)
+{
+    QObject::connect(interceptor, &Interceptor::msgFromWorker, [this](WorkerMsg &msg){
+        m_msgs.append(msg);
+    });
+}
+
+const QList<WorkerMsg> &Emitted::msgs() const
+{
+    return m_msgs;
+}
+
+//! Msg, that is also held by other pipes of a fan-out
+static WorkerMsg sample()
+{
+    WorkerMsg msg;
+    msg.setJson(JsonDict(QVariantMap{
+        {"plc", QVariantMap{{"temp", 20.5}, {"mode", "auto"}}},
+        {"meta", QVariantMap{{"source", "test"}}}
+    }));
+    return msg;
+}
+
+static const QVariantMap &payload(const WorkerMsg &msg)
+{
+    return msg.json();
+}
+
+static bool sharesJson(const WorkerMsg &msg, const WorkerMsg &other)
+{
+    return payload(msg).isSharedWith(payload(other));
+}
+
+static bool sharesSubtree(const WorkerMsg &msg, const WorkerMsg &other, const QString &key)
+{
+    return msg[key].toMap().isSharedWith(other[key].toMap());
+}
+
+TEST(SharedMsg, ServiceAccessorsDoNotDetach)
+{
+    auto msg = sample();
+    const auto copy = msg;
+    EXPECT_EQ(msg.command(), nullptr);
+    EXPECT_EQ(msg.reply(), nullptr);
+    EXPECT_FALSE(msg.replyIgnored());
+    EXPECT_TRUE(sharesJson(msg, copy));
+}
+
+TEST(SharedMsg, NamespaceFilterSharesSubtree)
+{
+    NamespaceFilter filter("plc");
+    Emitted emitted(&filter);
+    auto msg = sample();
+    const auto copy = msg;
+    filter.onMsgFromWorker(msg);
+    ASSERT_EQ(emitted.msgs().size(), 1);
+    const auto &filtered = emitted.msgs().first();
+    EXPECT_FALSE(filtered.contains(QStringLiteral("meta")));
+    EXPECT_TRUE(sharesJson(msg, copy));
+    EXPECT_TRUE(sharesSubtree(filtered, copy, "plc"));
+}
+
+TEST(SharedMsg, NamespaceFilterSkipsWithoutDetach)
+{
+    NamespaceFilter filter("other");
+    Emitted emitted(&filter);
+    auto msg = sample();
+    const auto copy = msg;
+    filter.onMsgFromWorker(msg);
+    EXPECT_TRUE(emitted.msgs().isEmpty());
+    EXPECT_TRUE(sharesJson(msg, copy));
+}
+
+TEST(SharedMsg, DuplicatingInterceptorDetachesOnlyTarget)
+{
+    Settings::DuplicatingInterceptor settings;
+    settings.update({{"by_field", QVariantMap{{"plc:temp", QStringList{"copy:temp"}}}}});
+    DuplicatingInterceptor interceptor(settings);
+    Emitted emitted(&interceptor);
+    auto msg = sample();
+    const auto copy = msg;
+    interceptor.onMsgFromWorker(msg);
+    ASSERT_EQ(emitted.msgs().size(), 1);
+    EXPECT_EQ(emitted.msgs().first()[QStringList{"copy", "temp"}], 20.5);
+    EXPECT_FALSE(copy.contains(QStringLiteral("copy")));
+    // Source of duplicate was only read
+    EXPECT_TRUE(sharesSubtree(msg, copy, "plc"));
+    EXPECT_TRUE(sharesSubtree(msg, copy, "meta"));
+}
+
+TEST(SharedMsg, NamespaceUnwrapperSharesSubtree)
+{
+    Settings::NamespaceUnwrapper settings;
+    settings.update({{"unwrap_from", "plc"}});
+    NamespaceUnwrapper interceptor(settings);
+    Emitted emitted(&interceptor);
+    auto msg = sample();
+    const auto copy = msg;
+    interceptor.onMsgFromWorker(msg);
+    ASSERT_EQ(emitted.msgs().size(), 1);
+    const auto &unwrapped = emitted.msgs().first();
+    EXPECT_EQ(unwrapped[QStringLiteral("mode")], "auto");
+    EXPECT_TRUE(payload(unwrapped).isSharedWith(copy[QStringLiteral("plc")].toMap()));
+}
+
+class SharedMsgValidating : public testing::Test
+{
+protected:
+    static void SetUpTestSuite() {
+        Validator::registerAllCommon();
+    }
+};
+
+TEST_F(SharedMsgValidating, ValidMsgPassesShared)
+{
+    Settings::ValidatingInterceptor settings;
+    settings.update({{"by_field", QVariantMap{{"other:field", "invalidate"}}}});
+    ValidatingInterceptor interceptor(settings);
+    Emitted emitted(&interceptor);
+    auto msg = sample();
+    const auto copy = msg;
+    interceptor.onMsgFromWorker(msg);
+    ASSERT_EQ(emitted.msgs().size(), 1);
+    EXPECT_TRUE(sharesJson(emitted.msgs().first(), copy));
+}
+
+TEST_F(SharedMsgValidating, InvalidFieldDetachesOnlyItsPath)
+{
+    Settings::ValidatingInterceptor settings;
+    settings.update({{"by_field", QVariantMap{{"meta:source", "invalidate"}}}});
+    ValidatingInterceptor interceptor(settings);
+    Emitted emitted(&interceptor);
+    auto msg = sample();
+    const auto copy = msg;
+    interceptor.onMsgFromWorker(msg);
+    ASSERT_EQ(emitted.msgs().size(), 1);
+    const auto &validated = emitted.msgs().first();
+    EXPECT_FALSE(validated.contains(QStringList{"meta", "source"}));
+    EXPECT_EQ(validated[QStringList{"plc", "temp"}], 20.5);
+    EXPECT_EQ(copy[QStringList{"meta", "source"}], "test");
+}
+
+TEST(SharedMsg, ProducerFilterReadsWithoutDetach)
+{
+    Settings::ProducerFilter settings;
+    settings.update({{"by_field", QVariantMap{{"plc:temp", 1.0}, {"plc:mode", 0.0}, {"meta:source", 0.0}}}});
+    ProducerFilter filter(settings);
+    Emitted emitted(&filter);
+    auto first = sample();
+    const auto firstCopy = first;
+    filter.onMsgFromWorker(first);
+    ASSERT_FALSE(emitted.msgs().isEmpty());
+    EXPECT_TRUE(sharesJson(emitted.msgs().first(), firstCopy));
+    EXPECT_TRUE(sharesJson(first, firstCopy));
+    // Change below threshold: filtered out, still not detached
+    auto second = sample();
+    second[QStringList{"plc", "temp"}] = 20.7;
+    const auto secondCopy = second;
+    const auto emittedBefore = emitted.msgs().size();
+    filter.onMsgFromWorker(second);
+    EXPECT_EQ(emitted.msgs().size(), emittedBefore);
+    EXPECT_TRUE(sharesJson(second, secondCopy));
+}
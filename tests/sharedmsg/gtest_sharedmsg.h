@@ -0,0 +1,18 @@
+#ifndef GTEST_SHAREDMSG_H
+#define GTEST_SHAREDMSG_H
+
+#include <gtest/gtest.h>
+#include "broker/workers/private/workermsg.h"
+#include "broker/interceptor/interceptor.h"
+
+//! Collects msgs, that interceptor passed further
+class Emitted
+{
+public:
+    explicit Emitted(Radapter::Interceptor *interceptor);
+    const QList<Radapter::WorkerMsg> &msgs() const;
+private:
+    QList<Radapter::WorkerMsg> m_msgs;
+};
+
+#endif // GTEST_SHAREDMSG_H
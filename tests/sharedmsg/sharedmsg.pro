@@ -0,0 +1,2 @@
+RSK_TEST_NAME = sharedmsg
+include(../gtests.pri)
@@ -0,0 +1,150 @@
+#include "gtest_spillfile.h"
+#include "formatting/redis/rediscommandargs.h"
+#include <QFileInfo>
+
+#define MAX_BYTES   (1024 * 1024)
+
+using namespace Redis;
+
+void SpillFileTest::SetUp()
+{
+    ASSERT_TRUE(m_dir.isValid());
+}
+
+QString SpillFileTest::path() const
+{
+    return m_dir.filePath("spill.bin");
+}
+
+static CommandArgs command(int index)
+{
+    auto result = CommandArgs{"SET"}.appendKey(QStringLiteral("key:%1").arg(index));
+    result << index;
+    return result;
+}
+
+void SpillFileTest::fill(SpillFile &spill, int from, int to)
+{
+    for (int i = from; i < to; ++i) {
+        auto cmd = command(i);
+        ASSERT_TRUE(spill.append(cmd.routingKey(), cmd.encoded()));
+    }
+}
+
+static void expectRecords(const QVector<SpillFile::Record> &records, int from)
+{
+    for (int i = 0; i < records.size(); ++i) {
+        auto expected = command(from + i);
+        EXPECT_EQ(records[i].key, expected.routingKey().toByteArray());
+        EXPECT_EQ(records[i].command, expected.encoded().toByteArray());
+    }
+}
+
+TEST_F(SpillFileTest, WriteThenReplayInOrder)
+{
+    SpillFile spill(path(), MAX_BYTES);
+    ASSERT_TRUE(spill.open());
+    EXPECT_TRUE(spill.isEmpty());
+    fill(spill, 0, 10);
+    EXPECT_EQ(spill.count(), 10);
+    EXPECT_GT(spill.bytes(), 0);
+
+    QVector<SpillFile::Record> records;
+    auto offset = spill.peek(4, records);
+    ASSERT_EQ(records.size(), 4);
+    expectRecords(records, 0);
+    // Peek does not remove: same records until commit
+    EXPECT_EQ(spill.peek(4, records), offset);
+    spill.commit(offset, records.size());
+    EXPECT_EQ(spill.count(), 6);
+
+    offset = spill.peek(100, records);
+    ASSERT_EQ(records.size(), 6);
+    expectRecords(records, 4);
+    spill.commit(offset, records.size());
+    EXPECT_TRUE(spill.isEmpty());
+    EXPECT_EQ(spill.bytes(), 0);
+}
+
+TEST_F(SpillFileTest, ReopenResumesFromCommittedHead)
+{
+    {
+        SpillFile spill(path(), MAX_BYTES);
+        ASSERT_TRUE(spill.open());
+        fill(spill, 0, 5);
+        QVector<SpillFile::Record> records;
+        spill.commit(spill.peek(2, records), 2);
+    }
+    SpillFile reopened(path(), MAX_BYTES);
+    ASSERT_TRUE(reopened.open());
+    EXPECT_EQ(reopened.count(), 3);
+    QVector<SpillFile::Record> records;
+    reopened.peek(100, records);
+    ASSERT_EQ(records.size(), 3);
+    expectRecords(records, 2);
+}
+
+TEST_F(SpillFileTest, TornTailIsDropped)
+{
+    qint64 intactSize = 0;
+    {
+        SpillFile spill(path(), MAX_BYTES);
+        ASSERT_TRUE(spill.open());
+        fill(spill, 0, 3);
+        intactSize = QFileInfo(path()).size();
+        fill(spill, 3, 4);
+    }
+    // Crash in the middle of the last record
+    QFile file(path());
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(file.resize(file.size() - 3));
+    file.close();
+
+    SpillFile spill(path(), MAX_BYTES);
+    ASSERT_TRUE(spill.open());
+    EXPECT_EQ(spill.count(), 3);
+    EXPECT_EQ(QFileInfo(path()).size(), intactSize);
+    QVector<SpillFile::Record> records;
+    spill.peek(100, records);
+    ASSERT_EQ(records.size(), 3);
+    expectRecords(records, 0);
+    // Appends go right after the intact records
+    fill(spill, 3, 4);
+    spill.peek(100, records);
+    ASSERT_EQ(records.size(), 4);
+    expectRecords(records, 0);
+}
+
+TEST_F(SpillFileTest, CorruptedRecordDropsItAndRest)
+{
+    {
+        SpillFile spill(path(), MAX_BYTES);
+        ASSERT_TRUE(spill.open());
+        fill(spill, 0, 3);
+    }
+    QFile file(path());
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    // Last byte of last record (inside its command)
+    ASSERT_TRUE(file.seek(file.size() - 3));
+    ASSERT_EQ(file.write("X", 1), 1);
+    file.close();
+
+    SpillFile spill(path(), MAX_BYTES);
+    ASSERT_TRUE(spill.open());
+    EXPECT_EQ(spill.count(), 2);
+}
+
+TEST_F(SpillFileTest, FullFileRefusesAppends)
+{
+    auto cmd = command(0);
+    // Header + one record fits
+    SpillFile spill(path(), 8 + 10 + cmd.routingKey().size() + cmd.encoded().size());
+    ASSERT_TRUE(spill.open());
+    fill(spill, 0, 1);
+    EXPECT_FALSE(spill.append(cmd.routingKey(), cmd.encoded()));
+    EXPECT_EQ(spill.count(), 1);
+    QVector<SpillFile::Record> records;
+    spill.commit(spill.peek(1, records), 1);
+    // Replayed --> file starts over, so there is room again
+    EXPECT_TRUE(spill.append(cmd.routingKey(), cmd.encoded()));
+}
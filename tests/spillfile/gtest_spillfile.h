@@ -0,0 +1,19 @@
+#ifndef GTEST_SPILLFILE_H
+#define GTEST_SPILLFILE_H
+
+#include <gtest/gtest.h>
+#include "connectors/redisspillfile.h"
+#include <QTemporaryDir>
+
+class SpillFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    QString path() const;
+    //! Appends "SET key:<index> <index>" commands
+    void fill(Redis::SpillFile &spill, int from, int to);
+
+    QTemporaryDir m_dir;
+};
+
+#endif // GTEST_SPILLFILE_H
@@ -0,0 +1,92 @@
+#include "gtest_streambatchbench.h"
+#include <QElapsedTimer>
+#include <iostream>
+
+#define MESSAGES    20000
+#define BATCH       100
+#define STREAM_SIZE 1000000u
+
+using namespace Redis;
+
+void StreamBatchBench::SetUp()
+{
+    const auto host = qEnvironmentVariable("REDIS_HOST", "127.0.0.1").toStdString();
+    const auto port = qEnvironmentVariableIntValue("REDIS_PORT");
+    m_ctx = redisConnect(host.c_str(), port ? port : 6379);
+    if (!m_ctx || m_ctx->err) {
+        GTEST_SKIP() << "Redis is not available at " << host;
+    }
+    m_stream = QStringLiteral("bench:streambatch");
+}
+
+void StreamBatchBench::TearDown()
+{
+    if (m_ctx) {
+        freeReplyObject(redisCommand(m_ctx, "DEL %s", qPrintable(m_stream)));
+        redisFree(m_ctx);
+    }
+}
+
+qint64 StreamBatchBench::sendPipelined(const QList<CommandArgs> &commands)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &command : commands) {
+        auto encoded = command.encoded();
+        redisAppendFormattedCommand(m_ctx, encoded.data(), size_t(encoded.size()));
+    }
+    for (int i = 0; i < commands.size(); ++i) {
+        void *reply = nullptr;
+        EXPECT_EQ(redisGetReply(m_ctx, &reply), REDIS_OK);
+        freeReplyObject(reply);
+    }
+    return timer.nsecsElapsed() / 1000;
+}
+
+qint64 StreamBatchBench::streamLength()
+{
+    auto reply = static_cast<redisReply*>(redisCommand(m_ctx, "XLEN %s", qPrintable(m_stream)));
+    const auto result = reply ? reply->integer : -1;
+    freeReplyObject(reply);
+    return result;
+}
+
+static JsonDict message(int index)
+{
+    return JsonDict(QVariantMap{{"sensor", QVariantMap{{"index", index}, {"value", index * 0.5}}}});
+}
+
+// max_batch: 1 --> one XADD (with MAXLEN) and one round trip per message
+TEST_F(StreamBatchBench, PerMessageVsBatchedXadd)
+{
+    QElapsedTimer timer;
+    timer.start();
+    CommandArgs command;
+    for (int i = 0; i < MESSAGES; ++i) {
+        addToStream(command, m_stream, message(i), STREAM_SIZE);
+        sendPipelined({command});
+    }
+    const auto perMessageUs = timer.nsecsElapsed() / 1000;
+    EXPECT_EQ(streamLength(), MESSAGES);
+
+    freeReplyObject(redisCommand(m_ctx, "DEL %s", qPrintable(m_stream)));
+    // Same as StreamProducer::flushBatch(): MULTI, XADDs, trim, EXEC in one write
+    qint64 batchedUs = 0;
+    for (int sent = 0; sent < MESSAGES; sent += BATCH) {
+        QList<CommandArgs> batch{CommandArgs{"MULTI"}};
+        for (int i = sent; i < sent + BATCH; ++i) {
+            addToStream(command, m_stream, message(i), 0u);
+            batch.append(command);
+        }
+        batch.append(trimStream(m_stream, STREAM_SIZE));
+        batch.append(CommandArgs{"EXEC"});
+        batchedUs += sendPipelined(batch);
+    }
+    EXPECT_EQ(streamLength(), MESSAGES);
+
+    std::cout << "XADD x" << MESSAGES << ": per message: " << perMessageUs << " us; "
+              << "batches of " << BATCH << ": " << batchedUs << " us; "
+              << "speedup: x" << double(perMessageUs) / double(qMax<qint64>(batchedUs, 1)) << std::endl;
+    RecordProperty("per_message_us", int(perMessageUs));
+    RecordProperty("batched_us", int(batchedUs));
+}
@@ -0,0 +1,23 @@
+#ifndef GTEST_STREAMBATCHBENCH_H
+#define GTEST_STREAMBATCHBENCH_H
+
+#include <gtest/gtest.h>
+#include "lib/hiredis/hiredis.h"
+#include "formatting/redis/redisstreamqueries.h"
+#include "jsondict/jsondict.h"
+
+//! Needs redis at REDIS_HOST:REDIS_PORT (default 127.0.0.1:6379), skipped otherwise
+class StreamBatchBench : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    //! Sends all commands, then reads all replies. \return microseconds
+    qint64 sendPipelined(const QList<Redis::CommandArgs> &commands);
+    qint64 streamLength();
+
+    redisContext *m_ctx{nullptr};
+    QString m_stream;
+};
+
+#endif // GTEST_STREAMBATCHBENCH_H
@@ -0,0 +1,2 @@
+RSK_TEST_NAME = streambatchbench
+include(../gtests.pri)
@@ -0,0 +1,233 @@
+#include "gtest_streamreplies.h"
+
+using namespace Redis;
+
+RespReply::RespReply(const QByteArray &resp)
+{
+    auto reader = redisReaderCreate();
+    redisReaderFeed(reader, resp.constData(), size_t(resp.size()));
+    void *reply = nullptr;
+    EXPECT_EQ(redisReaderGetReply(reader, &reply), REDIS_OK);
+    EXPECT_NE(reply, nullptr) << "Incomplete RESP: " << resp.constData();
+    m_reply = static_cast<redisReply*>(reply);
+    redisReaderFree(reader);
+}
+
+RespReply::~RespReply()
+{
+    freeReplyObject(m_reply);
+}
+
+const redisReply *RespReply::get() const
+{
+    return m_reply;
+}
+
+// [id, [field, value]]
+static QByteArray entry(const QByteArray &id, const QByteArray &field, const QByteArray &value)
+{
+    return "*2\r\n$" + QByteArray::number(id.size()) + "\r\n" + id + "\r\n"
+           "*2\r\n$" + QByteArray::number(field.size()) + "\r\n" + field + "\r\n"
+           "$" + QByteArray::number(value.size()) + "\r\n" + value + "\r\n";
+}
+
+TEST(AutoClaimReply, Redis7ListsDeletedApart)
+{
+    RespReply reply("*3\r\n"
+                    "$3\r\n5-0\r\n"
+                    "*2\r\n" + entry("1-0", "a", "1") + entry("3-0", "b", "2") +
+                    "*2\r\n$3\r\n2-0\r\n$3\r\n4-0\r\n");
+    AutoClaimReply claimed(reply.get());
+    ASSERT_TRUE(claimed.isValid());
+    EXPECT_EQ(claimed.cursor, "5-0");
+    EXPECT_EQ(claimed.entries->elements, 2u);
+    EXPECT_EQ(claimed.claimedIds, (QSet<QString>{"1-0", "3-0"}));
+    EXPECT_EQ(claimed.deletedIds, (QStringList{"2-0", "4-0"}));
+    EXPECT_EQ(claimed.unknownDeleted, 0);
+}
+
+TEST(AutoClaimReply, Redis62ReturnsDeletedAsNil)
+{
+    RespReply reply("*2\r\n"
+                    "$3\r\n0-0\r\n"
+                    "*3\r\n" + entry("1-0", "a", "1") + "*-1\r\n" + entry("3-0", "b", "2"));
+    AutoClaimReply claimed(reply.get());
+    ASSERT_TRUE(claimed.isValid());
+    EXPECT_EQ(claimed.cursor, "0-0");
+    EXPECT_EQ(claimed.claimedIds, (QSet<QString>{"1-0", "3-0"}));
+    EXPECT_TRUE(claimed.deletedIds.isEmpty());
+    EXPECT_EQ(claimed.unknownDeleted, 1);
+    // Nil entry is skipped on delivery
+    EXPECT_FALSE(StreamEntry(claimed.entries->element[1]).isValid());
+}
+
+TEST(AutoClaimReply, EntryWithNilFieldsIsDeleted)
+{
+    RespReply reply("*2\r\n"
+                    "$3\r\n0-0\r\n"
+                    "*2\r\n" + entry("1-0", "a", "1") + "*2\r\n$3\r\n2-0\r\n*-1\r\n");
+    AutoClaimReply claimed(reply.get());
+    ASSERT_TRUE(claimed.isValid());
+    EXPECT_EQ(claimed.claimedIds, QSet<QString>{"1-0"});
+    EXPECT_EQ(claimed.deletedIds, QStringList{"2-0"});
+    EXPECT_EQ(claimed.unknownDeleted, 0);
+}
+
+TEST(AutoClaimReply, ErrorIsNotValid)
+{
+    RespReply reply("-ERR unknown command 'XAUTOCLAIM'\r\n");
+    EXPECT_FALSE(AutoClaimReply(reply.get()).isValid());
+    EXPECT_FALSE(AutoClaimReply(nullptr).isValid());
+}
+
+// [id, consumer, idle ms, deliveries]
+static QByteArray pending(const QByteArray &id, int idleMs)
+{
+    const auto idle = QByteArray::number(idleMs);
+    return "*4\r\n$" + QByteArray::number(id.size()) + "\r\n" + id + "\r\n"
+           "$8\r\nconsumer\r\n"
+           ":" + idle + "\r\n"
+           ":2\r\n";
+}
+
+TEST(RecentlyClaimed, OnlyJustClaimedAndNotDelivered)
+{
+    // 1-0 delivered by claim, 2-0 deleted (claimed now), 3-0 own entry of previous run (idle for long)
+    RespReply reply("*3\r\n" + pending("1-0", 5) + pending("2-0", 5) + pending("3-0", 60000));
+    EXPECT_EQ(recentlyClaimed(reply.get(), 100, {"1-0"}), QStringList{"2-0"});
+}
+
+TEST(RecentlyClaimed, NotArray)
+{
+    RespReply reply("-NOGROUP No such key\r\n");
+    EXPECT_TRUE(recentlyClaimed(reply.get(), 100, {}).isEmpty());
+}
+
+TEST(StreamEntry, DecodesIdAndNestedFields)
+{
+    RespReply reply("*2\r\n$15\r\n1526919030474-55\r\n"
+                    "*6\r\n$11\r\nsensor:temp\r\n$4\r\n21.5\r\n$10\r\nsensor:hum\r\n$2\r\n40\r\n$5\r\nstate\r\n$2\r\nok\r\n");
+    StreamEntry parsed(reply.get());
+    ASSERT_TRUE(parsed.isValid());
+    EXPECT_EQ(parsed.timestamp, 1526919030474u);
+    EXPECT_EQ(parsed.id, 55u);
+    EXPECT_EQ(parsed.streamId(), "1526919030474-55");
+    EXPECT_EQ(parsed.values.value("sensor:temp"), QVariant("21.5"));
+    EXPECT_EQ(parsed.values.value("sensor:hum"), QVariant("40"));
+    EXPECT_EQ(parsed.values.value("state"), QVariant("ok"));
+}
+
+// Straight decoding must give same result as old path through parsed QVariantList
+TEST(StreamEntry, SameAsFromVariantList)
+{
+    RespReply reply(entry("7-3", "a:b", "1"));
+    StreamEntry fromReply(reply.get());
+    StreamEntry fromList(QVariantList{"7-3", QVariantList{"a:b", "1"}});
+    ASSERT_TRUE(fromReply.isValid());
+    EXPECT_EQ(fromReply.streamId(), fromList.streamId());
+    EXPECT_EQ(fromReply.values, fromList.values);
+}
+
+TEST(StreamEntry, BinarySafeUtf8Values)
+{
+    const auto value = QByteArray("\xd0\xbf\xd1\x80\xd0\xb8\r\n\0x", 10);
+    RespReply reply(entry("1-1", "text", value));
+    StreamEntry parsed(reply.get());
+    ASSERT_TRUE(parsed.isValid());
+    EXPECT_EQ(parsed.values.value("text").toString(), QString::fromUtf8(value));
+}
+
+TEST(StreamEntry, EmptyFieldsAreValid)
+{
+    RespReply reply("*2\r\n$3\r\n1-0\r\n*0\r\n");
+    StreamEntry parsed(reply.get());
+    EXPECT_TRUE(parsed.isValid());
+    EXPECT_TRUE(parsed.values.isEmpty());
+}
+
+TEST(StreamEntry, MalformedIdsAreNotValid)
+{
+    for (const QByteArray id : {"abc", "12", "12-", "-3", "1-x"}) {
+        RespReply reply(entry(id, "a", "1"));
+        EXPECT_FALSE(StreamEntry(reply.get()).isValid()) << id.constData();
+    }
+}
+
+TEST(StreamEntry, WrongShapesAreNotValid)
+{
+    RespReply nil("*-1\r\n");
+    EXPECT_FALSE(StreamEntry(nil.get()).isValid());
+    RespReply noFields("*1\r\n$3\r\n1-0\r\n");
+    EXPECT_FALSE(StreamEntry(noFields.get()).isValid());
+    RespReply error("-ERR wrong\r\n");
+    EXPECT_FALSE(StreamEntry(error.get()).isValid());
+    EXPECT_FALSE(StreamEntry(static_cast<const redisReply*>(nullptr)).isValid());
+}
+
+// [stream, [[id, [field, value]], ...]]
+static QByteArray stream(const QByteArray &key, const QList<QByteArray> &entries)
+{
+    QByteArray result = "*2\r\n$" + QByteArray::number(key.size()) + "\r\n" + key + "\r\n"
+                        "*" + QByteArray::number(entries.size()) + "\r\n";
+    for (const auto &entry : entries) {
+        result += entry;
+    }
+    return result;
+}
+
+TEST(ReadStreamsReply, Resp2ListsStreams)
+{
+    RespReply reply("*2\r\n" +
+                    stream("a", {entry("1-0", "x", "1"), entry("2-0", "x", "2")}) +
+                    stream("b", {entry("5-1", "y", "3")}));
+    ReadStreamsReply read(reply.get());
+    ASSERT_TRUE(read.isValid());
+    ASSERT_EQ(read.streams.size(), 2);
+    EXPECT_EQ(read.streams[0].key, "a");
+    EXPECT_EQ(read.streams[0].lastId, "2-0");
+    EXPECT_EQ(read.streams[0].entries->elements, 2u);
+    EXPECT_EQ(read.streams[1].key, "b");
+    EXPECT_EQ(read.streams[1].lastId, "5-1");
+}
+
+TEST(ReadStreamsReply, Resp3MapsStreams)
+{
+    RespReply reply("%2\r\n"
+                    "$1\r\na\r\n*1\r\n" + entry("1-0", "x", "1") +
+                    "$1\r\nb\r\n*2\r\n" + entry("3-0", "y", "2") + entry("4-0", "y", "3"));
+    ReadStreamsReply read(reply.get());
+    ASSERT_TRUE(read.isValid());
+    ASSERT_EQ(read.streams.size(), 2);
+    EXPECT_EQ(read.streams[0].key, "a");
+    EXPECT_EQ(read.streams[0].lastId, "1-0");
+    EXPECT_EQ(read.streams[1].key, "b");
+    EXPECT_EQ(read.streams[1].lastId, "4-0");
+}
+
+// Checkpoint is moved to id of last entry, even if it is deleted (XREADGROUP of pending ones)
+TEST(ReadStreamsReply, LastIdOfDeletedEntry)
+{
+    RespReply reply("*1\r\n" + stream("a", {entry("1-0", "x", "1"), "*2\r\n$3\r\n2-0\r\n*-1\r\n"}));
+    ReadStreamsReply read(reply.get());
+    ASSERT_TRUE(read.isValid());
+    EXPECT_EQ(read.streams[0].lastId, "2-0");
+}
+
+TEST(ReadStreamsReply, EmptyStreamHasNoLastId)
+{
+    RespReply reply("*1\r\n" + stream("a", {}));
+    ReadStreamsReply read(reply.get());
+    ASSERT_TRUE(read.isValid());
+    EXPECT_TRUE(read.streams[0].lastId.isEmpty());
+}
+
+TEST(ReadStreamsReply, TimeoutIsNotValid)
+{
+    RespReply resp2Nil("*-1\r\n");
+    EXPECT_FALSE(ReadStreamsReply(resp2Nil.get()).isValid());
+    RespReply resp3Nil("_\r\n");
+    EXPECT_FALSE(ReadStreamsReply(resp3Nil.get()).isValid());
+    RespReply error("-NOGROUP No such key\r\n");
+    EXPECT_FALSE(ReadStreamsReply(error.get()).isValid());
+    EXPECT_FALSE(ReadStreamsReply(nullptr).isValid());
+}
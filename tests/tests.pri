@@ -1,12 +1,20 @@
 ## При включении в проджект файл тестов укажите переменную RSK_TEST_NAME
-ADAPTER_LIB_DIR = $$PWD
-ADAPTER_SRC_DIR = $$PWD/src
-include(qtmodules.pri)
+ADAPTER_LIB_DIR = $$PWD/..
+ADAPTER_SRC_DIR = $$PWD/../src
+QT += core \
+    serialbus \
+    serialport \
+    sql \
+    websockets \
+    network \
+    httpserver \
+    concurrent
+QT -= gui
 QT += testlib
-CONFIG += qt console warn_on depend_includepath testcase link_prl
+CONFIG += qt console c++17 warn_on depend_includepath testcase link_prl
 CONFIG -= app_bundle gui
 TEMPLATE = app
-DEFINES += RADAPTER_API=Q_DECL_IMPORT
+DEFINES += RADAPTER_API= YAML_CPP_API=
 SOURCES += \
     tst_$${RSK_TEST_NAME}.cpp
 HEADERS += \
@@ -17,11 +25,12 @@ MOC_DIR = build
 RCC_DIR = build
 UI_DIR= build
 ##################### Подключение основной библиотеки проекта и библиотеки для тестов
-LIBS += -L$$ADAPTER_LIB_DIR -lrsk-testlib
+LIBS += -L$$ADAPTER_LIB_DIR
 CONFIG(debug, debug|release){
     LIBS += -lradapter-sdkd
 }
 CONFIG(release, debug|release){
     LIBS += -lradapter-sdk
 }
-INCLUDEPATH += $$ADAPTER_SRC_DIR $$PWD/rsk-testlib
+include($$ADAPTER_LIB_DIR/headers.pri)
+INCLUDEPATH += $$PWD
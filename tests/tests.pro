@@ -0,0 +1,25 @@
+TEMPLATE = subdirs
+SUBDIRS += \
+   brokerfanout \
+   channeledf \
+   checkpointlog \
+   clientcache \
+   commandargs \
+   flatjson \
+   hashdelta \
+   jsonvisit \
+   pollschedule \
+   readplanner \
+   redispipeline \
+   redispubsub \
+   redisrouting \
+   rediswindow \
+   registerdecoder \
+   requestwindow \
+   sharedmsg \
+   spillfile \
+   streambatchbench \
+   streamreplies \
+   unixsocketbench \
+   workerinbox \
+   workerready
@@ -0,0 +1,82 @@
+#include "gtest_unixsocketbench.h"
+#include <QElapsedTimer>
+#include <iostream>
+
+#define ROUND_TRIPS 20000
+#define HASH_FIELDS 100
+
+using namespace Redis;
+
+static const char *benchStream = "bench:unixsocket:stream";
+static const char *benchHash = "bench:unixsocket:hash";
+
+void UnixSocketBench::SetUp()
+{
+    const auto host = qEnvironmentVariable("REDIS_HOST", "127.0.0.1").toStdString();
+    const auto port = qEnvironmentVariableIntValue("REDIS_PORT");
+    const auto socket = qEnvironmentVariable("REDIS_UNIX_SOCKET", "/var/run/redis/redis.sock").toStdString();
+    m_tcp = redisConnect(host.c_str(), port ? port : 6379);
+    if (!m_tcp || m_tcp->err) {
+        GTEST_SKIP() << "Redis is not available at " << host;
+    }
+    m_unix = redisConnectUnix(socket.c_str());
+    if (!m_unix || m_unix->err) {
+        GTEST_SKIP() << "Redis is not available at unix socket " << socket;
+    }
+    auto fill = CommandArgs{"HSET"}.appendKey(QString::fromLatin1(benchHash));
+    for (int i = 0; i < HASH_FIELDS; ++i) {
+        fill << QStringLiteral("field_%1").arg(i) << i;
+    }
+    auto encoded = fill.encoded();
+    redisAppendFormattedCommand(m_tcp, encoded.data(), size_t(encoded.size()));
+    void *reply = nullptr;
+    ASSERT_EQ(redisGetReply(m_tcp, &reply), REDIS_OK);
+    freeReplyObject(reply);
+}
+
+void UnixSocketBench::TearDown()
+{
+    if (m_tcp && !m_tcp->err) {
+        freeReplyObject(redisCommand(m_tcp, "DEL %s %s", benchStream, benchHash));
+    }
+    if (m_tcp) redisFree(m_tcp);
+    if (m_unix) redisFree(m_unix);
+}
+
+double UnixSocketBench::roundTrips(redisContext *ctx, const CommandArgs &command, int count)
+{
+    auto encoded = command.encoded();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < count; ++i) {
+        redisAppendFormattedCommand(ctx, encoded.data(), size_t(encoded.size()));
+        void *reply = nullptr;
+        EXPECT_EQ(redisGetReply(ctx, &reply), REDIS_OK);
+        EXPECT_NE(static_cast<redisReply*>(reply)->type, REDIS_REPLY_ERROR);
+        freeReplyObject(reply);
+    }
+    return double(timer.nsecsElapsed()) / 1000. / count;
+}
+
+TEST_F(UnixSocketBench, XaddAndHgetallLatency)
+{
+    auto xadd = CommandArgs{"XADD"}.appendKey(QString::fromLatin1(benchStream));
+    xadd << "MAXLEN" << "~" << 1000 << "*" << "sensor:value" << QVariant(42.5);
+    auto hgetall = CommandArgs{"HGETALL"}.appendKey(QString::fromLatin1(benchHash));
+    // Warm up both connections (and server side buffers) first
+    roundTrips(m_tcp, hgetall, ROUND_TRIPS / 10);
+    roundTrips(m_unix, hgetall, ROUND_TRIPS / 10);
+
+    const auto tcpXadd = roundTrips(m_tcp, xadd, ROUND_TRIPS);
+    const auto unixXadd = roundTrips(m_unix, xadd, ROUND_TRIPS);
+    const auto tcpHgetall = roundTrips(m_tcp, hgetall, ROUND_TRIPS);
+    const auto unixHgetall = roundTrips(m_unix, hgetall, ROUND_TRIPS);
+
+    std::cout << "XADD: tcp: " << tcpXadd << " us; unix: " << unixXadd << " us" << std::endl
+              << "HGETALL (" << HASH_FIELDS << " fields): tcp: " << tcpHgetall << " us; "
+              << "unix: " << unixHgetall << " us" << std::endl;
+    RecordProperty("xadd_tcp_ns", int(tcpXadd * 1000));
+    RecordProperty("xadd_unix_ns", int(unixXadd * 1000));
+    RecordProperty("hgetall_tcp_ns", int(tcpHgetall * 1000));
+    RecordProperty("hgetall_unix_ns", int(unixHgetall * 1000));
+}
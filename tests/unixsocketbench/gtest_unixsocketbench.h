@@ -0,0 +1,22 @@
+#ifndef GTEST_UNIXSOCKETBENCH_H
+#define GTEST_UNIXSOCKETBENCH_H
+
+#include <gtest/gtest.h>
+#include "lib/hiredis/hiredis.h"
+#include "formatting/redis/rediscommandargs.h"
+
+//! Needs redis at REDIS_HOST:REDIS_PORT (default 127.0.0.1:6379) and REDIS_UNIX_SOCKET
+//! (default /var/run/redis/redis.sock) of same server, skipped otherwise
+class UnixSocketBench : public ::testing::Test
+{
+protected:
+    void SetUp() override;
+    void TearDown() override;
+    //! One command per round trip. \return average microseconds per command
+    double roundTrips(redisContext *ctx, const Redis::CommandArgs &command, int count);
+
+    redisContext *m_tcp{nullptr};
+    redisContext *m_unix{nullptr};
+};
+
+#endif // GTEST_UNIXSOCKETBENCH_H
@@ -0,0 +1,86 @@
+#include "gtest_workerinbox.h"
+#include <QSemaphore>
+#include <QThread>
+#include <QVector>
+#include <iostream>
+
+#define PRODUCERS           4
+#define MSGS_PER_PRODUCER   100000
+#define WAKEUP_TIMEOUT_MS   5000
+
+using namespace Radapter;
+
+static WorkerMsg numbered(quint64 id)
+{
+    WorkerMsg msg;
+    msg.setId(id);
+    return msg;
+}
+
+TEST(WorkerInbox, OneWakeupPerDrain)
+{
+    WorkerInbox inbox;
+    EXPECT_TRUE(inbox.push(numbered(1)));
+    EXPECT_FALSE(inbox.push(numbered(2)));
+    EXPECT_FALSE(inbox.push(numbered(3)));
+    QList<quint64> drained;
+    EXPECT_EQ(inbox.drain([&](const WorkerMsg &msg){drained.append(msg.id());}), 3);
+    EXPECT_EQ(drained, (QList<quint64>{1, 2, 3}));
+    // Drained inbox asks for wakeup again
+    EXPECT_TRUE(inbox.push(numbered(4)));
+    EXPECT_EQ(inbox.drain([](const WorkerMsg &){}), 1);
+}
+
+TEST(WorkerInbox, EmptyDrainRearmsWakeup)
+{
+    WorkerInbox inbox;
+    EXPECT_EQ(inbox.drain([](const WorkerMsg &){}), 0);
+    EXPECT_TRUE(inbox.push(numbered(1)));
+}
+
+// Consumer sleeps until woken up: a lost wakeup (msg pushed, nobody scheduled drain) hangs it
+TEST(WorkerInbox, NoLostWakeupsUnderContention)
+{
+    WorkerInbox inbox;
+    QSemaphore wakeups;
+    QAtomicInt wakeupsScheduled{0};
+    QVector<QThread*> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.append(QThread::create([&, p]{
+            for (int i = 0; i < MSGS_PER_PRODUCER; ++i) {
+                if (inbox.push(numbered(quint64(p) * MSGS_PER_PRODUCER + i))) {
+                    wakeupsScheduled.ref();
+                    wakeups.release();
+                }
+            }
+        }));
+    }
+    for (auto producer : producers) {
+        producer->start();
+    }
+    QVector<quint64> lastFromProducer(PRODUCERS, 0);
+    QVector<bool> seenFromProducer(PRODUCERS, false);
+    int received = 0;
+    bool ordered = true;
+    while (received < PRODUCERS * MSGS_PER_PRODUCER) {
+        ASSERT_TRUE(wakeups.tryAcquire(1, WAKEUP_TIMEOUT_MS)) << "Lost wakeup, received: " << received;
+        received += inbox.drain([&](const WorkerMsg &msg){
+            const auto producer = int(msg.id() / MSGS_PER_PRODUCER);
+            // FIFO per producer
+            if (seenFromProducer[producer] && msg.id() <= lastFromProducer[producer]) {
+                ordered = false;
+            }
+            seenFromProducer[producer] = true;
+            lastFromProducer[producer] = msg.id();
+        });
+    }
+    for (auto producer : producers) {
+        producer->wait();
+        delete producer;
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received, PRODUCERS * MSGS_PER_PRODUCER);
+    // Batching: far fewer wakeups than msgs
+    EXPECT_LE(wakeupsScheduled.loadRelaxed(), received);
+    std::cout << "Msgs: " << received << "; Wakeups: " << wakeupsScheduled.loadRelaxed() << std::endl;
+}
@@ -0,0 +1,7 @@
+#ifndef GTEST_WORKERINBOX_H
+#define GTEST_WORKERINBOX_H
+
+#include <gtest/gtest.h>
+#include "broker/workers/private/workerinbox.h"
+
+#endif // GTEST_WORKERINBOX_H
@@ -0,0 +1,140 @@
+#include "gtest_workerready.h"
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QThread>
+
+#define TIMEOUT_MS  5000
+#define SETTLE_MS   100
+
+using namespace Radapter;
+
+static std::atomic<int> sequence{0};
+
+ReadyWorker::ReadyWorker(const QString &name, bool deferred, Worker *dependency) :
+    Worker({name}, new QThread),
+    m_dependency(dependency)
+{
+    if (deferred) {
+        deferReady();
+    }
+    connect(this, &Worker::ready, this, [this]{
+        readyAt = ++sequence;
+    }, Qt::DirectConnection);
+}
+
+void ReadyWorker::markReadyLater()
+{
+    QMetaObject::invokeMethod(this, [this]{markReady();}, Qt::QueuedConnection);
+}
+
+void ReadyWorker::onRun()
+{
+    dependOn(m_dependency);
+    Worker::onRun();
+}
+
+void ReadyWorker::onDependenciesReady()
+{
+    dependenciesAt = ++sequence;
+    Worker::onDependenciesReady();
+}
+
+static bool waitUntil(const std::function<bool()> &condition)
+{
+    auto deadline = QDeadlineTimer(TIMEOUT_MS);
+    while (!condition() && !deadline.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return condition();
+}
+
+static void settle()
+{
+    QThread::msleep(SETTLE_MS);
+    QCoreApplication::processEvents();
+}
+
+TEST(WorkerReady, ReadyAfterRun)
+{
+    auto worker = new ReadyWorker("ready.plain");
+    EXPECT_FALSE(worker->isReady());
+    worker->run();
+    EXPECT_TRUE(waitUntil([&]{return worker->isReady();}));
+    EXPECT_GT(worker->dependenciesAt, 0);
+}
+
+TEST(WorkerReady, DeferredWaitsForMarkReady)
+{
+    auto worker = new ReadyWorker("ready.deferred", true);
+    worker->run();
+    // Dependencies (none) are done, but worker itself is not ready yet
+    EXPECT_TRUE(waitUntil([&]{return worker->dependenciesAt > 0;}));
+    settle();
+    EXPECT_FALSE(worker->isReady());
+    worker->markReadyLater();
+    EXPECT_TRUE(waitUntil([&]{return worker->isReady();}));
+    EXPECT_GT(worker->readyAt, worker->dependenciesAt);
+    // ready() is emitted once
+    const auto readyAt = worker->readyAt.load();
+    worker->markReadyLater();
+    settle();
+    EXPECT_EQ(worker->readyAt, readyAt);
+}
+
+TEST(WorkerReady, DependOnBeforeDependencyIsReady)
+{
+    auto dependency = new ReadyWorker("ready.before.dependency", true);
+    auto dependent = new ReadyWorker("ready.before.dependent", false, dependency);
+    dependency->run();
+    dependent->run();
+    settle();
+    EXPECT_EQ(dependent->dependenciesAt, 0);
+    EXPECT_FALSE(dependent->isReady());
+    dependency->markReadyLater();
+    EXPECT_TRUE(waitUntil([&]{return dependent->isReady();}));
+    EXPECT_GT(dependent->dependenciesAt, dependency->readyAt);
+}
+
+// Dependency became ready before dependOn(): its ready() was already emitted, so it is rechecked
+TEST(WorkerReady, DependOnAfterDependencyIsReady)
+{
+    auto dependency = new ReadyWorker("ready.after.dependency");
+    dependency->run();
+    ASSERT_TRUE(waitUntil([&]{return dependency->isReady();}));
+    auto dependent = new ReadyWorker("ready.after.dependent", false, dependency);
+    dependent->run();
+    EXPECT_TRUE(waitUntil([&]{return dependent->isReady();}));
+    EXPECT_GT(dependent->dependenciesAt, dependency->readyAt);
+}
+
+TEST(WorkerReady, DeferredDependentNeedsBoth)
+{
+    auto dependency = new ReadyWorker("ready.both.dependency", true);
+    auto dependent = new ReadyWorker("ready.both.dependent", true, dependency);
+    dependency->run();
+    dependent->run();
+    // Dependencies done do not make deferred worker ready
+    dependency->markReadyLater();
+    EXPECT_TRUE(waitUntil([&]{return dependent->dependenciesAt > 0;}));
+    settle();
+    EXPECT_FALSE(dependent->isReady());
+    dependent->markReadyLater();
+    EXPECT_TRUE(waitUntil([&]{return dependent->isReady();}));
+}
+
+TEST(WorkerReady, StartupReportInReadyOrder)
+{
+    auto dependency = new ReadyWorker("ready.report.dependency", true);
+    auto dependent = new ReadyWorker("ready.report.dependent", false, dependency);
+    Broker::instance()->registerWorker(dependent);
+    Broker::instance()->registerWorker(dependency);
+    Broker::instance()->runAll();
+    settle();
+    EXPECT_TRUE(Broker::instance()->readyTimes().isEmpty());
+    dependency->markReadyLater();
+    ASSERT_TRUE(waitUntil([&]{return Broker::instance()->readyTimes().size() == 2;}));
+    const auto report = Broker::instance()->readyTimes();
+    EXPECT_EQ(report[0].first, dependency->printSelf());
+    EXPECT_EQ(report[1].first, dependent->printSelf());
+    EXPECT_LE(report[0].second, report[1].second);
+}
@@ -0,0 +1,27 @@
+#ifndef GTEST_WORKERREADY_H
+#define GTEST_WORKERREADY_H
+
+#include <gtest/gtest.h>
+#include "broker/broker.h"
+#include "broker/workers/worker.h"
+
+//! Records order, in which its dependencies and itself became ready
+class ReadyWorker : public Radapter::Worker
+{
+    Q_OBJECT
+public:
+    //! \param deferred becomes ready only on markReady()
+    ReadyWorker(const QString &name, bool deferred = false, Radapter::Worker *dependency = nullptr);
+    //! Queued into worker thread
+    void markReadyLater();
+    //! Position in global order of events, 0 --> did not happen yet
+    std::atomic<int> dependenciesAt{0};
+    std::atomic<int> readyAt{0};
+protected:
+    void onRun() override;
+    void onDependenciesReady() override;
+private:
+    Radapter::Worker *m_dependency;
+};
+
+#endif // GTEST_WORKERREADY_H